@@ -11,6 +11,19 @@ static const int pg_barrier_default = PG_MAX_BARRIERS - 1;
 static volatile int barrier_count[PG_MAX_BARRIERS];
 static volatile int barrier_phase[PG_MAX_BARRIERS];
 
+// Hardware barrier (src/barrier.v)
+#define PG_HW_BARRIER_ARRIVE(id) ((volatile int *) (0x40003000 + 4 * (id)))
+#define PG_HW_BARRIER_MASK(id) ((volatile int *) (0x40003100 + 4 * (id)))
+#define PG_HW_BARRIER_SLOTS ((volatile int *) 0x40003ffc)
+
+// Hardware queued lock (src/hwlock.v)
+#define PG_HWLOCK(id) ((volatile int *) (0x40004000 + 4 * (id)))
+#define PG_HWLOCK_TRY(id) ((volatile int *) (0x40004100 + 4 * (id)))
+#define PG_HWLOCK_COUNT ((volatile int *) 0x40004ffc)
+
+// Used instead of the hardware locks when the hardware lock unit is not present
+static spinlock_t hwlock_fallback[PG_MAX_HWLOCKS];
+
 static inline int valid_hart(int hart_id)
 {
     return hart_id >= 0 && hart_id < NCORES;
@@ -23,7 +36,9 @@ static inline int valid_barrier(int barrier_id)
 
 void inline spinlock_acquire(volatile spinlock_t *lock)
 {
-    while (atomic_exchange(lock, 1) != 0) {}
+    while (atomic_exchange(lock, 1) != 0) {
+        pg_wait_while_eq(lock, 1);
+    }
 }
 
 void inline spinlock_release(volatile spinlock_t *lock)
@@ -31,33 +46,90 @@ void inline spinlock_release(volatile spinlock_t *lock)
     *lock = 0;
 }
 
+#define PG_AMO(insn, ptr, val)                                                                     \
+    ({                                                                                             \
+        int old_val;                                                                               \
+        asm volatile(insn " %[old_val], %[val], (%[ptr])"                                          \
+                     : [old_val] "=r"(old_val)                                                     \
+                     : [ptr] "r"(ptr), [val] "r"(val)                                              \
+                     : "memory");                                                                  \
+        old_val;                                                                                   \
+    })
+
 int atomic_fetch_add(volatile int *ptr, int val)
 {
-    int old_val, new_val, ret;
-    do {
-        asm volatile("lr.w %[old_val], (%[ptr])\n"
-                     "add %[new_val], %[old_val], %[val]\n"
-                     "sc.w %[ret], %[new_val], (%[ptr])\n"
-                     : [ret] "=&r"(ret), [old_val] "=&r"(old_val), [new_val] "=&r"(new_val)
-                     : [ptr] "r"(ptr), [val] "r"(val)
-                     : "memory");
-    } while (ret != 0);
-
-    return old_val;
+    return PG_AMO("amoadd.w", ptr, val);
 }
 
 int atomic_exchange(volatile int *ptr, int val)
 {
-    int old_val, ret;
-    do {
-        asm volatile("lr.w %[old_val], (%[ptr])\n"
-                     "sc.w %[ret], %[val], (%[ptr])\n"
-                     : [ret] "=&r"(ret), [old_val] "=&r"(old_val)
-                     : [ptr] "r"(ptr), [val] "r"(val)
-                     : "memory");
-    } while (ret != 0);
+    return PG_AMO("amoswap.w", ptr, val);
+}
+
+int atomic_fetch_and(volatile int *ptr, int val)
+{
+    return PG_AMO("amoand.w", ptr, val);
+}
+
+int atomic_fetch_or(volatile int *ptr, int val)
+{
+    return PG_AMO("amoor.w", ptr, val);
+}
+
+int atomic_fetch_xor(volatile int *ptr, int val)
+{
+    return PG_AMO("amoxor.w", ptr, val);
+}
+
+int atomic_fetch_min(volatile int *ptr, int val)
+{
+    return PG_AMO("amomin.w", ptr, val);
+}
+
+int atomic_fetch_max(volatile int *ptr, int val)
+{
+    return PG_AMO("amomax.w", ptr, val);
+}
+
+unsigned int atomic_fetch_minu(volatile unsigned int *ptr, unsigned int val)
+{
+    return PG_AMO("amominu.w", ptr, val);
+}
+
+unsigned int atomic_fetch_maxu(volatile unsigned int *ptr, unsigned int val)
+{
+    return PG_AMO("amomaxu.w", ptr, val);
+}
+
+// Zawrs, encoded as words so that the toolchain does not need to know the extension
+void pg_wrs_nto(void)
+{
+    asm volatile(".word 0x00d00073" ::: "memory"); // wrs.nto
+}
+
+void pg_wrs_sto(void)
+{
+    asm volatile(".word 0x01d00073" ::: "memory"); // wrs.sto
+}
+
+// Wait until *ptr is not val. The core is parked by wrs.nto while the reservation taken by
+// lr.w is valid, and wakes up when another core writes the word.
+void pg_wait_while_eq(volatile int *ptr, int val)
+{
+    int cur;
+    while (1) {
+        asm volatile("lr.w %[cur], (%[ptr])" : [cur] "=r"(cur) : [ptr] "r"(ptr) : "memory");
+        if (cur != val) {
+            return;
+        }
+        pg_wrs_nto();
+    }
+}
 
-    return old_val;
+// The number of hardware barrier slots, 0 when the hardware barrier is not present
+int pg_hw_barrier_slots(void)
+{
+    return *PG_HW_BARRIER_SLOTS;
 }
 
 void pg_barrier_at(int barrier_id, int ncores)
@@ -66,6 +138,16 @@ void pg_barrier_at(int barrier_id, int ncores)
         return;
     }
 
+    if (barrier_id < pg_hw_barrier_slots()) {
+        int mask = (ncores >= 32) ? -1 : (1 << ncores) - 1;
+        if (*PG_HW_BARRIER_MASK(barrier_id) != mask) {
+            *PG_HW_BARRIER_MASK(barrier_id) = mask;
+        }
+        asm volatile("fence" ::: "memory"); // drain the store buffer before arriving
+        (void) *PG_HW_BARRIER_ARRIVE(barrier_id); // stalls until all cores in mask arrive
+        return;
+    }
+
     int phase = barrier_phase[barrier_id];
     int count = atomic_fetch_add(&barrier_count[barrier_id], 1) + 1;
 
@@ -73,7 +155,7 @@ void pg_barrier_at(int barrier_id, int ncores)
         barrier_count[barrier_id] = 0;
         atomic_fetch_add(&barrier_phase[barrier_id], 1);
     } else { // wait for phase change
-        while (barrier_phase[barrier_id] == phase) {}
+        pg_wait_while_eq(&barrier_phase[barrier_id], phase);
     }
 }
 
@@ -81,3 +163,53 @@ void pg_barrier(void)
 {
     pg_barrier_at(pg_barrier_default, NCORES);
 }
+
+// The number of hardware locks, 0 when the hardware lock unit is not present
+int pg_hwlock_count(void)
+{
+    return *PG_HWLOCK_COUNT;
+}
+
+static inline int valid_hwlock(int lock_id)
+{
+    return lock_id >= 0 && lock_id < PG_MAX_HWLOCKS;
+}
+
+void pg_hwlock_acquire(int lock_id)
+{
+    if (!valid_hwlock(lock_id)) {
+        return;
+    }
+
+    if (lock_id < pg_hwlock_count()) {
+        (void) *PG_HWLOCK(lock_id); // stalls until the lock is granted
+    } else {
+        spinlock_acquire(&hwlock_fallback[lock_id]);
+    }
+}
+
+int pg_hwlock_try_acquire(int lock_id)
+{
+    if (!valid_hwlock(lock_id)) {
+        return 0;
+    }
+
+    if (lock_id < pg_hwlock_count()) {
+        return *PG_HWLOCK_TRY(lock_id);
+    }
+    return atomic_exchange(&hwlock_fallback[lock_id], 1) == 0;
+}
+
+void pg_hwlock_release(int lock_id)
+{
+    if (!valid_hwlock(lock_id)) {
+        return;
+    }
+
+    if (lock_id < pg_hwlock_count()) {
+        asm volatile("fence" ::: "memory"); // drain the store buffer before handing the lock over
+        *PG_HWLOCK(lock_id) = 0;
+    } else {
+        spinlock_release(&hwlock_fallback[lock_id]);
+    }
+}
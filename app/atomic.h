@@ -1,4 +1,5 @@
 #define PG_MAX_BARRIERS 8
+#define PG_MAX_HWLOCKS 8
 
 typedef volatile int spinlock_t;
 
@@ -6,5 +7,20 @@ void spinlock_acquire(spinlock_t *lock);
 void spinlock_release(spinlock_t *lock);
 int atomic_fetch_add(volatile int *ptr, int val);
 int atomic_exchange(volatile int *ptr, int val);
+int atomic_fetch_and(volatile int *ptr, int val);
+int atomic_fetch_or(volatile int *ptr, int val);
+int atomic_fetch_xor(volatile int *ptr, int val);
+int atomic_fetch_min(volatile int *ptr, int val);
+int atomic_fetch_max(volatile int *ptr, int val);
+unsigned int atomic_fetch_minu(volatile unsigned int *ptr, unsigned int val);
+unsigned int atomic_fetch_maxu(volatile unsigned int *ptr, unsigned int val);
+void pg_wrs_nto(void);
+void pg_wrs_sto(void);
+void pg_wait_while_eq(volatile int *ptr, int val);
+int pg_hw_barrier_slots(void);
 void pg_barrier_at(int barrier_id, int ncores);
 void pg_barrier(void);
+int pg_hwlock_count(void);
+void pg_hwlock_acquire(int lock_id);
+int pg_hwlock_try_acquire(int lock_id);
+void pg_hwlock_release(int lock_id);
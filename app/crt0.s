@@ -39,9 +39,76 @@ _start:
     li      x30, 0
     li      x31, 0
     la      sp, _fstack
+    # thread pointer and per-core TCM: copy .tdata, then zero .tbss and .tcm
+    la      tp, _tdata_start
+    la      t0, _tdata_load
+    la      t1, _tdata_start
+    la      t2, _tdata_end
+1:  bgeu    t1, t2, 2f
+    lw      t3, 0(t0)
+    sw      t3, 0(t1)
+    addi    t0, t0, 4
+    addi    t1, t1, 4
+    j       1b
+2:  la      t2, _tcm_end
+3:  bgeu    t1, t2, 4f
+    sw      zero, 0(t1)
+    addi    t1, t1, 4
+    j       3b
+4:  la      t0, _trap_vector
+    csrw    mtvec, t0
     jal     main
     j       finish
 
+    # machine-mode trap vector: save the caller-saved registers, then the resume pc
+    # returned by pg_trap_handler(mcause, mepc) is written back to mepc
+    .align 4
+    .text
+    .globl _trap_vector
+    .weak pg_trap_handler
+_trap_vector:
+    addi    sp, sp, -64
+    sw      ra, 0(sp)
+    sw      t0, 4(sp)
+    sw      t1, 8(sp)
+    sw      t2, 12(sp)
+    sw      a0, 16(sp)
+    sw      a1, 20(sp)
+    sw      a2, 24(sp)
+    sw      a3, 28(sp)
+    sw      a4, 32(sp)
+    sw      a5, 36(sp)
+    sw      a6, 40(sp)
+    sw      a7, 44(sp)
+    sw      t3, 48(sp)
+    sw      t4, 52(sp)
+    sw      t5, 56(sp)
+    sw      t6, 60(sp)
+    csrr    a0, mcause
+    csrr    a1, mepc
+    la      t0, pg_trap_handler
+    beqz    t0, 1f
+    jalr    t0
+    csrw    mepc, a0
+1:  lw      ra, 0(sp)
+    lw      t0, 4(sp)
+    lw      t1, 8(sp)
+    lw      t2, 12(sp)
+    lw      a0, 16(sp)
+    lw      a1, 20(sp)
+    lw      a2, 24(sp)
+    lw      a3, 28(sp)
+    lw      a4, 32(sp)
+    lw      a5, 36(sp)
+    lw      a6, 40(sp)
+    lw      a7, 44(sp)
+    lw      t3, 48(sp)
+    lw      t4, 52(sp)
+    lw      t5, 56(sp)
+    lw      t6, 60(sp)
+    addi    sp, sp, 64
+    mret
+
     .align 4
     .text
     .globl finish
@@ -0,0 +1,73 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+#include "dispenser.h"
+
+#include "atomic.h"
+
+// Fetch-and-add work dispensers (src/dispenser.v)
+#define PG_DISPENSER_VALUE(id) ((volatile unsigned int *) (0x40006000 + 16 * (id)))
+#define PG_DISPENSER_STRIDE(id) ((volatile unsigned int *) (0x40006004 + 16 * (id)))
+#define PG_DISPENSER_LIMIT(id) ((volatile unsigned int *) (0x40006008 + 16 * (id)))
+#define PG_DISPENSER_EXHAUSTED(id) ((volatile unsigned int *) (0x4000600c + 16 * (id)))
+#define PG_DISPENSER_COUNT ((volatile int *) 0x40006ffc)
+
+// Used instead of the hardware dispensers when the dispenser unit is not present
+static volatile unsigned int disp_value[PG_MAX_DISPENSERS];
+static volatile unsigned int disp_stride[PG_MAX_DISPENSERS];
+static volatile unsigned int disp_limit[PG_MAX_DISPENSERS];
+
+static inline int valid_dispenser(int id)
+{
+    return id >= 0 && id < PG_MAX_DISPENSERS;
+}
+
+// The number of hardware dispensers, 0 when the dispenser unit is not present
+int pg_dispenser_count(void)
+{
+    return *PG_DISPENSER_COUNT;
+}
+
+// Set up dispenser id to hand out start, start + stride, ... while the value is below limit.
+// Call it while no core takes values from the dispenser.
+void pg_dispenser_init(int id, unsigned int start, unsigned int stride, unsigned int limit)
+{
+    if (!valid_dispenser(id)) {
+        return;
+    }
+
+    if (id < pg_dispenser_count()) {
+        *PG_DISPENSER_STRIDE(id) = stride;
+        *PG_DISPENSER_LIMIT(id) = limit;
+        *PG_DISPENSER_VALUE(id) = start;
+    } else {
+        disp_stride[id] = stride;
+        disp_limit[id] = limit;
+        disp_value[id] = start;
+    }
+}
+
+// Take the next value of dispenser id, a value >= limit means the dispenser is exhausted
+unsigned int pg_dispenser_next(int id)
+{
+    if (!valid_dispenser(id)) {
+        return 0xffffffff;
+    }
+
+    if (id < pg_dispenser_count()) {
+        return *PG_DISPENSER_VALUE(id);
+    }
+    return atomic_fetch_add((volatile int *) &disp_value[id], disp_stride[id]);
+}
+
+int pg_dispenser_exhausted(int id)
+{
+    if (!valid_dispenser(id)) {
+        return 1;
+    }
+
+    if (id < pg_dispenser_count()) {
+        return *PG_DISPENSER_EXHAUSTED(id);
+    }
+    return disp_value[id] >= disp_limit[id];
+}
@@ -0,0 +1,9 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+#define PG_MAX_DISPENSERS 4
+
+int pg_dispenser_count(void);
+void pg_dispenser_init(int id, unsigned int start, unsigned int stride, unsigned int limit);
+unsigned int pg_dispenser_next(int id);
+int pg_dispenser_exhausted(int id);
@@ -0,0 +1,47 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+#include "mbox.h"
+
+// Per-core hardware mailbox FIFOs (src/mailbox.v)
+
+// The number of words in each inbox, 0 when the mailbox unit is not present
+int pg_mbox_depth(void)
+{
+    return *(volatile int *) 0x40005ffc;
+}
+
+// Push val into the inbox of hart_id, stalls while the inbox is full
+void pg_mbox_send(int hart_id, int val)
+{
+    asm volatile("fence" ::: "memory"); // make the stores before the message visible first
+    *(volatile int *) (0x40005000 + 4 * hart_id) = val;
+}
+
+// Pop a word from the own inbox, stalls while the inbox is empty
+int pg_mbox_recv(void)
+{
+    return *(volatile int *) 0x40005100;
+}
+
+// Pop a word from the own inbox into *val, returns 0 without waiting if the inbox is empty
+int pg_mbox_try_recv(int *val)
+{
+    if (pg_mbox_count() == 0) {
+        return 0;
+    }
+    *val = pg_mbox_recv(); // only this core pops its inbox, so this does not wait
+    return 1;
+}
+
+// The number of words in the own inbox
+int pg_mbox_count(void)
+{
+    return *(volatile int *) 0x40005108;
+}
+
+// The number of words in the inbox of hart_id
+int pg_mbox_count_of(int hart_id)
+{
+    return *(volatile int *) (0x40005200 + 4 * hart_id);
+}
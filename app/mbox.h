@@ -0,0 +1,9 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+int pg_mbox_depth(void);
+void pg_mbox_send(int hart_id, int val);
+int pg_mbox_recv(void);
+int pg_mbox_try_recv(int *val);
+int pg_mbox_count(void);
+int pg_mbox_count_of(int hart_id);
@@ -1,24 +1,53 @@
 /* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
 / Released under the MIT license https://opensource.org/licenses/mit           */
 
+// Per-core cycle and instret counters in the CSRs (Zicntr), mcountinhibit stops them
+#define PG_MCOUNTINHIBIT_CY_IR 0x5
+
 unsigned long long pg_perf_cycle(void)
 {
-    unsigned int cycle = *(volatile unsigned int *) 0x40000004;
-    unsigned int cycleh = *(volatile unsigned int *) 0x40000008;
-    return ((unsigned long long) cycleh << 32) | cycle;
+    unsigned int hi, lo, hi2;
+    do {
+        asm volatile("csrr %0, cycleh" : "=r"(hi));
+        asm volatile("csrr %0, cycle" : "=r"(lo));
+        asm volatile("csrr %0, cycleh" : "=r"(hi2));
+    } while (hi != hi2);
+    return ((unsigned long long) hi << 32) | lo;
+}
+
+unsigned long long pg_perf_instret(void)
+{
+    unsigned int hi, lo, hi2;
+    do {
+        asm volatile("csrr %0, instreth" : "=r"(hi));
+        asm volatile("csrr %0, instret" : "=r"(lo));
+        asm volatile("csrr %0, instreth" : "=r"(hi2));
+    } while (hi != hi2);
+    return ((unsigned long long) hi << 32) | lo;
 }
 
+// Stop the counters of this core and clear them, pg_perf_enable() starts them again
 void pg_perf_reset(void)
 {
-    *(volatile char *) 0x40000000 = 0;
+    asm volatile("csrs mcountinhibit, %0" ::"r"(PG_MCOUNTINHIBIT_CY_IR));
+    asm volatile("csrw mcycle, zero");
+    asm volatile("csrw mcycleh, zero");
+    asm volatile("csrw minstret, zero");
+    asm volatile("csrw minstreth, zero");
 }
 
 void pg_perf_enable(void)
 {
-    *(volatile char *) 0x40000000 = 1;
+    asm volatile("csrc mcountinhibit, %0" ::"r"(PG_MCOUNTINHIBIT_CY_IR));
 }
 
 void pg_perf_disable(void)
 {
-    *(volatile char *) 0x40000000 = 2;
+    asm volatile("csrs mcountinhibit, %0" ::"r"(PG_MCOUNTINHIBIT_CY_IR));
+}
+
+// Cycles in which a request waited for another core on the given data memory bank (USE_BANKED_DMEM)
+unsigned int pg_dmem_bank_conflicts(int bank)
+{
+    return *(volatile unsigned int *) (0x40002000 + 4 * bank);
 }
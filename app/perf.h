@@ -2,6 +2,8 @@
 / Released under the MIT license https://opensource.org/licenses/mit           */
 
 unsigned long long pg_perf_cycle(void);
+unsigned long long pg_perf_instret(void);
 void pg_perf_reset(void);
 void pg_perf_enable(void);
 void pg_perf_disable(void);
+unsigned int pg_dmem_bank_conflicts(int bank);
@@ -0,0 +1,161 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+#include "pmu.h"
+
+#include "perf.h"
+#include "util.h"
+
+// Per-core performance monitoring unit, the event counters mhpmcounter3.. selected by mhpmevent3..
+// The CSR number is a part of the instruction, so the counters are accessed through a switch.
+#define PG_PMU_CASES(X) X(0, 3) X(1, 4) X(2, 5) X(3, 6) X(4, 7) X(5, 8) X(6, 9) X(7, 10)
+
+// mcountinhibit bits of cycle, instret and every event counter
+#define PG_PMU_INHIBIT_ALL 0xfffffffd
+
+// The shared enable of the counters of all the cores, they count while it and mcountinhibit allow
+#define PG_PMU_RUN ((volatile unsigned int *) 0x4000000c)
+
+static const char *const pmu_event_names[PG_PMU_NEVENTS] = {
+    "none", "cycle", "instret", "dmem stall", "vmem stall", "mmio stall", "arb loss", "sc fail",
+    "br misp", "mul stall", "div stall", "cfu stall", "load-use", "branch", "wrs/wfi stall",
+    "fpu stall",
+};
+
+static void pmu_write_event(int counter, unsigned int event)
+{
+    switch (counter) {
+#define X(c, n) \
+    case c: asm volatile("csrw mhpmevent" #n ", %0" ::"r"(event)); break;
+        PG_PMU_CASES(X)
+#undef X
+    default: break;
+    }
+}
+
+int pg_pmu_event(int counter)
+{
+    unsigned int event = 0;
+    switch (counter) {
+#define X(c, n) \
+    case c: asm volatile("csrr %0, mhpmevent" #n : "=r"(event)); break;
+        PG_PMU_CASES(X)
+#undef X
+    default: break;
+    }
+    return event;
+}
+
+static void pmu_write_counter(int counter, unsigned int lo, unsigned int hi)
+{
+    switch (counter) {
+#define X(c, n)                                                \
+    case c:                                                    \
+        asm volatile("csrw mhpmcounter" #n ", %0" ::"r"(lo));  \
+        asm volatile("csrw mhpmcounter" #n "h, %0" ::"r"(hi)); \
+        break;
+        PG_PMU_CASES(X)
+#undef X
+    default: break;
+    }
+}
+
+// The number of event counters of this core, an unimplemented mhpmevent reads as zero
+int pg_pmu_counters(void)
+{
+    int n = 0;
+    while (n < PG_PMU_MAX_COUNTERS) {
+        int event = pg_pmu_event(n);
+        pmu_write_event(n, PG_PMU_EV_CYCLE);
+        int present = (pg_pmu_event(n) == PG_PMU_EV_CYCLE);
+        pmu_write_event(n, event);
+        if (!present) {
+            break;
+        }
+        n++;
+    }
+    return n;
+}
+
+// Count event (PG_PMU_EV_*) on the given counter
+void pg_pmu_select(int counter, int event)
+{
+    pmu_write_event(counter, event);
+}
+
+unsigned long long pg_pmu_read(int counter)
+{
+    unsigned int hi = 0, lo = 0, hi2 = 0;
+    do {
+        switch (counter) {
+#define X(c, n)                                                \
+    case c:                                                    \
+        asm volatile("csrr %0, mhpmcounter" #n "h" : "=r"(hi)); \
+        asm volatile("csrr %0, mhpmcounter" #n : "=r"(lo));     \
+        asm volatile("csrr %0, mhpmcounter" #n "h" : "=r"(hi2)); \
+        break;
+            PG_PMU_CASES(X)
+#undef X
+        default: break;
+        }
+    } while (hi != hi2);
+    return ((unsigned long long) hi << 32) | lo;
+}
+
+// Stop all the counters of this core and clear them, the event selections are kept
+void pg_pmu_reset(void)
+{
+    pg_pmu_stop();
+    pg_perf_reset();
+    for (int i = 0; i < PG_PMU_MAX_COUNTERS; i++) {
+        pmu_write_counter(i, 0, 0);
+    }
+}
+
+// Start or stop cycle, instret and all the event counters of this core at once
+void pg_pmu_start(void)
+{
+    asm volatile("csrc mcountinhibit, %0" ::"r"(PG_PMU_INHIBIT_ALL));
+}
+
+void pg_pmu_stop(void)
+{
+    asm volatile("csrs mcountinhibit, %0" ::"r"(PG_PMU_INHIBIT_ALL));
+}
+
+// Start or stop the counters of all the cores in the same cycle, e.g. by one hart around a
+// region measured on every core, after each core has cleared mcountinhibit with pg_pmu_start()
+void pg_pmu_global_start(void)
+{
+    *PG_PMU_RUN = 1;
+}
+
+void pg_pmu_global_stop(void)
+{
+    *PG_PMU_RUN = 0;
+}
+
+// Print cycle, instret and the event counters of this core
+void pg_pmu_report(void)
+{
+    pg_prints("hart ");
+    pg_printd(pg_hart_id());
+    pg_prints(" cycle ");
+    pg_printd(pg_perf_cycle());
+    pg_prints(" instret ");
+    pg_printd(pg_perf_instret());
+    pg_prints("\n");
+
+    int n = pg_pmu_counters();
+    for (int i = 0; i < n; i++) {
+        int event = pg_pmu_event(i);
+        if (event == PG_PMU_EV_NONE || event >= PG_PMU_NEVENTS) {
+            continue;
+        }
+        pg_prints("  ");
+        pg_prints(pmu_event_names[event]);
+        pg_prints(" ");
+        pg_printd(pg_pmu_read(i));
+        pg_prints("\n");
+    }
+}
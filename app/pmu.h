@@ -0,0 +1,34 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+#define PG_PMU_MAX_COUNTERS 8
+
+// events of the mhpmevent CSRs, the same as PMU_EV_* in config.vh
+#define PG_PMU_EV_NONE 0
+#define PG_PMU_EV_CYCLE 1
+#define PG_PMU_EV_INSTRET 2
+#define PG_PMU_EV_DMEM_STALL 3
+#define PG_PMU_EV_VMEM_STALL 4
+#define PG_PMU_EV_MMIO_STALL 5
+#define PG_PMU_EV_ARB_LOSS 6
+#define PG_PMU_EV_SC_FAIL 7
+#define PG_PMU_EV_BR_MISP 8
+#define PG_PMU_EV_MUL_STALL 9
+#define PG_PMU_EV_DIV_STALL 10
+#define PG_PMU_EV_CFU_STALL 11
+#define PG_PMU_EV_LOAD_USE 12
+#define PG_PMU_EV_BRANCH 13
+#define PG_PMU_EV_WRS_STALL 14
+#define PG_PMU_EV_FPU_STALL 15
+#define PG_PMU_NEVENTS 16
+
+int pg_pmu_counters(void);
+void pg_pmu_select(int counter, int event);
+int pg_pmu_event(int counter);
+unsigned long long pg_pmu_read(int counter);
+void pg_pmu_reset(void);
+void pg_pmu_start(void);
+void pg_pmu_stop(void);
+void pg_pmu_global_start(void);
+void pg_pmu_global_stop(void);
+void pg_pmu_report(void);
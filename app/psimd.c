@@ -0,0 +1,77 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+#include "psimd.h"
+
+// The packed SIMD operations in software, for builds without USE_PSIMD
+static unsigned int psimd_lane(int op, int w, unsigned int a, unsigned int b)
+{
+    unsigned int mask = (1u << w) - 1;
+    int sa = (a & (1u << (w - 1))) ? (int) a - (1 << w) : (int) a;
+    int sb = (b & (1u << (w - 1))) ? (int) b - (1 << w) : (int) b;
+    int smax = (1 << (w - 1)) - 1;
+    int smin = -(1 << (w - 1));
+    int s;
+
+    switch (op) {
+    case PG_PSIMD_ADD:
+        return (a + b) & mask;
+    case PG_PSIMD_SUB:
+        return (a - b) & mask;
+    case PG_PSIMD_ADDS:
+        s = sa + sb;
+        return (s > smax ? smax : s < smin ? smin : s) & mask;
+    case PG_PSIMD_ADDUS:
+        return (a + b > mask) ? mask : a + b;
+    case PG_PSIMD_SUBS:
+        s = sa - sb;
+        return (s > smax ? smax : s < smin ? smin : s) & mask;
+    case PG_PSIMD_SUBUS:
+        return (a < b) ? 0 : a - b;
+    case PG_PSIMD_CMPEQ:
+        return (a == b) ? mask : 0;
+    case PG_PSIMD_CMPLT:
+        return (sa < sb) ? mask : 0;
+    case PG_PSIMD_CMPLTU:
+        return (a < b) ? mask : 0;
+    case PG_PSIMD_MIN:
+        return (sa < sb) ? a : b;
+    case PG_PSIMD_MINU:
+        return (a < b) ? a : b;
+    case PG_PSIMD_MAX:
+        return (sa < sb) ? b : a;
+    case PG_PSIMD_MAXU:
+        return (a < b) ? b : a;
+    case PG_PSIMD_SLL:
+        return (a << (b & (w - 1))) & mask;
+    case PG_PSIMD_SRL:
+        return a >> (b & (w - 1));
+    case PG_PSIMD_SRA:
+        return (sa >> (b & (w - 1))) & mask;
+    default:
+        return 0;
+    }
+}
+
+unsigned int pg_psimd_emulate(int op, int w16, unsigned int a, unsigned int b)
+{
+    int w = (w16) ? 16 : 8;
+    unsigned int mask = (1u << w) - 1;
+    unsigned int rslt = 0;
+
+    for (int i = 0; i < 32; i += w) {
+        unsigned int la = (a >> i) & mask;
+        unsigned int lb = (b >> i) & mask;
+        if (op == PG_PSIMD_DOT) {
+            int sa = (la & (1u << (w - 1))) ? (int) la - (1 << w) : (int) la;
+            int sb = (lb & (1u << (w - 1))) ? (int) lb - (1 << w) : (int) lb;
+            rslt += (unsigned int) (sa * sb);
+        } else if (op == PG_PSIMD_DOTU) {
+            rslt += la * lb;
+        } else {
+            // the shifts take the shift amount from the low bits of b, not from each lane
+            rslt |= psimd_lane(op, w, la, (op >= PG_PSIMD_SLL) ? b : lb) << i;
+        }
+    }
+    return rslt;
+}
@@ -0,0 +1,93 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+#ifndef PG_PSIMD_H
+#define PG_PSIMD_H
+
+// Packed SIMD on 4 x 8-bit (the *8 functions) or 2 x 16-bit (the *16 functions) lanes of a word.
+// With USE_PSIMD each function is one custom-1 instruction executed in EX, the same as the
+// PSIMD_OP_* in config.vh. Without it the functions are computed by pg_psimd_emulate().
+#define PG_PSIMD_ADD 0
+#define PG_PSIMD_SUB 1
+#define PG_PSIMD_ADDS 2
+#define PG_PSIMD_ADDUS 3
+#define PG_PSIMD_SUBS 4
+#define PG_PSIMD_SUBUS 5
+#define PG_PSIMD_CMPEQ 6
+#define PG_PSIMD_CMPLT 7
+#define PG_PSIMD_CMPLTU 8
+#define PG_PSIMD_MIN 9
+#define PG_PSIMD_MINU 10
+#define PG_PSIMD_MAX 11
+#define PG_PSIMD_MAXU 12
+#define PG_PSIMD_SLL 13
+#define PG_PSIMD_SRL 14
+#define PG_PSIMD_SRA 15
+#define PG_PSIMD_DOT 16
+#define PG_PSIMD_DOTU 17
+
+unsigned int pg_psimd_emulate(int op, int w16, unsigned int a, unsigned int b);
+
+#ifdef USE_PSIMD
+#define PG_PSIMD_INSN(op, w16, a, b)                                                               \
+    ({                                                                                             \
+        unsigned int rslt_;                                                                        \
+        asm(".insn r 0x2b, %3, %4, %0, %1, %2" : "=r"(rslt_) : "r"(a), "r"(b), "i"(w16), "i"(op)); \
+        rslt_;                                                                                     \
+    })
+#else
+#define PG_PSIMD_INSN(op, w16, a, b) pg_psimd_emulate(op, w16, a, b)
+#endif
+
+#define PG_PSIMD_FUNC(name, op)                                                                    \
+    static inline unsigned int pg_##name##8(unsigned int a, unsigned int b)                        \
+    {                                                                                              \
+        return PG_PSIMD_INSN(op, 0, a, b);                                                         \
+    }                                                                                              \
+    static inline unsigned int pg_##name##16(unsigned int a, unsigned int b)                       \
+    {                                                                                              \
+        return PG_PSIMD_INSN(op, 1, a, b);                                                         \
+    }
+
+PG_PSIMD_FUNC(padd, PG_PSIMD_ADD)       // wrapping add
+PG_PSIMD_FUNC(psub, PG_PSIMD_SUB)       // wrapping subtract
+PG_PSIMD_FUNC(padds, PG_PSIMD_ADDS)     // signed saturating add
+PG_PSIMD_FUNC(paddus, PG_PSIMD_ADDUS)   // unsigned saturating add
+PG_PSIMD_FUNC(psubs, PG_PSIMD_SUBS)     // signed saturating subtract
+PG_PSIMD_FUNC(psubus, PG_PSIMD_SUBUS)   // unsigned saturating subtract
+PG_PSIMD_FUNC(pcmpeq, PG_PSIMD_CMPEQ)   // all ones in the lanes where a == b
+PG_PSIMD_FUNC(pcmplt, PG_PSIMD_CMPLT)   // all ones in the lanes where a < b (signed)
+PG_PSIMD_FUNC(pcmpltu, PG_PSIMD_CMPLTU) // all ones in the lanes where a < b (unsigned)
+PG_PSIMD_FUNC(pmin, PG_PSIMD_MIN)
+PG_PSIMD_FUNC(pminu, PG_PSIMD_MINU)
+PG_PSIMD_FUNC(pmax, PG_PSIMD_MAX)
+PG_PSIMD_FUNC(pmaxu, PG_PSIMD_MAXU)
+PG_PSIMD_FUNC(psll, PG_PSIMD_SLL)       // every lane shifted by b modulo the lane width
+PG_PSIMD_FUNC(psrl, PG_PSIMD_SRL)
+PG_PSIMD_FUNC(psra, PG_PSIMD_SRA)
+PG_PSIMD_FUNC(pdot, PG_PSIMD_DOT)       // sum of the signed lane products
+PG_PSIMD_FUNC(pdotu, PG_PSIMD_DOTU)     // sum of the unsigned lane products
+
+// dot-product-accumulate, the sum is added to acc by a separate add
+static inline int pg_pdot8_acc(int acc, unsigned int a, unsigned int b)
+{
+    return acc + (int) pg_pdot8(a, b);
+}
+
+static inline int pg_pdot16_acc(int acc, unsigned int a, unsigned int b)
+{
+    return acc + (int) pg_pdot16(a, b);
+}
+
+// the same element in every lane
+static inline unsigned int pg_splat8(unsigned int x)
+{
+    return (x & 0xff) * 0x01010101u;
+}
+
+static inline unsigned int pg_splat16(unsigned int x)
+{
+    return (x & 0xffff) * 0x00010001u;
+}
+
+#endif /* PG_PSIMD_H */
@@ -0,0 +1,126 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+#include "trap.h"
+
+#include "util.h"
+
+// Core-local interruptor (src/clint.v) and machine-mode traps
+#define PG_CLINT_MSIP(h) ((volatile unsigned int *) (0x40007000 + 4 * (h)))
+#define PG_CLINT_MTIMECMP_LO(h) ((volatile unsigned int *) (0x40007400 + 8 * (h)))
+#define PG_CLINT_MTIMECMP_HI(h) ((volatile unsigned int *) (0x40007404 + 8 * (h)))
+#define PG_CLINT_MTIME_LO ((volatile unsigned int *) 0x40007ff8)
+#define PG_CLINT_MTIME_HI ((volatile unsigned int *) 0x40007ffc)
+
+#define PG_MIE_MSIE (1 << 3)
+#define PG_MIE_MTIE (1 << 7)
+#define PG_MSTATUS_MIE (1 << 3)
+
+// Called by the trap vector in crt0.s, returns the pc to resume at.
+// An interrupt is acknowledged by disabling it, define this function to handle traps otherwise.
+__attribute__((weak)) unsigned int pg_trap_handler(unsigned int mcause, unsigned int mepc)
+{
+    if (mcause == 0x80000007) { // machine timer interrupt
+        asm volatile("csrc mie, %0" ::"r"(PG_MIE_MTIE));
+        return mepc;
+    }
+    if (mcause == 0x80000003) { // machine software interrupt
+        pg_ipi_clear();
+        return mepc;
+    }
+    if (mcause == 2) { // illegal instruction, a reserved RVC parcel or an unimplemented vector one
+        unsigned int mtval;
+        asm volatile("csrr %0, mtval" : "=r"(mtval));
+        pg_prints("illegal instruction 0x");
+        pg_printh(mtval);
+        pg_prints(" at 0x");
+        pg_printh(mepc);
+        pg_prints("\n");
+        pg_exit();
+        while (1) {}
+    }
+    if (mcause == 3) { // ebreak, mtval holds its bits and a c.ebreak has the low bits != 3
+        unsigned int mtval;
+        asm volatile("csrr %0, mtval" : "=r"(mtval));
+        return mepc + (((mtval & 3) == 3) ? 4 : 2);
+    }
+    // ecall resumes at the next instruction
+    return mepc + 4;
+}
+
+// Wait until an interrupt enabled in mie is pending, mstatus.MIE does not need to be set
+void pg_wfi(void)
+{
+    asm volatile("wfi" ::: "memory");
+}
+
+void pg_irq_enable(void)
+{
+    asm volatile("csrs mstatus, %0" ::"r"(PG_MSTATUS_MIE));
+}
+
+void pg_irq_disable(void)
+{
+    asm volatile("csrc mstatus, %0" ::"r"(PG_MSTATUS_MIE));
+}
+
+// The number of cycles since the power on, shared by all the harts
+unsigned long long pg_mtime(void)
+{
+    unsigned int hi, lo;
+    do {
+        hi = *PG_CLINT_MTIME_HI;
+        lo = *PG_CLINT_MTIME_LO;
+    } while (hi != *PG_CLINT_MTIME_HI);
+    return ((unsigned long long) hi << 32) | lo;
+}
+
+// The timer interrupt of hart_id is pending while mtime >= mtimecmp
+void pg_timer_set(int hart_id, unsigned long long mtimecmp)
+{
+    *PG_CLINT_MTIMECMP_HI(hart_id) = 0xffffffff; // no spurious interrupt while updating
+    *PG_CLINT_MTIMECMP_LO(hart_id) = (unsigned int) mtimecmp;
+    *PG_CLINT_MTIMECMP_HI(hart_id) = (unsigned int) (mtimecmp >> 32);
+}
+
+// Sleep in wfi until mtime reaches the given value
+void pg_sleep_until(unsigned long long mtime)
+{
+    int hart_id = pg_hart_id();
+    pg_timer_set(hart_id, mtime);
+    asm volatile("csrs mie, %0" ::"r"(PG_MIE_MTIE));
+    while (pg_mtime() < mtime) {
+        pg_wfi();
+    }
+    asm volatile("csrc mie, %0" ::"r"(PG_MIE_MTIE));
+    pg_timer_set(hart_id, 0xffffffffffffffffULL);
+}
+
+void pg_sleep_cycles(unsigned int cycles)
+{
+    pg_sleep_until(pg_mtime() + cycles);
+}
+
+// Raise the software interrupt of hart_id
+void pg_ipi_send(int hart_id)
+{
+    asm volatile("fence" ::: "memory"); // make the stores before the interrupt visible first
+    *PG_CLINT_MSIP(hart_id) = 1;
+}
+
+void pg_ipi_clear(void)
+{
+    *PG_CLINT_MSIP(pg_hart_id()) = 0;
+}
+
+// Sleep in wfi until the software interrupt of this hart is raised, then clear it
+void pg_wait_ipi(void)
+{
+    volatile unsigned int *msip = PG_CLINT_MSIP(pg_hart_id());
+    asm volatile("csrs mie, %0" ::"r"(PG_MIE_MSIE));
+    while (*msip == 0) {
+        pg_wfi();
+    }
+    asm volatile("csrc mie, %0" ::"r"(PG_MIE_MSIE));
+    *msip = 0;
+}
@@ -0,0 +1,14 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+unsigned int pg_trap_handler(unsigned int mcause, unsigned int mepc);
+void pg_wfi(void);
+void pg_irq_enable(void);
+void pg_irq_disable(void);
+unsigned long long pg_mtime(void);
+void pg_timer_set(int hart_id, unsigned long long mtimecmp);
+void pg_sleep_until(unsigned long long mtime);
+void pg_sleep_cycles(unsigned int cycles);
+void pg_ipi_send(int hart_id);
+void pg_ipi_clear(void);
+void pg_wait_ipi(void);
@@ -36,10 +36,11 @@ void pg_printh(int x)
 {
     char buf[16];
     int i = 0;
-    while (x) {
-        buf[i++] = "0123456789ABCDEF"[x & 0xF];
-        x >>= 4;
-    }
+    unsigned int u = x; // a logical shift, so that a negative x terminates
+    do {
+        buf[i++] = "0123456789ABCDEF"[u & 0xF];
+        u >>= 4;
+    } while (u);
     while (i--) {
         pg_printc(buf[i]);
     }
@@ -55,5 +56,12 @@ void pg_prints(const char *str)
 
 int pg_hart_id()
 {
-    return *(int *) 0x40001000;
+    int hart_id;
+    asm volatile("csrr %0, mhartid" : "=r"(hart_id));
+    return hart_id;
+}
+
+int pg_cluster_id()
+{
+    return *(int *) 0x40001004;
 }
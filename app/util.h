@@ -7,3 +7,4 @@ void pg_printd(long long x);
 void pg_printh(int x);
 void pg_prints(const char *str);
 int pg_hart_id();
+int pg_cluster_id();
@@ -0,0 +1,148 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+#include "vector.h"
+
+#ifdef USE_VECTOR
+
+// zve32x is enabled only inside these asm statements, so that the compiler never generates
+// vector code of its own, e.g. for auto-vectorized loops or memcpy, which the vector unit does
+// not implement. The compiler does not allocate the vector registers either.
+#define PG_VEC_BEGIN ".option push\n\t.option arch, +zve32x\n\t"
+#define PG_VEC_END ".option pop"
+
+// Each strip processes vl = min(n, VLEN / 32) elements. The vector loads and stores issue one
+// element per cycle on the data bus without fetching an instruction per element.
+void pg_vcopy(int *dst, const int *src, int n)
+{
+    int vl;
+    for (; n > 0; n -= vl, src += vl, dst += vl) {
+        asm volatile(PG_VEC_BEGIN
+                     "vsetvli %0, %1, e32, m1, ta, ma\n\t"
+                     "vle32.v v8, (%2)\n\t"
+                     "vse32.v v8, (%3)\n\t"
+                     PG_VEC_END
+                     : "=&r"(vl)
+                     : "r"(n), "r"(src), "r"(dst)
+                     : "memory");
+    }
+}
+
+void pg_vfill(int *dst, int val, int n)
+{
+    int vl;
+    for (; n > 0; n -= vl, dst += vl) {
+        asm volatile(PG_VEC_BEGIN
+                     "vsetvli %0, %1, e32, m1, ta, ma\n\t"
+                     "vmv.v.x v8, %2\n\t"
+                     "vse32.v v8, (%3)\n\t"
+                     PG_VEC_END
+                     : "=&r"(vl)
+                     : "r"(n), "r"(val), "r"(dst)
+                     : "memory");
+    }
+}
+
+void pg_vadd(int *dst, const int *a, const int *b, int n)
+{
+    int vl;
+    for (; n > 0; n -= vl, a += vl, b += vl, dst += vl) {
+        asm volatile(PG_VEC_BEGIN
+                     "vsetvli %0, %1, e32, m1, ta, ma\n\t"
+                     "vle32.v v8, (%2)\n\t"
+                     "vle32.v v9, (%3)\n\t"
+                     "vadd.vv v8, v8, v9\n\t"
+                     "vse32.v v8, (%4)\n\t"
+                     PG_VEC_END
+                     : "=&r"(vl)
+                     : "r"(n), "r"(a), "r"(b), "r"(dst)
+                     : "v8", "v9", "memory");
+    }
+}
+
+int pg_vsum(const int *src, int n)
+{
+    int vl;
+    int sum = 0;
+    for (; n > 0; n -= vl, src += vl) {
+        asm volatile(PG_VEC_BEGIN
+                     "vsetvli %0, %2, e32, m1, ta, ma\n\t"
+                     "vle32.v v8, (%3)\n\t"
+                     "vmv.s.x v9, %1\n\t"
+                     "vredsum.vs v9, v8, v9\n\t"
+                     "vmv.x.s %1, v9\n\t"
+                     PG_VEC_END
+                     : "=&r"(vl), "+r"(sum)
+                     : "r"(n), "r"(src)
+                     : "v8", "v9", "memory");
+    }
+    return sum;
+}
+
+void pg_vgather(int *dst, const int *src, int stride, int n)
+{
+    int vl;
+    for (; n > 0; n -= vl, src += vl * stride, dst += vl) {
+        asm volatile(PG_VEC_BEGIN
+                     "vsetvli %0, %1, e32, m1, ta, ma\n\t"
+                     "vlse32.v v8, (%2), %3\n\t"
+                     "vse32.v v8, (%4)\n\t"
+                     PG_VEC_END
+                     : "=&r"(vl)
+                     : "r"(n), "r"(src), "r"(stride * 4), "r"(dst)
+                     : "memory");
+    }
+}
+
+int pg_vlmax(void)
+{
+    int vl;
+    asm volatile(PG_VEC_BEGIN "vsetvli %0, zero, e32, m1, ta, ma\n\t" PG_VEC_END : "=r"(vl));
+    return vl;
+}
+
+#else
+
+void pg_vcopy(int *dst, const int *src, int n)
+{
+    for (int i = 0; i < n; i++) {
+        dst[i] = src[i];
+    }
+}
+
+void pg_vfill(int *dst, int val, int n)
+{
+    for (int i = 0; i < n; i++) {
+        dst[i] = val;
+    }
+}
+
+void pg_vadd(int *dst, const int *a, const int *b, int n)
+{
+    for (int i = 0; i < n; i++) {
+        dst[i] = a[i] + b[i];
+    }
+}
+
+int pg_vsum(const int *src, int n)
+{
+    int sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += src[i];
+    }
+    return sum;
+}
+
+void pg_vgather(int *dst, const int *src, int stride, int n)
+{
+    for (int i = 0; i < n; i++) {
+        dst[i] = src[i * stride];
+    }
+}
+
+int pg_vlmax(void)
+{
+    return 0;
+}
+
+#endif
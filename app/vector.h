@@ -0,0 +1,16 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+#ifndef PG_VECTOR_H
+#define PG_VECTOR_H
+
+// Streaming kernels on 32-bit elements. With USE_VECTOR they are strip-mined loops of vector
+// instructions (vsetvli, vle32.v/vlse32.v, vse32.v), otherwise scalar loops.
+void pg_vcopy(int *dst, const int *src, int n);
+void pg_vfill(int *dst, int val, int n);
+void pg_vadd(int *dst, const int *a, const int *b, int n);
+int pg_vsum(const int *src, int n);
+void pg_vgather(int *dst, const int *src, int stride, int n); // dst[i] = src[i * stride]
+int pg_vlmax(void); // the elements of a vector register, 0 without USE_VECTOR
+
+#endif /* PG_VECTOR_H */
@@ -7,18 +7,28 @@ VPP     := /tools/Xilinx/Vitis/2024.1/bin/v++
 RTLSIM  := /tools/cad/bin/verilator
 
 USE_HLS ?= 0
+USE_FPU ?= 0
+USE_BITMANIP ?= 0
+USE_PSIMD ?= 0
+USE_VECTOR ?= 0
+USE_RVC ?= 0
+USE_CLUSTERED_DMEM ?= 0
 NCORES ?= 4
 IMEM_SIZE_KB ?= 128
 DMEM_SIZE_KB ?= 120
 STACK_SIZE_KB ?= 2
+TCM_SIZE_KB ?= 0
+DMEM_NBANKS ?= 4
 CLK_FREQ_MHZ ?= 135
 
 IMEM_SIZE ?= $(shell echo $(IMEM_SIZE_KB)*1024 | bc)
 DMEM_SIZE ?= $(shell echo $(DMEM_SIZE_KB)*1024 | bc)
 STACK_SIZE ?= $(shell echo $(STACK_SIZE_KB)*1024 | bc)
+TCM_SIZE ?= $(shell echo $(TCM_SIZE_KB)*1024 | bc)
 IMEM_SIZE_HEX := $(shell printf "0x%X" $(IMEM_SIZE))
 DMEM_SIZE_HEX := $(shell printf "0x%X" $(DMEM_SIZE))
 STACK_SIZE_HEX := $(shell printf "0x%X" $(STACK_SIZE))
+TCM_SIZE_HEX := $(shell printf "0x%X" $(TCM_SIZE))
 
 src_dir := src
 cfu_dir := cfu
@@ -19,12 +19,82 @@
 
 `define BTB_ENTRY (2*1024)  // the number of BTB entries for branch prediction
 
+`ifndef WRS_STO_CYCLES
+`define WRS_STO_CYCLES 1024 // the maximum number of cycles a wrs.sto waits on its reservation
+`endif
+
+`ifndef PMU_COUNTERS
+`define PMU_COUNTERS 4 // the number of programmable event counters (mhpmcounter3..) per core, 0 to 28
+`endif
+
 `ifndef NCORES
 `define NCORES 4
 `endif
 
+// `define USE_FPU 1 // single-precision FPU (RV32F) in every core, build the software with USE_FPU=1
+// `define USE_BITMANIP 1 // Zba, Zbb and Zbs in the ALU, build the software with USE_BITMANIP=1
+// `define USE_PSIMD 1 // packed 8/16-bit SIMD on the custom-1 opcode, build the software with USE_PSIMD=1
+// `define USE_VECTOR 1 // minimal vector unit (Zve32x subset), build the software with USE_VECTOR=1
+// `define USE_RVC 1 // RV32C compressed instructions, build the software with USE_RVC=1
+
+`ifndef VLEN
+`define VLEN 128 // the bits of a vector register with USE_VECTOR, a multiple of 32
+`endif
+
 // dmem dbus selection
 // `define USE_COMB_DBUS 1
+// `define USE_DUAL_ISSUE_DBUS 1 // dmem_controller serves any two cores on the two ports
+// `define USE_DBUS_BYPASS 1 // dmem_controller serves a new plain load/store in the cycle it arrives
+// `define USE_L1_DCACHE 1 // per-core write-back L1 data cache with snooping coherence
+// `define USE_BANKED_DMEM 1 // word-interleaved data memory banks with a crossbar
+// `define USE_REPLICATED_DMEM 1 // one data memory read replica per core with a shared write port
+
+// `define USE_CLUSTERED_DMEM 1 // clusters of CLUSTER_SIZE cores with a cluster-local memory and one port to dmem
+
+// `define USE_STORE_BUFFER 1 // per-core store buffer between the cpu and the data bus
+
+// hardware barrier
+`ifndef HW_BARRIER_SLOTS
+`define HW_BARRIER_SLOTS 8 // the number of hardware barrier slots at 0x40003000, 0 to disable
+`endif
+
+// hardware lock
+`ifndef HW_LOCKS
+`define HW_LOCKS 8 // the number of hardware queued locks at 0x40004000, 0 to disable
+`endif
+
+// mailbox
+`ifndef MBOX_DEPTH
+`define MBOX_DEPTH 4 // the number of words in the mailbox inbox of each core at 0x40005000, a power of two, 0 to disable
+`endif
+
+// work dispenser
+`ifndef HW_DISPENSERS
+`define HW_DISPENSERS 4 // the number of fetch-and-add work dispensers at 0x40006000, 0 to disable
+`endif
+
+// store buffer
+`ifndef STORE_BUFFER_DEPTH
+`define STORE_BUFFER_DEPTH 4 // the number of store buffer entries per core, a power of two
+`endif
+
+// banked data memory
+`ifndef DMEM_NBANKS
+`define DMEM_NBANKS 4 // the number of data memory banks, a power of two, set by DMEM_NBANKS in config.mk
+`endif
+
+// cluster
+`ifndef CLUSTER_SIZE
+`define CLUSTER_SIZE 2 // the number of cores per cluster, NCORES must be a multiple of it with at least two clusters
+`endif
+`ifndef CLUSTER_MEM_SIZE
+`define CLUSTER_MEM_SIZE (16*1024) // cluster-local memory size per cluster in byte
+`endif
+
+// l1 data cache
+`ifndef L1_DCACHE_SIZE
+`define L1_DCACHE_SIZE (1*1024) // L1 data cache size per core in byte
+`endif
 
 // ram
 `ifndef IMEM_SIZE
@@ -37,16 +107,24 @@
 `ifndef STACK_SIZE
 `define STACK_SIZE (2*1024) // stack size per core in byte
 `endif
+`ifndef TCM_SIZE
+`define TCM_SIZE 0 // tightly-coupled data memory size per core in byte, 0 to disable
+`endif
 
 `define IMEM_ENTRIES (`IMEM_SIZE/4)
 `define DMEM_ENTRIES (`DMEM_SIZE/4)
 `define VMEM_ENTRIES `VMEM_SIZE
 `define STACK_ENTRIES (`STACK_SIZE/4)
+`define TCM_ENTRIES (`TCM_SIZE/4)
+`define L1_DCACHE_ENTRIES (`L1_DCACHE_SIZE/4)
+`define CMEM_ENTRIES (`CLUSTER_MEM_SIZE/4)
 
 `define IMEM_ADDRW ($clog2(`IMEM_ENTRIES))
 `define DMEM_ADDRW ($clog2(`DMEM_ENTRIES))
 `define VMEM_ADDRW ($clog2(`VMEM_ENTRIES))
 `define STACK_ADDRW ($clog2(`STACK_ENTRIES))
+`define TCM_ADDRW ($clog2(`TCM_ENTRIES))
+`define CMEM_ADDRW ($clog2(`CMEM_ENTRIES))
 
 // uart
 `ifndef BAUD_RATE
@@ -100,7 +178,23 @@
 `define ALU_CTRL_IS_XOR_OR 6
 `define ALU_CTRL_IS_OR_AND 7
 `define ALU_CTRL_IS_SRC2 8
-`define ALU_CTRL_WIDTH 9
+`define ALU_CTRL_IS_SHADD1 9    // sh1add: SHADD1, sh2add: SHADD2, sh3add: both
+`define ALU_CTRL_IS_SHADD2 10
+`define ALU_CTRL_IS_INV_SRC2 11  // andn, orn, xnor, bclr
+`define ALU_CTRL_IS_BIT_MASK 12  // bclr, binv, bset, src2 is the bit index
+`define ALU_CTRL_IS_BEXT 13
+`define ALU_CTRL_IS_ROTATE 14    // rol with SHIFT_LEFT, ror with SHIFT_RIGHT
+`define ALU_CTRL_IS_MIN 15
+`define ALU_CTRL_IS_MAX 16
+`define ALU_CTRL_IS_CLZ 17
+`define ALU_CTRL_IS_CTZ 18
+`define ALU_CTRL_IS_CPOP 19
+`define ALU_CTRL_IS_SEXT_B 20
+`define ALU_CTRL_IS_SEXT_H 21
+`define ALU_CTRL_IS_ZEXT_H 22
+`define ALU_CTRL_IS_REV8 23
+`define ALU_CTRL_IS_ORC_B 24
+`define ALU_CTRL_WIDTH 25
 
 // bru control
 `define BRU_CTRL_IS_CTRL_TSFR 0
@@ -122,7 +216,23 @@
 `define LSU_CTRL_IS_WORD 5
 `define LSU_CTRL_IS_LR 6
 `define LSU_CTRL_IS_SC 7
-`define LSU_CTRL_WIDTH 8
+`define LSU_CTRL_IS_AMO 8
+`define LSU_CTRL_IS_FENCE 9
+`define LSU_CTRL_IS_WRS 10
+`define LSU_CTRL_IS_WRS_STO 11
+`define LSU_CTRL_WIDTH 12
+
+// amo operation (funct5 of AMO instructions)
+`define AMO_OP_ADD 5'b00000
+`define AMO_OP_SWAP 5'b00001
+`define AMO_OP_XOR 5'b00100
+`define AMO_OP_OR 5'b01000
+`define AMO_OP_AND 5'b01100
+`define AMO_OP_MIN 5'b10000
+`define AMO_OP_MAX 5'b10100
+`define AMO_OP_MINU 5'b11000
+`define AMO_OP_MAXU 5'b11100
+`define AMO_OP_WIDTH 5
 
 // perf control
 `define PERF_CTRL_IS_CYCLE 0
@@ -144,8 +254,115 @@
 `define DIV_CTRL_IS_REM 2
 `define DIV_CTRL_WIDTH 3
 
+// sys control (SYSTEM opcode)
+`define SYS_CTRL_IS_CSR 0
+`define SYS_CTRL_IS_ECALL 1
+`define SYS_CTRL_IS_EBREAK 2
+`define SYS_CTRL_IS_MRET 3
+`define SYS_CTRL_IS_WFI 4
+`define SYS_CTRL_IS_ILLEGAL 5
+`define SYS_CTRL_WIDTH 6
+
+// csr address
+`define CSR_FFLAGS 12'h001
+`define CSR_FRM 12'h002
+`define CSR_FCSR 12'h003
+`define CSR_MSTATUS 12'h300
+`define CSR_MIE 12'h304
+`define CSR_MTVEC 12'h305
+`define CSR_MSCRATCH 12'h340
+`define CSR_MEPC 12'h341
+`define CSR_MCAUSE 12'h342
+`define CSR_MTVAL 12'h343
+`define CSR_MIP 12'h344
+`define CSR_MCOUNTINHIBIT 12'h320
+`define CSR_MCYCLE 12'hb00
+`define CSR_MINSTRET 12'hb02
+`define CSR_MCYCLEH 12'hb80
+`define CSR_MINSTRETH 12'hb82
+`define CSR_CYCLE 12'hc00
+`define CSR_TIME 12'hc01
+`define CSR_INSTRET 12'hc02
+`define CSR_CYCLEH 12'hc80
+`define CSR_TIMEH 12'hc81
+`define CSR_INSTRETH 12'hc82
+`define CSR_MHARTID 12'hf14
+`define CSR_VL 12'hc20
+`define CSR_VTYPE 12'hc21
+`define CSR_VLENB 12'hc22
+`define CSR_MHPMEVENT3 12'h323
+`define CSR_MHPMCOUNTER3 12'hb03
+`define CSR_MHPMCOUNTER3H 12'hb83
+`define CSR_HPMCOUNTER3 12'hc03
+`define CSR_HPMCOUNTER3H 12'hc83
+
+// performance monitoring events (mhpmevent), each event counts at most one per cycle
+`define PMU_EV_NONE 0
+`define PMU_EV_CYCLE 1       // clock cycles
+`define PMU_EV_INSTRET 2     // retired instructions
+`define PMU_EV_DMEM_STALL 3  // cycles waiting on the data memory (shared or cluster-local)
+`define PMU_EV_VMEM_STALL 4  // cycles waiting on the video memory
+`define PMU_EV_MMIO_STALL 5  // cycles waiting on the barrier, lock and mailbox units
+`define PMU_EV_ARB_LOSS 6    // cycles waiting on the data memory while another core accesses it
+`define PMU_EV_SC_FAIL 7     // failed SC
+`define PMU_EV_BR_MISP 8     // mispredicted branches and jumps
+`define PMU_EV_MUL_STALL 9   // bubbles waiting for a multiplier result
+`define PMU_EV_DIV_STALL 10  // cycles the divider holds the pipeline
+`define PMU_EV_CFU_STALL 11  // cycles the CFU holds the pipeline
+`define PMU_EV_LOAD_USE 12   // load-use bubbles
+`define PMU_EV_BRANCH 13     // retired branches and jumps
+`define PMU_EV_WRS_STALL 14  // cycles parked by wrs.nto, wrs.sto or wfi
+`define PMU_EV_FPU_STALL 15  // cycles fdiv/fsqrt holds the pipeline and bubbles waiting for an FPU result
+`define PMU_NEVENTS 16
+`define PMU_EV_WIDTH 4
+
+// l1 dcache bus command
+`define L1_CMD_RD 0     // read miss, the line is filled in shared state
+`define L1_CMD_RDX 1    // write miss or upgrade, the line is filled in modified state
+`define L1_CMD_WB 2     // write-back of an evicted modified line
+`define L1_CMD_ATOMIC 3 // uncached LR/SC/AMO
+`define L1_CMD_WIDTH 2
+
+// fpu control, the FP register operands of FPU operations, flw and fsw
+`define FPU_CTRL_IS_FPU 0
+`define FPU_CTRL_IS_FRD 1
+`define FPU_CTRL_IS_FRS1 2
+`define FPU_CTRL_IS_FRS2 3
+`define FPU_CTRL_IS_FRS3 4
+`define FPU_CTRL_WIDTH 5
+
 // cfu control
 `define CFU_CTRL_IS_CFU 0
 `define CFU_CTRL_WIDTH 11
 
+// packed simd control, {funct7, funct3, is_psimd} of the custom-1 opcode
+`define PSIMD_CTRL_IS_PSIMD 0
+`define PSIMD_CTRL_WIDTH 11
+
+// vector control, the vector loads and stores are unit-stride or strided with 32-bit elements
+`define VEC_CTRL_IS_VEC 0
+`define VEC_CTRL_IS_LOAD 1
+`define VEC_CTRL_IS_STORE 2
+`define VEC_CTRL_WIDTH 3
+
+// packed simd operation (funct7), funct3 0 selects 4 x 8-bit lanes and 1 selects 2 x 16-bit lanes
+`define PSIMD_OP_ADD 0
+`define PSIMD_OP_SUB 1
+`define PSIMD_OP_ADDS 2     // signed saturating
+`define PSIMD_OP_ADDUS 3    // unsigned saturating
+`define PSIMD_OP_SUBS 4
+`define PSIMD_OP_SUBUS 5
+`define PSIMD_OP_CMPEQ 6    // all ones in the lanes that compare true
+`define PSIMD_OP_CMPLT 7
+`define PSIMD_OP_CMPLTU 8
+`define PSIMD_OP_MIN 9
+`define PSIMD_OP_MINU 10
+`define PSIMD_OP_MAX 11
+`define PSIMD_OP_MAXU 12
+`define PSIMD_OP_SLL 13     // every lane is shifted by src2 modulo the lane width
+`define PSIMD_OP_SRL 14
+`define PSIMD_OP_SRA 15
+`define PSIMD_OP_DOT 16     // the 32-bit sum of the signed lane products
+`define PSIMD_OP_DOTU 17
+
 `endif  // RVCPU_H_
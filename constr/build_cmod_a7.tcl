@@ -12,6 +12,14 @@ set ncores 4
 set imem_size ""
 set dmem_size ""
 set stack_size ""
+set tcm_size ""
+set dmem_nbanks ""
+set use_fpu 0
+set use_bitmanip 0
+set use_psimd 0
+set use_vector 0
+set use_rvc 0
+set use_clustered 0
 set freq 140
 
 create_project -force $proj_name $top_dir/vivado -part $part_name
@@ -56,6 +64,24 @@ for {set i 0} {$i < $argc} {incr i} {
             puts "Error: --stack_size requires a value"
             exit 1
         }
+    } elseif {[lindex $argv $i] eq "--tcm_size"} {
+        incr i
+        if {$i < $argc} {
+            set tcm_size [lindex $argv $i]
+            puts "TCM_SIZE set to: $tcm_size"
+        } else {
+            puts "Error: --tcm_size requires a value"
+            exit 1
+        }
+    } elseif {[lindex $argv $i] eq "--dmem_nbanks"} {
+        incr i
+        if {$i < $argc} {
+            set dmem_nbanks [lindex $argv $i]
+            puts "DMEM_NBANKS set to: $dmem_nbanks"
+        } else {
+            puts "Error: --dmem_nbanks requires a value"
+            exit 1
+        }
     } elseif {[lindex $argv $i] eq "--clk_freq"} {
         incr i
         if {$i < $argc} {
@@ -65,6 +91,24 @@ for {set i 0} {$i < $argc} {incr i} {
             puts "Error: --clk_freq requires a value"
             exit 1
         }
+    } elseif {[lindex $argv $i] eq "--fpu"} {
+        set use_fpu 1
+        puts "FPU enabled."
+    } elseif {[lindex $argv $i] eq "--bitmanip"} {
+        set use_bitmanip 1
+        puts "Zba/Zbb/Zbs enabled."
+    } elseif {[lindex $argv $i] eq "--psimd"} {
+        set use_psimd 1
+        puts "Packed SIMD enabled."
+    } elseif {[lindex $argv $i] eq "--vector"} {
+        set use_vector 1
+        puts "Vector unit enabled."
+    } elseif {[lindex $argv $i] eq "--rvc"} {
+        set use_rvc 1
+        puts "Compressed instructions enabled."
+    } elseif {[lindex $argv $i] eq "--clustered"} {
+        set use_clustered 1
+        puts "Clustered data memory enabled."
     } elseif {[lindex $argv $i] eq "--hls"} {
         puts "HLS mode enabled. Adding HLS source files."
         set src_files [concat $src_files [glob -nocomplain $top_dir/cfu/*.v]]
@@ -86,6 +130,30 @@ if {$dmem_size ne ""} {
 if {$stack_size ne ""} {
     lappend defines "STACK_SIZE=$stack_size"
 }
+if {$tcm_size ne ""} {
+    lappend defines "TCM_SIZE=$tcm_size"
+}
+if {$dmem_nbanks ne ""} {
+    lappend defines "DMEM_NBANKS=$dmem_nbanks"
+}
+if {$use_fpu} {
+    lappend defines "USE_FPU"
+}
+if {$use_bitmanip} {
+    lappend defines "USE_BITMANIP"
+}
+if {$use_psimd} {
+    lappend defines "USE_PSIMD"
+}
+if {$use_vector} {
+    lappend defines "USE_VECTOR"
+}
+if {$use_rvc} {
+    lappend defines "USE_RVC"
+}
+if {$use_clustered} {
+    lappend defines "USE_CLUSTERED_DMEM"
+}
 if {[lsearch $defines "USE_HLS"] < 0 && [get_property verilog_define [get_filesets sources_1]] ne ""} {
     foreach d [get_property verilog_define [get_filesets sources_1]] {
         if {[lsearch $defines $d] < 0} {lappend defines $d}
@@ -94,6 +162,11 @@ if {[lsearch $defines "USE_HLS"] < 0 && [get_property verilog_define [get_filese
 set_property verilog_define $defines [get_filesets sources_1]
 
 add_files -force -scan_for_includes $src_files
+# the per-bank data memory images of USE_BANKED_DMEM, read by $readmemh
+set memd_banks [glob -nocomplain $top_dir/memd_bank*.mem]
+if {[llength $memd_banks] > 0} {
+    add_files -force $memd_banks
+}
 add_files -fileset constrs_1 $top_dir/main.xdc
 
 if {[regexp {CRITICAL WARNING:} [check_syntax -return_string -fileset sources_1]]} {
@@ -13,7 +13,6 @@
 #endif
 
 volatile int count = 0;
-volatile spinlock_t lock = 0;
 
 void RandomChar()
 {
@@ -23,7 +22,7 @@ void RandomChar()
         char c = 'A' + rand() % 26;
         char color = rand() & 0x7;
 
-        spinlock_acquire(&lock);
+        pg_hwlock_acquire(0);
 
         count++;
 
@@ -32,7 +31,7 @@ void RandomChar()
         pg_lcd_prints("steps :");
         pg_lcd_printd(count);
 
-        spinlock_release(&lock);
+        pg_hwlock_release(0);
     }
 }
 
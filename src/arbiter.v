@@ -50,6 +50,7 @@ module dual_issue_arbiter #(
 ) (
     input wire    [$clog2(NCORES)-1:0] rr_ptr_i,
     input wire            [NCORES-1:0] req_valid_i,
+    input wire            [NCORES-1:0] req_we_i,  // a store, SC or AMO, also LR
     input wire [NCORES*ADDR_WIDTH-1:0] req_addr_packed_i,
     output reg                         valid_a_o,
     output reg                         valid_b_o,
@@ -93,11 +94,12 @@ module dual_issue_arbiter #(
         end
     end
 
-    // final validation
+    // final validation, the addresses are word indices and two reads of the same word may issue
     always @(*) begin
         valid_a_o = |gnt_onehot_a;
         if (|gnt_onehot_b &&
-            (req_addr[selector_a_o][ADDR_WIDTH-1:2] != req_addr[selector_b_o][ADDR_WIDTH-1:2])
+            ((req_addr[selector_a_o] != req_addr[selector_b_o]) ||
+             (!req_we_i[selector_a_o] && !req_we_i[selector_b_o]))
         ) begin
             valid_b_o = 1'b1;
         end else begin
@@ -0,0 +1,90 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Hardware barrier with NSLOTS barrier slots, mapped at 0x40003000
+//   0x000 + 4*s : arrive at slot s (load). The load stalls until every core in the
+//                 participant mask of slot s has arrived, then all of them are released
+//                 in the same cycle.
+//   0x100 + 4*s : participant mask of slot s (load/store), bit i is core i, all cores by default
+//   0xFFC       : the number of slots (load), zero when the unit is not present
+module barrier_unit #(
+    parameter NCORES = `NCORES,
+    parameter NSLOTS = `HW_BARRIER_SLOTS
+) (
+    input  wire                 clk_i,
+    input  wire [NCORES-1:0]    re_packed_i,
+    input  wire [NCORES-1:0]    we_packed_i,
+    input  wire [10*NCORES-1:0] addr_packed_i,   // word address within the 4 KiB page
+    input  wire [32*NCORES-1:0] wdata_packed_i,
+    output wire [32*NCORES-1:0] rdata_packed_o,
+    output wire [NCORES-1:0]    stall_packed_o
+);
+    localparam SLOTW = (NSLOTS > 1) ? $clog2(NSLOTS) : 1;
+    integer s, j;
+
+    reg [NCORES-1:0] mask_q    [0:NSLOTS-1];
+    reg [NCORES-1:0] arrived_q [0:NSLOTS-1];
+    reg [NCORES-1:0] waiting_q = 0;
+    reg  [SLOTW-1:0] slot_q    [0:NCORES-1];
+    reg       [31:0] rdata_q   [0:NCORES-1];
+
+    initial begin
+        for (s = 0; s < NSLOTS; s = s + 1) begin
+            mask_q[s]    = {NCORES{1'b1}};
+            arrived_q[s] = 0;
+        end
+    end
+
+    // Request decode
+    wire [9:0]       addr      [0:NCORES-1];
+    wire [NCORES-1:0] is_arrive;
+    wire [NCORES-1:0] is_mask;
+    genvar i;
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : gen_decode
+            assign addr[i]      = addr_packed_i[10*i +: 10];
+            assign is_arrive[i] = (addr[i][9:6] == 4'h0) && (addr[i][5:0] < NSLOTS);
+            assign is_mask[i]   = (addr[i][9:6] == 4'h1) && (addr[i][5:0] < NSLOTS);
+
+            assign rdata_packed_o[32*i +: 32] = rdata_q[i];
+            assign stall_packed_o[i]          = waiting_q[i];
+        end
+    endgenerate
+
+    // A slot completes when every participant has arrived, including the arrivals of this cycle
+    reg [NCORES-1:0] arrived_d [0:NSLOTS-1];
+    reg [NSLOTS-1:0] complete;
+    always @(*) begin
+        for (s = 0; s < NSLOTS; s = s + 1) begin
+            arrived_d[s] = arrived_q[s];
+            for (j = 0; j < NCORES; j = j + 1) begin
+                if (re_packed_i[j] && is_arrive[j] && addr[j][SLOTW-1:0] == s) arrived_d[s][j] = 1'b1;
+            end
+            complete[s] = ((arrived_d[s] & mask_q[s]) == mask_q[s]);
+        end
+    end
+
+    always @(posedge clk_i) begin
+        for (s = 0; s < NSLOTS; s = s + 1) begin
+            arrived_q[s] <= complete[s] ? 0 : arrived_d[s];
+        end
+
+        for (j = 0; j < NCORES; j = j + 1) begin
+            if (re_packed_i[j] && is_arrive[j]) begin
+                slot_q[j]    <= addr[j][SLOTW-1:0];
+                waiting_q[j] <= !complete[addr[j][SLOTW-1:0]];
+            end else if (waiting_q[j] && complete[slot_q[j]]) begin
+                waiting_q[j] <= 1'b0;
+            end
+
+            if (we_packed_i[j] && is_mask[j]) mask_q[addr[j][SLOTW-1:0]] <= wdata_packed_i[32*j +: NCORES];
+
+            rdata_q[j] <= (re_packed_i[j] && is_mask[j]) ? mask_q[addr[j][SLOTW-1:0]] :
+                          (re_packed_i[j] && addr[j] == 10'h3ff) ? NSLOTS : 0;
+        end
+    end
+endmodule
+
+`resetall
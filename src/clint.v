@@ -0,0 +1,80 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Core-local interruptor (CLINT), mapped at 0x40007000
+// It has the registers of the standard CLINT, packed into one 4 KiB page of the MMIO space.
+//   0x000 + 4*h : msip of hart h (bit 0), the machine software interrupt (IPI)
+//   0x400 + 8*h : mtimecmp of hart h (low, high), the machine timer interrupt is pending
+//                 while mtime >= mtimecmp
+//   0xFF8       : mtime (low, high), counts up every clock cycle
+module clint #(
+    parameter NCORES = `NCORES
+) (
+    input  wire                 clk_i,
+    input  wire [NCORES-1:0]    re_packed_i,
+    input  wire [NCORES-1:0]    we_packed_i,
+    input  wire [10*NCORES-1:0] addr_packed_i,   // word address within the 4 KiB page
+    input  wire [32*NCORES-1:0] wdata_packed_i,
+    output wire [32*NCORES-1:0] rdata_packed_o,
+    output reg  [NCORES-1:0]    msip_o,
+    output reg  [NCORES-1:0]    mtip_o,
+    output wire [63:0]          mtime_o
+);
+    integer h, j;
+
+    reg [63:0] mtime = 0;
+    reg [63:0] mtimecmp [0:NCORES-1];
+    reg [31:0] rdata_q  [0:NCORES-1];
+
+    initial begin
+        msip_o = 0;
+        mtip_o = 0;
+        for (h = 0; h < NCORES; h = h + 1) mtimecmp[h] = {64{1'b1}};
+    end
+
+    assign mtime_o = mtime;
+
+    // Request decode
+    wire [9:0] addr [0:NCORES-1];
+    genvar i;
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : gen_decode
+            assign addr[i] = addr_packed_i[10*i +: 10];
+            assign rdata_packed_o[32*i +: 32] = rdata_q[i];
+        end
+    endgenerate
+
+    always @(posedge clk_i) begin
+        mtime <= mtime + 1;
+
+        for (j = 0; j < NCORES; j = j + 1) begin
+            if (we_packed_i[j]) begin
+                if (addr[j][9:8] == 2'b00 && addr[j][7:0] < NCORES) begin
+                    msip_o[addr[j][7:0]] <= wdata_packed_i[32*j];
+                end
+                if (addr[j][9:8] == 2'b01 && addr[j][7:1] < NCORES) begin
+                    if (addr[j][0]) mtimecmp[addr[j][7:1]][63:32] <= wdata_packed_i[32*j +: 32];
+                    else            mtimecmp[addr[j][7:1]][31:0]  <= wdata_packed_i[32*j +: 32];
+                end
+                if (addr[j] == 10'h3fe) mtime[31:0]  <= wdata_packed_i[32*j +: 32];
+                if (addr[j] == 10'h3ff) mtime[63:32] <= wdata_packed_i[32*j +: 32];
+            end
+
+            if (re_packed_i[j]) begin
+                rdata_q[j] <= (addr[j][9:8] == 2'b00 && addr[j][7:0] < NCORES) ? msip_o[addr[j][7:0]] :
+                              (addr[j][9:8] == 2'b01 && addr[j][7:1] < NCORES) ?
+                                  (addr[j][0] ? mtimecmp[addr[j][7:1]][63:32] : mtimecmp[addr[j][7:1]][31:0]) :
+                              (addr[j] == 10'h3fe) ? mtime[31:0] :
+                              (addr[j] == 10'h3ff) ? mtime[63:32] : 0;
+            end
+        end
+
+        for (h = 0; h < NCORES; h = h + 1) begin
+            mtip_o[h] <= (mtime >= mtimecmp[h]);
+        end
+    end
+endmodule
+
+`resetall
@@ -0,0 +1,491 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+`default_nettype none
+`include "config.vh"
+
+/******************************************************************************************/
+module fregfile (  ///// floating-point register file with bypassing, f0 is an ordinary register
+    input  wire        clk_i,
+    input  wire [ 4:0] rs1_i,
+    input  wire [ 4:0] rs2_i,
+    input  wire [ 4:0] rs3_i,
+    output wire [31:0] frs1_o,
+    output wire [31:0] frs2_o,
+    output wire [31:0] frs3_o,
+    input  wire        we_i,
+    input  wire [ 4:0] rd_i,
+    input  wire [31:0] wdata_i
+);
+
+    reg [31:0] ram[0:31];
+
+    assign frs1_o = (we_i && rs1_i == rd_i) ? wdata_i : ram[rs1_i];
+    assign frs2_o = (we_i && rs2_i == rd_i) ? wdata_i : ram[rs2_i];
+    assign frs3_o = (we_i && rs3_i == rd_i) ? wdata_i : ram[rs3_i];
+    always @(posedge clk_i) begin
+        if (we_i) begin
+            ram[rd_i] <= wdata_i;
+        end
+    end
+endmodule
+
+/******************************************************************************************/
+module fpu_unpack (
+    input  wire [31:0] x_i,
+    output wire        zero_o,
+    output wire        sub_o,    // subnormal
+    output wire        inf_o,
+    output wire        nan_o,
+    output wire        snan_o,
+    output wire [23:0] m_o,      // significand with the hidden bit
+    output wire [ 7:0] e_o       // biased exponent, 1 for a subnormal
+);
+
+    wire exp_zero  = (x_i[30:23] == 0);
+    wire exp_ones  = (x_i[30:23] == 8'hff);
+    wire frac_zero = (x_i[22:0] == 0);
+
+    assign zero_o = exp_zero && frac_zero;
+    assign sub_o  = exp_zero && !frac_zero;
+    assign inf_o  = exp_ones && frac_zero;
+    assign nan_o  = exp_ones && !frac_zero;
+    assign snan_o = nan_o && !x_i[22];
+    assign m_o    = {!exp_zero, x_i[22:0]};
+    assign e_o    = (exp_zero) ? 8'd1 : x_i[30:23];
+endmodule
+
+`define FPU_QNAN 32'h7fc00000
+`define FPU_RNE 3'd0
+`define FPU_RTZ 3'd1
+`define FPU_RDN 3'd2
+`define FPU_RUP 3'd3
+`define FDIV_IDLE 0
+`define FDIV_NORM 1
+`define FDIV_EXEC 2
+`define FDIV_RET 3
+/******************************************************************************************/
+module fpu (  ///// single-precision FPU (RV32F), pipelined over EX, MA and WB
+    input  wire                       clk_i,
+    input  wire                       rst_i,
+    input  wire                       stall_i,
+    input  wire                       hold_i,      // the instruction in MA is held (ExMa_stall)
+    input  wire                       valid_i,
+    input  wire [`FPU_CTRL_WIDTH-1:0] fpu_ctrl_i,
+    input  wire [               31:0] ir_i,
+    input  wire [                2:0] frm_i,
+    input  wire [               31:0] src1_i,      // x[rs1] of fcvt.s.w[u] and fmv.w.x
+    input  wire [               31:0] fsrc1_i,
+    input  wire [               31:0] fsrc2_i,
+    input  wire [               31:0] fsrc3_i,
+    output wire                       stall_o,
+    output wire [               31:0] rslt_o,      // the result of the instruction in WB
+    output wire [                4:0] fflags_o     // the exception flags of the instruction in WB
+);
+
+    // All the arithmetic is done by one fused multiply-add datapath. EX multiplies the
+    // significands, MA aligns the addend and adds, and WB normalizes and rounds. fadd/fsub
+    // are rs1 * 1.0 +/- rs2, fmul has no addend, and fcvt.s.w[u], fdiv and fsqrt enter MA
+    // as an exact product. fdiv and fsqrt are iterative and hold the pipeline for about
+    // 30 cycles like the integer divider. The other instructions are finished in EX. All
+    // the rounding modes, subnormals and the exception flags of IEEE 754 are supported,
+    // and a NaN result is always the canonical NaN.
+    function round_up;
+        input [2:0] rm;
+        input       s, lsb, g, st;
+        begin
+            case (rm)
+                `FPU_RNE: round_up = g && (st || lsb);
+                `FPU_RTZ: round_up = 0;
+                `FPU_RDN: round_up = s && (g || st);
+                `FPU_RUP: round_up = !s && (g || st);
+                default:  round_up = g;  // RMM
+            endcase
+        end
+    endfunction
+
+    function [5:0] clz52;
+        input [51:0] x;
+        integer b;
+        begin
+            clz52 = 52;
+            for (b = 0; b < 52; b = b + 1) if (x[b]) clz52 = 51 - b;
+        end
+    endfunction
+
+    function [4:0] clz24;
+        input [23:0] x;
+        integer b;
+        begin
+            clz24 = 24;
+            for (b = 0; b < 24; b = b + 1) if (x[b]) clz24 = 23 - b;
+        end
+    endfunction
+
+//------------------------------------------------------------------------------
+// EX: decode, unpack, multiply and the special cases
+//------------------------------------------------------------------------------
+    wire [4:0] op = ir_i[6:2];
+    wire [4:0] f5 = ir_i[31:27];
+    wire [2:0] f3 = ir_i[14:12];
+    wire [2:0] rm = (f3 == 3'b111) ? frm_i : f3;
+
+    wire w_fpu     = fpu_ctrl_i[`FPU_CTRL_IS_FPU];
+    wire is_fma    = (op[4:2] == 3'b100);  // fmadd, fmsub, fnmsub, fnmadd
+    wire is_add    = !is_fma && (f5 == 5'b00000 || f5 == 5'b00001);
+    wire is_mul    = !is_fma && (f5 == 5'b00010);
+    wire is_div    = !is_fma && (f5 == 5'b00011);
+    wire is_sqrt   = !is_fma && (f5 == 5'b01011);
+    wire is_sgnj   = !is_fma && (f5 == 5'b00100);
+    wire is_minmax = !is_fma && (f5 == 5'b00101);
+    wire is_cvt_ws = !is_fma && (f5 == 5'b11000);
+    wire is_cmp    = !is_fma && (f5 == 5'b10100);
+    wire is_cvt_sw = !is_fma && (f5 == 5'b11010);
+    wire is_mv_xw  = !is_fma && (f5 == 5'b11100) && (f3 == 0);
+    wire is_class  = !is_fma && (f5 == 5'b11100) && (f3 == 1);
+    wire is_mv_wx  = !is_fma && (f5 == 5'b11110);
+    wire is_arith  = is_fma || is_add || is_mul || is_cvt_sw;
+
+    wire        a_zero, a_sub, a_inf, a_nan, a_snan;
+    wire        b_zero, b_sub, b_inf, b_nan, b_snan;
+    wire [23:0] a_m, b_m;
+    wire  [7:0] a_e, b_e;
+    fpu_unpack unpack_a (
+        .x_i   (fsrc1_i),
+        .zero_o(a_zero),
+        .sub_o (a_sub),
+        .inf_o (a_inf),
+        .nan_o (a_nan),
+        .snan_o(a_snan),
+        .m_o   (a_m),
+        .e_o   (a_e)
+    );
+    fpu_unpack unpack_b (
+        .x_i   (fsrc2_i),
+        .zero_o(b_zero),
+        .sub_o (b_sub),
+        .inf_o (b_inf),
+        .nan_o (b_nan),
+        .snan_o(b_snan),
+        .m_o   (b_m),
+        .e_o   (b_e)
+    );
+
+    ///// fused multiply-add operands, fadd/fsub multiply rs1 by 1.0
+    wire [31:0] fma_b = (is_add) ? 32'h3f800000 : fsrc2_i;
+    wire [31:0] fma_c = (is_add) ? fsrc2_i : fsrc3_i;
+    wire        p_zero, p_sub, p_inf, p_nan, p_snan;
+    wire        c_zero_t, c_sub, c_inf_t, c_nan_t, c_snan_t;
+    wire [23:0] p_m, c_m_t;
+    wire  [7:0] p_e, c_e_t;
+    fpu_unpack unpack_p (
+        .x_i   (fma_b),
+        .zero_o(p_zero),
+        .sub_o (p_sub),
+        .inf_o (p_inf),
+        .nan_o (p_nan),
+        .snan_o(p_snan),
+        .m_o   (p_m),
+        .e_o   (p_e)
+    );
+    fpu_unpack unpack_c (
+        .x_i   (fma_c),
+        .zero_o(c_zero_t),
+        .sub_o (c_sub),
+        .inf_o (c_inf_t),
+        .nan_o (c_nan_t),
+        .snan_o(c_snan_t),
+        .m_o   (c_m_t),
+        .e_o   (c_e_t)
+    );
+
+    wire        c_zero = is_mul || c_zero_t;  // fmul has no addend
+    wire        c_inf  = !is_mul && c_inf_t;
+    wire        c_nan  = !is_mul && c_nan_t;
+    wire        c_snan = !is_mul && c_snan_t;
+
+    wire        fma_sp = fsrc1_i[31] ^ fma_b[31] ^ (is_fma && op[1]);      // fnmsub, fnmadd
+    wire        fma_sc = (is_mul) ? fma_sp :
+                         fma_c[31] ^ ((is_fma) ? op[0] : f5[0]);          // fmsub, fnmadd, fsub
+    wire        prod_inf  = a_inf || p_inf;
+    wire        prod_zero = a_zero || p_zero;
+    wire        fma_nv    = (a_inf && p_zero) || (a_zero && p_inf) ||
+                            (prod_inf && c_inf && fma_sp != fma_sc && !a_nan && !p_nan);
+    wire        fma_nan   = a_nan || p_nan || c_nan;
+    wire        fma_snan  = a_snan || p_snan || c_snan;
+    wire        fma_zs    = (rm == `FPU_RDN) ? fma_sp | fma_sc : fma_sp & fma_sc;
+
+    ///// fcvt.s.w[u] enters MA as the product {|x|, 16'b0} * 2^(157 - 127 - 46)
+    wire        cvt_s  = !ir_i[20] && src1_i[31];
+    wire [31:0] cvt_mag = (cvt_s) ? ~src1_i + 1 : src1_i;
+
+    wire        ex_arith_special = (is_cvt_sw) ? (cvt_mag == 0) :
+                                   fma_nv || fma_nan || prod_inf || c_inf || prod_zero;
+    wire [47:0] ex_prod = (is_cvt_sw) ? {cvt_mag, 16'd0} : a_m * p_m;
+    wire  [9:0] ex_ep   = (is_cvt_sw) ? 10'd157 : {2'd0, a_e} + {2'd0, p_e} - 10'd127;
+
+    ///// compare, min/max, the numbers are ordered with -0 < +0 for min/max only
+    wire        ab_nan     = a_nan || b_nan;
+    wire        ab_snan    = a_snan || b_snan;
+    wire        mag_lt     = (fsrc1_i[30:0] < fsrc2_i[30:0]);
+    wire        mag_gt     = (fsrc1_i[30:0] > fsrc2_i[30:0]);
+    wire        ab_eq      = (fsrc1_i == fsrc2_i) || (a_zero && b_zero);
+    wire        ab_lt_mm   = (fsrc1_i[31] != fsrc2_i[31]) ? fsrc1_i[31] :
+                             (fsrc1_i[31]) ? mag_gt : mag_lt;
+    wire        ab_lt      = ab_lt_mm && !(a_zero && b_zero);
+    wire        cmp_rslt   = !ab_nan && ((f3 == 2) ? ab_eq : (f3 == 1) ? ab_lt : ab_lt || ab_eq);
+    wire        cmp_nv     = (f3 == 2) ? ab_snan : ab_nan;
+    wire [31:0] minmax_rslt = (a_nan && b_nan) ? `FPU_QNAN : (a_nan) ? fsrc2_i : (b_nan) ? fsrc1_i :
+                              (f3[0] ^ ab_lt_mm) ? fsrc1_i : fsrc2_i;
+
+    wire [31:0] sgnj_rslt  = {(f3 == 0) ? fsrc2_i[31] : (f3 == 1) ? !fsrc2_i[31] :
+                              fsrc1_i[31] ^ fsrc2_i[31], fsrc1_i[30:0]};
+
+    wire  [9:0] class_rslt = {a_nan && !a_snan, a_snan,
+                              !fsrc1_i[31] && a_inf, !fsrc1_i[31] && !a_zero && !a_sub && !a_inf && !a_nan,
+                              !fsrc1_i[31] && a_sub, !fsrc1_i[31] && a_zero,
+                              fsrc1_i[31] && a_zero, fsrc1_i[31] && a_sub,
+                              fsrc1_i[31] && !a_zero && !a_sub && !a_inf && !a_nan, fsrc1_i[31] && a_inf};
+
+    ///// fcvt.w[u].s, the significand is shifted to 32 integer and 32 fraction bits
+    wire        cvt_u     = ir_i[20];
+    wire  [9:0] cvt_exp   = {2'd0, a_e} - 10'd127;
+    wire        cvt_big   = !cvt_exp[9] && (cvt_exp > 31);     // also inf
+    wire        cvt_tiny  = cvt_exp[9] && (cvt_exp != 10'h3ff); // < 0.5
+    wire [63:0] cvt_fix   = {a_m, 40'd0} >> (10'd31 - cvt_exp);
+    wire [31:0] cvt_ip    = (cvt_tiny) ? 0 : cvt_fix[63:32];
+    wire        cvt_g     = !cvt_tiny && cvt_fix[31];
+    wire        cvt_st    = (cvt_tiny) ? !a_zero : |cvt_fix[30:0];
+    wire [32:0] cvt_ipr   = {1'b0, cvt_ip} + round_up(rm, fsrc1_i[31], cvt_ip[0], cvt_g, cvt_st);
+    wire        cvt_ovf   = cvt_big || ((cvt_u) ? ((fsrc1_i[31]) ? cvt_ipr != 0 : cvt_ipr[32]) :
+                                         (fsrc1_i[31]) ? cvt_ipr[32] || (cvt_ipr[31] && cvt_ipr[30:0] != 0) :
+                                                         cvt_ipr[32] || cvt_ipr[31]);
+    wire [31:0] cvt_ws_rslt = (a_nan) ? ((cvt_u) ? 32'hffffffff : 32'h7fffffff) :
+                              (cvt_ovf) ? ((cvt_u) ? ((fsrc1_i[31]) ? 32'h0 : 32'hffffffff) :
+                                                     ((fsrc1_i[31]) ? 32'h80000000 : 32'h7fffffff)) :
+                              (fsrc1_i[31]) ? ~cvt_ipr[31:0] + 1 : cvt_ipr[31:0];
+    wire  [4:0] cvt_ws_flags = (a_nan || cvt_ovf) ? 5'b10000 : {4'd0, cvt_g || cvt_st};
+
+    ///// the results finished in EX, {NV, DZ, OF, UF, NX}
+    reg  [31:0] ex_final;
+    reg   [4:0] ex_flags;
+    always @(*) begin
+        ex_final = 0;
+        ex_flags = 0;
+        if (is_arith) begin
+            if (is_cvt_sw)             begin ex_final = 0; end
+            else if (fma_nv)           begin ex_final = `FPU_QNAN; ex_flags = 5'b10000; end
+            else if (fma_nan)          begin ex_final = `FPU_QNAN; ex_flags = {fma_snan, 4'd0}; end
+            else if (prod_inf)         ex_final = {fma_sp, 31'h7f800000};
+            else if (c_inf)            ex_final = {fma_sc, 31'h7f800000};
+            else if (prod_zero && c_zero) ex_final = {fma_zs, 31'd0};
+            else                       ex_final = {fma_sc, fma_c[30:0]};  // 0 * b + c
+        end else if (is_div) begin
+            if (ab_nan)                begin ex_final = `FPU_QNAN; ex_flags = {ab_snan, 4'd0}; end
+            else if ((a_inf && b_inf) || (a_zero && b_zero))
+                                       begin ex_final = `FPU_QNAN; ex_flags = 5'b10000; end
+            else if (a_inf)            ex_final = {fsrc1_i[31] ^ fsrc2_i[31], 31'h7f800000};
+            else if (b_zero)           begin ex_final = {fsrc1_i[31] ^ fsrc2_i[31], 31'h7f800000}; ex_flags = 5'b01000; end
+            else                       ex_final = {fsrc1_i[31] ^ fsrc2_i[31], 31'd0};  // 0 / b, a / inf
+        end else if (is_sqrt) begin
+            if (a_nan)                 begin ex_final = `FPU_QNAN; ex_flags = {a_snan, 4'd0}; end
+            else if (a_zero)           ex_final = fsrc1_i;
+            else if (fsrc1_i[31])      begin ex_final = `FPU_QNAN; ex_flags = 5'b10000; end
+            else                       ex_final = fsrc1_i;  // +inf
+        end else if (is_sgnj)          ex_final = sgnj_rslt;
+        else if (is_minmax)            begin ex_final = minmax_rslt; ex_flags = {ab_snan, 4'd0}; end
+        else if (is_cmp)               begin ex_final = {31'd0, cmp_rslt}; ex_flags = {cmp_nv, 4'd0}; end
+        else if (is_class)             ex_final = {22'd0, class_rslt};
+        else if (is_mv_xw)             ex_final = fsrc1_i;
+        else if (is_mv_wx)             ex_final = src1_i;
+        else if (is_cvt_ws)            begin ex_final = cvt_ws_rslt; ex_flags = cvt_ws_flags; end
+    end
+
+    ///// iterative divider and square root, one quotient (root) bit per cycle
+    wire        ds_special = (is_div) ? ab_nan || a_inf || a_zero || b_inf || b_zero :
+                             a_nan || a_zero || a_inf || fsrc1_i[31];
+    reg   [1:0] ds_state = `FDIV_IDLE;
+    reg         ds_sqrt;
+    reg         ds_sign;
+    reg  [23:0] ds_ma;
+    reg  [23:0] ds_mb;
+    reg   [9:0] ds_ea;
+    reg   [9:0] ds_eb;
+    reg   [9:0] ds_ep;
+    reg  [27:0] ds_rem;
+    reg  [51:0] ds_rad;   // the radicand of fsqrt, two bits are consumed per step
+    reg  [26:0] ds_q;     // the quotient of fdiv or the root of fsqrt
+    reg   [4:0] ds_cntr;
+
+    wire  [4:0] ds_lza = clz24(ds_ma);
+    wire  [4:0] ds_lzb = clz24(ds_mb);
+    wire [23:0] ds_ma_n = ds_ma << ds_lza;
+    wire  [9:0] ds_ea_n = ds_ea - ds_lza;
+    wire  [9:0] ds_eb_n = ds_eb - ds_lzb;
+    wire  [9:0] ds_sq_ep = ds_ea_n + 10'd125;
+
+    wire [28:0] ds_div_diff = {1'b0, ds_rem} - {5'd0, ds_mb};
+    wire [29:0] ds_sq_r4    = {ds_rem, ds_rad[51:50]};
+    wire [30:0] ds_sq_diff  = {1'b0, ds_sq_r4} - {2'd0, ds_q, 2'b01};
+    wire        ds_bit      = (ds_sqrt) ? !ds_sq_diff[30] : !ds_div_diff[28];
+
+    wire        ds_init = (ds_state == `FDIV_IDLE) && valid_i && w_fpu && (is_div || is_sqrt) && !ds_special;
+    wire  [1:0] ds_w_state = (ds_init) ? `FDIV_NORM :
+                             (ds_state == `FDIV_NORM) ? `FDIV_EXEC :
+                             (ds_state == `FDIV_EXEC && ds_cntr != 0) ? `FDIV_EXEC :
+                             (ds_state == `FDIV_EXEC) ? `FDIV_RET : `FDIV_IDLE;
+    assign stall_o = (ds_w_state != `FDIV_IDLE);
+
+    always @(posedge clk_i) if (!stall_i) begin
+        if (rst_i) begin
+            ds_state <= `FDIV_IDLE;
+        end else begin
+            ds_state <= ds_w_state;
+            if (ds_init) begin
+                ds_sqrt <= is_sqrt;
+                ds_sign <= is_div && (fsrc1_i[31] ^ fsrc2_i[31]);
+                ds_ma   <= a_m;
+                ds_ea   <= {2'd0, a_e};
+                ds_mb   <= b_m;
+                ds_eb   <= {2'd0, b_e};
+            end
+            if (ds_state == `FDIV_NORM) begin  // normalize the subnormal operands
+                ds_q    <= 0;
+                ds_rem  <= (ds_sqrt) ? 0 : {4'd0, ds_ma_n};
+                ds_mb   <= ds_mb << ds_lzb;
+                ds_rad  <= (ds_ea_n[0]) ? {1'b0, ds_ma_n, 27'd0} : {ds_ma_n, 28'd0};
+                ds_ep   <= (ds_sqrt) ? {ds_sq_ep[9], ds_sq_ep[9:1]} : ds_ea_n - ds_eb_n + 10'd126;
+                ds_cntr <= (ds_sqrt) ? 25 : 26;
+            end
+            if (ds_state == `FDIV_EXEC) begin
+                ds_q    <= {ds_q[25:0], ds_bit};
+                ds_rem  <= (ds_sqrt) ? ((ds_bit) ? ds_sq_diff[27:0] : ds_sq_r4[27:0]) :
+                           ((ds_bit) ? {ds_div_diff[26:0], 1'b0} : {ds_rem[26:0], 1'b0});
+                ds_rad  <= {ds_rad[49:0], 2'b00};
+                ds_cntr <= ds_cntr - 1;
+            end
+        end
+    end
+
+//------------------------------------------------------------------------------
+// MA: align the addend and add
+//------------------------------------------------------------------------------
+    reg         ma_v = 0;
+    reg         ma_arith;
+    reg   [2:0] ma_rm;
+    reg         ma_sp;
+    reg         ma_sc;
+    reg  [47:0] ma_prod;
+    reg   [9:0] ma_ep;
+    reg  [23:0] ma_mc;
+    reg   [7:0] ma_ec;
+    reg  [31:0] ma_final;
+    reg   [4:0] ma_flags;
+
+    always @(posedge clk_i) if (!stall_i) begin
+        if (rst_i) begin
+            ma_v <= 0;
+        end else if (!hold_i) begin
+            ma_v     <= valid_i && w_fpu;
+            ma_arith <= (is_arith && !ex_arith_special) || ((is_div || is_sqrt) && !ds_special);
+            ma_rm    <= rm;
+            ma_sp    <= (is_cvt_sw) ? cvt_s : fma_sp;
+            ma_sc    <= (is_cvt_sw) ? cvt_s : fma_sc;
+            ma_prod  <= ex_prod;
+            ma_ep    <= ex_ep;
+            ma_mc    <= (is_cvt_sw || is_mul) ? 24'd0 : c_m_t;
+            ma_ec    <= (is_cvt_sw || is_mul) ? 8'd1 : c_e_t;
+            ma_final <= ex_final;
+            ma_flags <= ex_flags;
+        end else if (ds_state == `FDIV_RET) begin  // the fdiv/fsqrt in MA gets its result
+            ma_sp    <= ds_sign;
+            ma_sc    <= ds_sign;
+            ma_prod  <= (ds_sqrt) ? {ds_q[25:0], ds_rem != 0, 21'd0} : {ds_q, ds_rem != 0, 20'd0};
+            ma_ep    <= ds_ep;
+            ma_mc    <= 0;
+            ma_ec    <= 1;
+        end
+    end
+
+    // The operands are 51-bit with three guard bits, the shifted-out bits are kept as a sticky bit
+    wire  [9:0] ma_d      = ma_ep - {2'd0, ma_ec};
+    wire        ma_p_big  = !ma_d[9];
+    wire  [9:0] ma_dabs   = (ma_p_big) ? ma_d : -ma_d;
+    wire  [5:0] ma_sh     = (ma_dabs > 51) ? 51 : ma_dabs[5:0];
+    wire [50:0] ma_pg     = {ma_prod, 3'd0};
+    wire [50:0] ma_cg     = {1'b0, ma_mc, 26'd0};
+    wire [101:0] ma_align = {((ma_p_big) ? ma_cg : ma_pg), 51'd0} >> ma_sh;
+    wire [50:0] ma_small  = ma_align[101:51] | {50'd0, |ma_align[50:0]};
+    wire [50:0] ma_pa     = (ma_p_big) ? ma_pg : ma_small;
+    wire [50:0] ma_ca     = (ma_p_big) ? ma_small : ma_cg;
+    wire  [9:0] ma_e      = (ma_p_big) ? ma_ep : {2'd0, ma_ec};
+    wire        ma_p_ge   = (ma_pa >= ma_ca);
+    wire [51:0] ma_sum    = (ma_sp == ma_sc) ? {1'b0, ma_pa} + {1'b0, ma_ca} :
+                            (ma_p_ge) ? {1'b0, ma_pa - ma_ca} : {1'b0, ma_ca - ma_pa};
+    wire        ma_s      = (ma_sp == ma_sc || ma_p_ge) ? ma_sp : ma_sc;
+
+//------------------------------------------------------------------------------
+// WB: normalize and round
+//------------------------------------------------------------------------------
+    reg         wb_v = 0;
+    reg         wb_arith;
+    reg   [2:0] wb_rm;
+    reg         wb_s;
+    reg   [9:0] wb_e;
+    reg  [51:0] wb_sum;
+    reg  [31:0] wb_final;
+    reg   [4:0] wb_flags;
+
+    always @(posedge clk_i) if (!stall_i) begin
+        if (rst_i) begin
+            wb_v <= 0;
+        end else if (!hold_i) begin
+            wb_v     <= ma_v;
+            wb_arith <= ma_arith;
+            wb_rm    <= ma_rm;
+            wb_s     <= ma_s;
+            wb_e     <= ma_e;
+            wb_sum   <= ma_sum;
+            wb_final <= ma_final;
+            wb_flags <= ma_flags;
+        end
+    end
+
+    wire  [5:0] wb_lz   = clz52(wb_sum);
+    wire [51:0] wb_n    = wb_sum << wb_lz;
+    wire  [9:0] wb_x    = wb_e + 10'd2 - {4'd0, wb_lz};  // the biased exponent of wb_n
+    wire        wb_zero = (wb_sum == 0);                  // exact cancellation
+
+    // tininess is detected after rounding, as if the exponent range were unbounded
+    wire        wb_carry_u = round_up(wb_rm, wb_s, wb_n[28], wb_n[27], |wb_n[26:0]) && (&wb_n[51:28]);
+    wire        wb_tiny    = wb_x[9] || (wb_x == 0 && !wb_carry_u);
+
+    // a subnormal result is shifted right to the exponent 1
+    wire        wb_denorm = wb_x[9] || (wb_x == 0);
+    wire  [9:0] wb_dsh_t  = 10'd1 - wb_x;
+    wire  [5:0] wb_dsh    = (!wb_denorm) ? 0 : (wb_dsh_t > 52) ? 52 : wb_dsh_t[5:0];
+    wire [103:0] wb_dn    = {wb_n, 52'd0} >> wb_dsh;
+    wire [51:0] wb_nd     = wb_dn[103:52] | {51'd0, |wb_dn[51:0]};
+    wire  [9:0] wb_xd     = (wb_denorm) ? 10'd1 : wb_x;
+
+    wire        wb_g      = wb_nd[27];
+    wire        wb_st     = |wb_nd[26:0];
+    wire [24:0] wb_mr     = {1'b0, wb_nd[51:28]} + round_up(wb_rm, wb_s, wb_nd[28], wb_g, wb_st);
+    wire  [9:0] wb_xr     = wb_xd + {9'd0, wb_mr[24]};
+    wire [22:0] wb_frac   = (wb_mr[24]) ? 23'd0 : wb_mr[22:0];
+    wire  [7:0] wb_ef     = (wb_mr[24] || wb_mr[23]) ? wb_xr[7:0] : 8'd0;
+    wire        wb_inexact = wb_g || wb_st;
+    wire        wb_ovf    = !wb_xr[9] && (wb_xr >= 255);
+    wire        wb_maxf   = (wb_rm == `FPU_RTZ) || (wb_rm == `FPU_RDN && !wb_s) || (wb_rm == `FPU_RUP && wb_s);
+
+    wire [31:0] wb_rounded = (wb_zero) ? {wb_rm == `FPU_RDN, 31'd0} :
+                             (wb_ovf) ? ((wb_maxf) ? {wb_s, 31'h7f7fffff} : {wb_s, 31'h7f800000}) :
+                             {wb_s, wb_ef, wb_frac};
+    wire  [4:0] wb_rflags  = (wb_zero) ? 5'd0 : (wb_ovf) ? 5'b00101 :
+                             {3'd0, wb_inexact && wb_tiny, wb_inexact};
+
+    assign rslt_o   = (!wb_v) ? 0 : (wb_arith) ? wb_rounded : wb_final;
+    assign fflags_o = (!wb_v) ? 0 : (wb_arith) ? wb_rflags : wb_flags;
+endmodule
+
+`resetall
@@ -19,8 +19,17 @@ module cpu (
     output wire [`DBUS_STRB_WIDTH-1:0] dbus_wstrb_o,
     output wire                        dbus_is_lr_o,
     output wire                        dbus_is_sc_o,
+    output wire                        dbus_is_amo_o,
+    output wire [   `AMO_OP_WIDTH-1:0] dbus_amo_op_o,
+    output wire                        dbus_is_fence_o,
     input  wire [`DBUS_DATA_WIDTH-1:0] dbus_rdata_i,
-    input  wire                        hart_index
+    input  wire                        irq_soft_i,   // machine software interrupt (msip)
+    input  wire                        irq_timer_i,  // machine timer interrupt (mtip)
+    input  wire [                63:0] mtime_i,      // mtime of the CLINT
+    input  wire                        pmu_run_i,    // the counters of all the cores are running
+    input  wire [                 3:0] pmu_dbus_ev_i, // {arb loss, mmio, vmem, dmem} stall of the data bus
+    input  wire                        rsv_valid_i,  // the LR/SC reservation of this core is valid
+    input  wire [                31:0] hart_index
 );
     wire w_stall = stall_i;
 
@@ -34,6 +43,7 @@ module cpu (
     reg                       IfId_v;
     reg [          `XLEN-1:0] IfId_pc;
     reg [               31:0] IfId_ir;
+    reg                       IfId_rvc;  // IfId_ir is expanded from a 16-bit instruction
     reg                       IfId_br_pred_tkn;
     reg [                1:0] IfId_pat_hist;
     reg                       IfId_load_muldiv_use;
@@ -47,6 +57,7 @@ module cpu (
     reg                       IdEx_v;
     reg [          `XLEN-1:0] IdEx_pc;
     reg [               31:0] IdEx_ir;
+    reg                       IdEx_rvc;
     reg                       IdEx_br_pred_tkn;
     reg [                1:0] IdEx_pat_hist;
     reg [`ALU_CTRL_WIDTH-1:0] IdEx_alu_ctrl;
@@ -55,6 +66,13 @@ module cpu (
     reg [`MUL_CTRL_WIDTH-1:0] IdEx_mul_ctrl;
     reg [`DIV_CTRL_WIDTH-1:0] IdEx_div_ctrl;
     reg [`CFU_CTRL_WIDTH-1:0] IdEx_cfu_ctrl;
+    reg [`PSIMD_CTRL_WIDTH-1:0] IdEx_psimd_ctrl;
+    reg [`VEC_CTRL_WIDTH-1:0] IdEx_vec_ctrl;
+    reg [`SYS_CTRL_WIDTH-1:0] IdEx_sys_ctrl;
+    reg [`FPU_CTRL_WIDTH-1:0] IdEx_fpu_ctrl;
+    reg [          `XLEN-1:0] IdEx_fsrc1;
+    reg [          `XLEN-1:0] IdEx_fsrc2;
+    reg [          `XLEN-1:0] IdEx_fsrc3;
     reg                       IdEx_rs1_fwd_Ma_to_Ex;
     reg                       IdEx_rs2_fwd_Ma_to_Ex;
     reg [          `XLEN-1:0] IdEx_src1;
@@ -68,6 +86,7 @@ module cpu (
     reg                       ExMa_v;
     reg [          `XLEN-1:0] ExMa_pc;
     reg [               31:0] ExMa_ir;
+    reg                       ExMa_rvc;
     reg [                1:0] ExMa_pat_hist;
     reg                       ExMa_is_ctrl_tsfr;
     reg                       ExMa_br_tkn;
@@ -81,15 +100,20 @@ module cpu (
     reg [          `XLEN-1:0] ExMa_rslt;
     reg [               31:0] ExMa_mdc_rslt;  // mul_div_cfu_rslt
     reg                       ExMa_j_b_insn;  // jump or branch insn
-    reg                       ExMa_mul_stall;
+    reg                       ExMa_is_mul;
+    reg                       ExMa_is_fpu;
+    reg                       ExMa_frf_we;
     reg                       ExMa_div_stall;
     reg                       ExMa_stall;
+    reg [`SYS_CTRL_WIDTH-1:0] ExMa_sys_ctrl;
+    reg [          `XLEN-1:0] ExMa_csr_src;
 
     // WB: Write Back
     reg                       MaWb_v;
     reg [          `XLEN-1:0] MaWb_pc;
     reg [               31:0] MaWb_ir;
     reg                       MaWb_rf_we;
+    reg                       MaWb_frf_we;
     reg [                4:0] MaWb_rd;
     reg [          `XLEN-1:0] MaWb_rslt;
 
@@ -99,15 +123,52 @@ module cpu (
     reg                       rst;
     always @(posedge clk_i) if (!w_stall) rst <= rst_i;
 
+    // A trap, an interrupt or mret in MA redirects the pipeline like a branch misprediction
+    wire        Ma_trap;
+    wire [31:0] Ma_trap_pc;
+    wire [31:0] Ma_npc = (ExMa_br_tkn) ? ExMa_br_tkn_pc : ExMa_pc+((ExMa_rvc) ? 2 : 4);
+
     wire Ma_br_tkn = (ExMa_v && ExMa_br_tkn);
-    wire        Ma_br_misp     = (rst) ? 1 :
-                                 (ExMa_v && ExMa_is_ctrl_tsfr &&
+    wire        Ma_ctrl_misp   = (ExMa_v && ExMa_is_ctrl_tsfr &&
                                  ((Ma_br_tkn) ? ExMa_br_misp_rslt1 : ExMa_br_misp_rslt2));
+    wire        Ma_br_misp     = (rst) ? 1 : (Ma_trap) ? 1 : Ma_ctrl_misp;
     wire [31:0] Ma_br_true_pc  = (rst) ?`RESET_VECTOR :
-                                 (ExMa_br_tkn) ? ExMa_br_tkn_pc : ExMa_pc+4;
-
-    wire If_v = (Ma_br_misp) ? 0 : (IfId_load_muldiv_use) ? IfId_v : 1;
-    wire Id_v = (Ma_br_misp || IfId_load_muldiv_use) ? 0 : IfId_v;
+                                 (Ma_trap) ? Ma_trap_pc : Ma_npc;
+
+    // The multiplier result is written back in WB, so the instruction in ID waits while a
+    // multiply in EX or MA writes one of its source registers (a two-entry result scoreboard).
+    wire Id_mul_busy = IfId_v &&
+                       ((IdEx_v && IdEx_mul_ctrl[`MUL_CTRL_IS_MUL] && IdEx_rf_we &&
+                         (IdEx_rd == IfId_rs1 || IdEx_rd == IfId_rs2)) ||
+                        (ExMa_v && ExMa_is_mul && ExMa_rf_we &&
+                         (ExMa_rd == IfId_rs1 || ExMa_rd == IfId_rs2)));
+
+    // The FPU results are written back in WB as well. The instruction in ID waits while an
+    // FPU operation in EX or MA writes one of its sources, or while an flw in EX writes one of
+    // its FP sources (an flw in MA is forwarded). An FPU operation also waits while a CSR
+    // access, which may change frm, is in EX or MA.
+    wire [4:0] IfId_rs3 = IfId_ir[31:27];
+    wire Id_frs_IdEx = (Id_fpu_ctrl[`FPU_CTRL_IS_FRS1] && IdEx_rd == IfId_rs1) ||
+                       (Id_fpu_ctrl[`FPU_CTRL_IS_FRS2] && IdEx_rd == IfId_rs2) ||
+                       (Id_fpu_ctrl[`FPU_CTRL_IS_FRS3] && IdEx_rd == IfId_rs3);
+    wire Id_frs_ExMa = (Id_fpu_ctrl[`FPU_CTRL_IS_FRS1] && ExMa_rd == IfId_rs1) ||
+                       (Id_fpu_ctrl[`FPU_CTRL_IS_FRS2] && ExMa_rd == IfId_rs2) ||
+                       (Id_fpu_ctrl[`FPU_CTRL_IS_FRS3] && ExMa_rd == IfId_rs3);
+    wire Id_fpu_busy = IfId_v &&
+                       ((IdEx_v && IdEx_fpu_ctrl[`FPU_CTRL_IS_FRD] && Id_frs_IdEx) ||
+                        (ExMa_v && ExMa_is_fpu && ExMa_frf_we && Id_frs_ExMa) ||
+                        (IdEx_v && IdEx_fpu_ctrl[`FPU_CTRL_IS_FPU] && IdEx_rf_we &&
+                         (IdEx_rd == IfId_rs1 || IdEx_rd == IfId_rs2)) ||
+                        (ExMa_v && ExMa_is_fpu && ExMa_rf_we &&
+                         (ExMa_rd == IfId_rs1 || ExMa_rd == IfId_rs2)) ||
+                        (Id_fpu_ctrl[`FPU_CTRL_IS_FPU] &&
+                         ((IdEx_v && IdEx_sys_ctrl[`SYS_CTRL_IS_CSR]) ||
+                          (ExMa_v && ExMa_sys_ctrl[`SYS_CTRL_IS_CSR]))));
+    wire Id_hold = IfId_load_muldiv_use || Id_mul_busy || Id_fpu_busy;
+
+    wire If_ready;  // the whole instruction at r_pc is in IF, see USE_RVC
+    wire If_v = (Ma_br_misp) ? 0 : (Id_hold) ? IfId_v : If_ready;
+    wire Id_v = (Ma_br_misp || Id_hold) ? 0 : IfId_v;
     wire Ex_v = (Ma_br_misp) ? 0 : IdEx_v;
     wire Ma_v = ExMa_v;
     wire stall = ExMa_stall;
@@ -127,9 +188,47 @@ module cpu (
     wire [4:0] If_rs1;
     wire [4:0] If_rs2;
     wire [31:0] If_ir;  // instruction from imem
+    wire If_rvc;  // If_ir is expanded from a 16-bit instruction
+
+`ifdef USE_RVC
+    // The imem returns the aligned word requested in the previous cycle. An instruction at
+    // pc[1] = 1 starts in the upper half of its word, which is kept in r_hbuf while the next
+    // word is fetched, so a 32-bit instruction across two words takes a bubble only when it
+    // is the target of a jump or a misprediction.
+    reg  [`PC_W-1:0] r_faddr = 0;  // the address of the word in ibus_rdata_i
+    reg       [15:0] r_hbuf  = 0;  // the upper half of the word of r_pc
+    reg              r_ahead = 0;  // r_pc[1] = 1 and ibus_rdata_i is the word after r_pc
+    wire      [15:0] If_lo = (!r_pc[1]) ? ibus_rdata_i[15:0] :
+                             (r_ahead) ? r_hbuf : ibus_rdata_i[31:16];
+    wire      [15:0] If_hi = (!r_pc[1]) ? ibus_rdata_i[31:16] : ibus_rdata_i[15:0];
+    wire      [31:0] If_ir_c;
+    assign If_rvc   = (If_lo[1:0] != 2'b11);
+    assign If_ready = !r_pc[1] || r_ahead || If_rvc;
+
+    rvc_expander rvc_expander (
+        .ir_i(If_lo),    // input  wire [15:0]
+        .ir_o(If_ir_c)   // output reg  [31:0]
+    );
+    assign If_ir = (If_rvc) ? If_ir_c : {If_hi, If_lo};
+
+    // the word after the one in ibus_rdata_i or r_hbuf is fetched when If_pc[1] = 1
+    wire [`PC_W-1:0] If_pc_w  = {If_pc[`PC_W-1:2], 2'b00};
+    wire             If_keep  = If_pc[1] && r_ahead && (If_pc_w == {r_pc[`PC_W-1:2], 2'b00});
+    wire             If_next  = If_pc[1] && (If_pc_w == r_faddr);
+    wire [`PC_W-1:0] If_faddr = (w_stall || If_keep) ? r_faddr : (If_next) ? r_faddr+4 : If_pc_w;
+    assign ibus_araddr_o = If_faddr;  // read address of imem
 
+    always @(posedge clk_i) if (!w_stall) begin
+        r_faddr <= If_faddr;
+        r_ahead <= If_keep || If_next;
+        if (If_next) r_hbuf <= ibus_rdata_i[31:16];
+    end
+`else
     assign ibus_araddr_o = If_pc;  // read address of imem
-    assign If_ir = ibus_rdata_i;  // instruction from imem
+    assign If_ir    = ibus_rdata_i;  // instruction from imem
+    assign If_rvc   = 0;
+    assign If_ready = 1;
+`endif
 
     bimodal bimodal (
         .clk_i        (clk_i),           // input  wire
@@ -146,11 +245,11 @@ module cpu (
         .br_tkn_pc_i  (ExMa_br_tkn_pc)   // input  wire [`XLEN-1:0]
     );
 
-    assign If_pc_stall = ExMa_stall || IfId_load_muldiv_use;
-    assign If_pc_inc = (If_pc_stall) ? 0 : 4;
+    assign If_pc_stall = ExMa_stall || Id_hold;
+    assign If_pc_inc = (If_pc_stall || !If_ready) ? 0 : (If_rvc) ? 2 : 4;
     assign If_pc = (w_stall) ? r_pc :
-                   (Ma_br_misp                   ) ? Ma_br_true_pc :
-                   (!If_pc_stall & If_br_pred_tkn) ? If_br_pred_pc : r_pc+If_pc_inc;
+                   (Ma_br_misp                              ) ? Ma_br_true_pc :
+                   (!If_pc_stall & If_ready & If_br_pred_tkn) ? If_br_pred_pc : r_pc+If_pc_inc;
 
     pre_decoder pre_decoder (
         .ir_i        (If_ir),          // input  wire         [31:0]
@@ -161,12 +260,12 @@ module cpu (
         .rs2_o       (If_rs2)          // output wire          [4:0]
     );
 
-    wire If_load_muldiv_use = IfId_v && !Ma_br_misp && !IfId_load_muldiv_use
+    wire If_load_muldiv_use = IfId_v && !Ma_br_misp && !Id_hold
                               && (Id_lsu_ctrl[`LSU_CTRL_IS_LOAD] ||
-                                  Id_mul_ctrl[`MUL_CTRL_IS_MUL] ||
                                   Id_div_ctrl[`DIV_CTRL_IS_DIV] ||
                                   Id_cfu_ctrl[`CFU_CTRL_IS_CFU] ||
-                                  Id_lsu_ctrl[`LSU_CTRL_IS_SC]  )
+                                  Id_lsu_ctrl[`LSU_CTRL_IS_SC]  ||
+                                  Id_sys_ctrl[`SYS_CTRL_IS_CSR] )
                               && IfId_rf_we && ((IfId_rd==If_rs1) || (IfId_rd==If_rs2));
 
     always @(posedge clk_i) if (!w_stall) begin
@@ -178,9 +277,10 @@ module cpu (
         end else if (!ExMa_stall) begin
             IfId_v               <= If_v;
             IfId_load_muldiv_use <= If_load_muldiv_use;
-            if (!IfId_load_muldiv_use) begin
+            if (!Id_hold) begin
                 IfId_pc          <= r_pc;
                 IfId_ir          <= If_ir;
+                IfId_rvc         <= If_rvc;
                 IfId_br_pred_tkn <= If_br_pred_tkn;
                 IfId_pat_hist    <= If_pat_hist;
                 IfId_instr_type  <= If_instr_type;
@@ -203,6 +303,10 @@ module cpu (
     wire [ `MUL_CTRL_WIDTH-1:0] Id_mul_ctrl;
     wire [ `DIV_CTRL_WIDTH-1:0] Id_div_ctrl;
     wire [ `CFU_CTRL_WIDTH-1:0] Id_cfu_ctrl;
+    wire [ `SYS_CTRL_WIDTH-1:0] Id_sys_ctrl;
+    wire [ `FPU_CTRL_WIDTH-1:0] Id_fpu_ctrl;
+    wire [`PSIMD_CTRL_WIDTH-1:0] Id_psimd_ctrl;
+    wire [ `VEC_CTRL_WIDTH-1:0] Id_vec_ctrl;
     decoder decoder (
         .ir_i       (IfId_ir),       // input  wire                 [31:0]
         .src2_ctrl_o(Id_src2_ctrl),  // output wire [`SRC2_CTRL_WIDTH-1:0]
@@ -211,7 +315,11 @@ module cpu (
         .lsu_ctrl_o (Id_lsu_ctrl),   // output wire  [`LSU_CTRL_WIDTH-1:0]
         .mul_ctrl_o (Id_mul_ctrl),   // output wire  [`MUL_CTRL_WIDTH-1:0]
         .div_ctrl_o (Id_div_ctrl),   // output wire  [`DIV_CTRL_WIDTH-1:0]
-        .cfu_ctrl_o (Id_cfu_ctrl)    // output wire  [`CFU_CTRL_WIDTH-1:0]
+        .cfu_ctrl_o (Id_cfu_ctrl),   // output wire  [`CFU_CTRL_WIDTH-1:0]
+        .sys_ctrl_o (Id_sys_ctrl),   // output wire  [`SYS_CTRL_WIDTH-1:0]
+        .fpu_ctrl_o (Id_fpu_ctrl),   // output wire  [`FPU_CTRL_WIDTH-1:0]
+        .psimd_ctrl_o(Id_psimd_ctrl),// output wire [`PSIMD_CTRL_WIDTH-1:0]
+        .vec_ctrl_o (Id_vec_ctrl)    // output wire  [`VEC_CTRL_WIDTH-1:0]
     );
 
     // immediate value generator
@@ -226,6 +334,9 @@ module cpu (
     wire [`XLEN-1:0] Id_xrs1;
     wire [`XLEN-1:0] Id_xrs2;
     wire             Wb_xreg_we = MaWb_v && MaWb_rf_we && !ExMa_stall;
+    wire [`XLEN-1:0] Wb_mul_rslt;
+    wire [`XLEN-1:0] Wb_fpu_rslt;
+    wire [`XLEN-1:0] Wb_rslt = MaWb_rslt | Wb_mul_rslt | Wb_fpu_rslt;
     regfile xreg (
         .clk_i  (clk_i),       // input  wire
         .rs1_i  (IfId_rs1),    // input  wire       [4:0]
@@ -234,9 +345,32 @@ module cpu (
         .xrs2_o (Id_xrs2),     // output wire [`XLEN-1:0]
         .we_i   (Wb_xreg_we && !w_stall),  // input  wire
         .rd_i   (MaWb_rd),     // input  wire       [4:0]
-        .wdata_i(MaWb_rslt)    // input  wire [`XLEN-1:0]
+        .wdata_i(Wb_rslt)      // input  wire [`XLEN-1:0]
+    );
+
+    // floating-point register file, an flw in MA is forwarded
+    wire [`XLEN-1:0] Id_frs1;
+    wire [`XLEN-1:0] Id_frs2;
+    wire [`XLEN-1:0] Id_frs3;
+    wire             Wb_freg_we = MaWb_v && MaWb_frf_we && !ExMa_stall;
+    fregfile freg (
+        .clk_i  (clk_i),       // input  wire
+        .rs1_i  (IfId_rs1),    // input  wire       [4:0]
+        .rs2_i  (IfId_rs2),    // input  wire       [4:0]
+        .rs3_i  (IfId_rs3),    // input  wire       [4:0]
+        .frs1_o (Id_frs1),     // output wire [`XLEN-1:0]
+        .frs2_o (Id_frs2),     // output wire [`XLEN-1:0]
+        .frs3_o (Id_frs3),     // output wire [`XLEN-1:0]
+        .we_i   (Wb_freg_we && !w_stall),  // input  wire
+        .rd_i   (MaWb_rd),     // input  wire       [4:0]
+        .wdata_i(Wb_rslt)      // input  wire [`XLEN-1:0]
     );
 
+    wire Id_flw_in_Ma = ExMa_v && ExMa_frf_we && !ExMa_is_fpu;
+    wire [`XLEN-1:0] Id_fsrc1 = (Id_flw_in_Ma && ExMa_rd == IfId_rs1) ? Ma_rslt : Id_frs1;
+    wire [`XLEN-1:0] Id_fsrc2 = (Id_flw_in_Ma && ExMa_rd == IfId_rs2) ? Ma_rslt : Id_frs2;
+    wire [`XLEN-1:0] Id_fsrc3 = (Id_flw_in_Ma && ExMa_rd == IfId_rs3) ? Ma_rslt : Id_frs3;
+
     // data forwarding
     wire Id_rs1_fwd_Ma_to_Ex = IdEx_v && IdEx_rf_we && (IdEx_rd == IfId_rs1);
     wire Id_rs2_fwd_Ma_to_Ex = IdEx_v && IdEx_rf_we && (IdEx_rd == IfId_rs2);
@@ -251,7 +385,7 @@ module cpu (
     wire [`XLEN-1:0] Id_src2 = (Id_rs2_fwd_Wb_to_Ex) ? Ma_rslt :
                                (Id_use_imm) ? Id_pc_in+Id_imm  : Id_xrs2 ;
 
-    wire [31:0] Id_j_pc4 = (Id_bru_ctrl[`BRU_CTRL_IS_JAL_JALR]) ? IfId_pc + 4 : 0;
+    wire [31:0] Id_j_pc4 = (Id_bru_ctrl[`BRU_CTRL_IS_JAL_JALR]) ? IfId_pc + ((IfId_rvc) ? 2 : 4) : 0;
 
     always @(posedge clk_i) if (!w_stall) begin
         if (rst) begin
@@ -263,6 +397,7 @@ module cpu (
             IdEx_pc               <= IfId_pc;
             IdEx_j_pc4            <= Id_j_pc4;
             IdEx_ir               <= IfId_ir;
+            IdEx_rvc              <= IfId_rvc;
             IdEx_br_pred_tkn      <= IfId_br_pred_tkn;
             IdEx_pat_hist         <= IfId_pat_hist;
             IdEx_alu_ctrl         <= Id_alu_ctrl;
@@ -278,6 +413,13 @@ module cpu (
             IdEx_rf_we            <= IfId_rf_we;
             IdEx_rd               <= IfId_rd;
             IdEx_cfu_ctrl         <= Id_cfu_ctrl;  // Note
+            IdEx_psimd_ctrl       <= Id_psimd_ctrl;
+            IdEx_vec_ctrl         <= Id_vec_ctrl;
+            IdEx_sys_ctrl         <= Id_sys_ctrl;
+            IdEx_fpu_ctrl         <= Id_fpu_ctrl;
+            IdEx_fsrc1            <= Id_fsrc1;
+            IdEx_fsrc2            <= Id_fsrc2;
+            IdEx_fsrc3            <= Id_fsrc3;
         end
     end
 
@@ -300,6 +442,50 @@ module cpu (
         .rslt_o    (Ex_alu_rslt)     // output wire           [`XLEN-1:0]
     );
 
+    ///// packed simd unit, the decoder issues no packed simd instruction unless USE_PSIMD is defined
+    wire [`XLEN-1:0] Ex_psimd_rslt;
+    psimd psimd (
+        .psimd_ctrl_i(IdEx_psimd_ctrl),  // input  wire [`PSIMD_CTRL_WIDTH-1:0]
+        .src1_i      (Ex_src1),          // input  wire             [`XLEN-1:0]
+        .src2_i      (Ex_src2),          // input  wire             [`XLEN-1:0]
+        .rslt_o      (Ex_psimd_rslt)     // output wire             [`XLEN-1:0]
+    );
+
+    ///// vector unit, the decoder issues no vector instruction unless USE_VECTOR is defined.
+    ///// A vector load or store holds the pipeline and uses the data bus in place of the store unit.
+    wire             Ex_vec_stall;
+    wire [`XLEN-1:0] Ex_vec_rslt;
+    wire [`XLEN-1:0] Ex_vec_vl;
+    wire [`XLEN-1:0] Ex_vec_vtype;
+    wire [`XLEN-1:0] Ex_vec_addr;
+    wire             Ex_vec_wvalid;
+    wire [`XLEN-1:0] Ex_vec_wdata;
+    wire       [3:0] Ex_vec_wstrb;
+    vector_unit vector_unit (
+        .clk_i        (clk_i),          // input  wire
+        .rst_i        (rst),            // input  wire
+        .stall_i      (w_stall),        // input  wire
+        .valid_i      (Ex_valid),       // input  wire
+        .vec_ctrl_i   (IdEx_vec_ctrl),  // input  wire [`VEC_CTRL_WIDTH-1:0]
+        .ir_i         (IdEx_ir),        // input  wire                [31:0]
+        .src1_i       (Ex_src1),        // input  wire           [`XLEN-1:0]
+        .src2_i       (Ex_src2),        // input  wire           [`XLEN-1:0]
+        .stall_o      (Ex_vec_stall),   // output wire
+        .rslt_o       (Ex_vec_rslt),    // output wire           [`XLEN-1:0]
+        .vl_o         (Ex_vec_vl),      // output wire           [`XLEN-1:0]
+        .vtype_o      (Ex_vec_vtype),   // output wire           [`XLEN-1:0]
+        .dbus_addr_o  (Ex_vec_addr),    // output wire           [`XLEN-1:0]
+        .dbus_wvalid_o(Ex_vec_wvalid),  // output wire
+        .dbus_wdata_o (Ex_vec_wdata),   // output wire           [`XLEN-1:0]
+        .dbus_wstrb_o (Ex_vec_wstrb),   // output wire                 [3:0]
+        .dbus_rdata_i (dbus_rdata_i)    // input  wire           [`XLEN-1:0]
+    );
+
+    assign dbus_addr_o   = Ex_lsu_addr | Ex_vec_addr;
+    assign dbus_wvalid_o = Ex_lsu_wvalid | Ex_vec_wvalid;
+    assign dbus_wdata_o  = (Ex_vec_wvalid) ? Ex_vec_wdata : Ex_lsu_wdata;
+    assign dbus_wstrb_o  = (Ex_vec_wvalid) ? Ex_vec_wstrb : Ex_lsu_wstrb;
+
     ///// branch resolution unit
     wire             Ex_is_ctrl_tsfr;
     wire             Ex_br_tkn;
@@ -311,6 +497,7 @@ module cpu (
         .src1_i         (Ex_src1),           // input  wire           [`XLEN-1:0]
         .src2_i         (Ex_src2),           // input  wire           [`XLEN-1:0]
         .pc_i           (IdEx_pc),           // input  wire           [`XLEN-1:0]
+        .rvc_i          (IdEx_rvc),          // input  wire
         .imm_i          (IdEx_imm),          // input  wire           [`XLEN-1:0]
         .npc_i          (IfId_pc),           // input  wire           [`XLEN-1:0]
         .br_pred_tkn_i  (IdEx_br_pred_tkn),  // input  wire
@@ -325,34 +512,64 @@ module cpu (
     wire [         `XLEN-1:0] dbus_addr = dbus_addr_o;  // for simulation
     wire [         `XLEN-1:0] dbus_wdata = dbus_wdata_o;  // for simulation
     wire [`DBUS_OFFSET_W-1:0] dbus_offset;  // Note
+    wire [         `XLEN-1:0] Ex_lsu_addr;
+    wire                      Ex_lsu_wvalid;
+    wire [         `XLEN-1:0] Ex_lsu_wdata;
+    wire [       `XBYTES-1:0] Ex_lsu_wstrb;
+    wire [         `XLEN-1:0] Ex_store_src2 = (IdEx_lsu_ctrl[`LSU_CTRL_IS_STORE] &&
+                                               IdEx_fpu_ctrl[`FPU_CTRL_IS_FRS2]) ? IdEx_fsrc2 : Ex_src2;
     store_unit store_unit (
         .valid_i      (Ex_valid && !w_stall), // input  wire
         .lsu_ctrl_i   (IdEx_lsu_ctrl),  // input  wire [`LSU_CTRL_WIDTH-1:0]
         .src1_i       (Ex_src1),        // input  wire           [`XLEN-1:0]
-        .src2_i       (Ex_src2),        // input  wire           [`XLEN-1:0]
+        .src2_i       (Ex_store_src2),  // input  wire           [`XLEN-1:0]
         .imm_i        (IdEx_imm),       // input  wire           [`XLEN-1:0]
-        .dbus_addr_o  (dbus_addr_o),    // output wire           [`XLEN-1:0]
+        .amo_op_i     (IdEx_ir[31:27]), // input  wire   [`AMO_OP_WIDTH-1:0]
+        .dbus_addr_o  (Ex_lsu_addr),    // output wire           [`XLEN-1:0]
         .dbus_offset_o(dbus_offset),    // output wire    [OFFSET_WIDTH-1:0]
-        .dbus_wvalid_o(dbus_wvalid_o),  // output wire
-        .dbus_wdata_o (dbus_wdata_o),   // output wire           [`XLEN-1:0]
-        .dbus_wstrb_o (dbus_wstrb_o),   // output wire         [`XBYTES-1:0]
+        .dbus_wvalid_o(Ex_lsu_wvalid),  // output wire
+        .dbus_wdata_o (Ex_lsu_wdata),   // output wire           [`XLEN-1:0]
+        .dbus_wstrb_o (Ex_lsu_wstrb),   // output wire         [`XBYTES-1:0]
         .dbus_is_lr_o (dbus_is_lr_o),   // output wire
-        .dbus_is_sc_o (dbus_is_sc_o)    // output wire
+        .dbus_is_sc_o (dbus_is_sc_o),   // output wire
+        .dbus_is_amo_o(dbus_is_amo_o),  // output wire
+        .dbus_amo_op_o(dbus_amo_op_o),  // output wire   [`AMO_OP_WIDTH-1:0]
+        .dbus_is_fence_o(dbus_is_fence_o) // output wire
     );
 
-    ///// multiplier unit
-    wire             Ex_mul_stall;
-    wire [`XLEN-1:0] Ex_mul_rslt;
+    ///// multiplier unit, pipelined over EX, MA and WB
     multiplier multiplier (
-        .clk_i     (clk_i),          // input  wire
-        .rst_i     (rst),            // input  wire // Note
-        .stall_i   (w_stall),        // input  wire
-        .valid_i   (Ex_valid),       // input  wire
-        .mul_ctrl_i(IdEx_mul_ctrl),  // input  wire [`MUL_CTRL_WIDTH-1:0]
-        .src1_i    (Ex_src1),        // input  wire           [`XLEN-1:0]
-        .src2_i    (Ex_src2),        // input  wire           [`XLEN-1:0]
-        .stall_o   (Ex_mul_stall),   // output wire
-        .rslt_o    (Ex_mul_rslt)     // output wire           [`XLEN-1:0]
+        .clk_i     (clk_i),                  // input  wire
+        .rst_i     (rst),                    // input  wire // Note
+        .stall_i   (w_stall || ExMa_stall),  // input  wire
+        .valid_i   (Ex_valid),               // input  wire
+        .mul_ctrl_i(IdEx_mul_ctrl),          // input  wire [`MUL_CTRL_WIDTH-1:0]
+        .src1_i    (Ex_src1),                // input  wire           [`XLEN-1:0]
+        .src2_i    (Ex_src2),                // input  wire           [`XLEN-1:0]
+        .rslt_o    (Wb_mul_rslt)             // output wire           [`XLEN-1:0]
+    );
+
+    ///// floating-point unit, pipelined over EX, MA and WB, the decoder issues no FP
+    ///// instruction unless USE_FPU is defined
+    wire             Ex_fpu_stall;
+    wire       [2:0] Ma_frm;
+    wire       [4:0] Wb_fpu_fflags;
+    fpu fpu (
+        .clk_i     (clk_i),           // input  wire
+        .rst_i     (rst),             // input  wire
+        .stall_i   (w_stall),         // input  wire
+        .hold_i    (ExMa_stall),      // input  wire
+        .valid_i   (Ex_valid),        // input  wire
+        .fpu_ctrl_i(IdEx_fpu_ctrl),   // input  wire [`FPU_CTRL_WIDTH-1:0]
+        .ir_i      (IdEx_ir),         // input  wire                [31:0]
+        .frm_i     (Ma_frm),          // input  wire                 [2:0]
+        .src1_i    (Ex_src1),         // input  wire           [`XLEN-1:0]
+        .fsrc1_i   (IdEx_fsrc1),      // input  wire           [`XLEN-1:0]
+        .fsrc2_i   (IdEx_fsrc2),      // input  wire           [`XLEN-1:0]
+        .fsrc3_i   (IdEx_fsrc3),      // input  wire           [`XLEN-1:0]
+        .stall_o   (Ex_fpu_stall),    // output wire
+        .rslt_o    (Wb_fpu_rslt),     // output wire           [`XLEN-1:0]
+        .fflags_o  (Wb_fpu_fflags)    // output wire                 [4:0]
     );
 
     ///// divider unit
@@ -370,6 +587,21 @@ module cpu (
         .rslt_o    (Ex_div_rslt)     // output wire           [`XLEN-1:0]
     );
 
+    ///// wait-on-reservation and wait-for-interrupt unit
+    wire             Ex_wrs_stall;
+    wire             Ma_irq_wake;
+    wrs_unit wrs_unit (
+        .clk_i      (clk_i),                          // input  wire
+        .rst_i      (rst),                            // input  wire
+        .stall_i    (w_stall),                        // input  wire
+        .valid_i    (Ex_valid),                       // input  wire
+        .lsu_ctrl_i (IdEx_lsu_ctrl),                  // input  wire [`LSU_CTRL_WIDTH-1:0]
+        .wfi_i      (IdEx_sys_ctrl[`SYS_CTRL_IS_WFI]), // input  wire
+        .rsv_valid_i(rsv_valid_i),                    // input  wire
+        .wake_i     (Ma_irq_wake),                    // input  wire
+        .stall_o    (Ex_wrs_stall)                    // output wire
+    );
+
     ///// custom function unit
     wire             Ex_cfu_en = IdEx_cfu_ctrl[0] & Ex_valid;
     wire             Ex_cfu_stall;
@@ -386,10 +618,9 @@ module cpu (
     );
 
     always @(posedge clk_i) if (!w_stall) begin
-        ExMa_mul_stall <= Ex_mul_stall;
         ExMa_div_stall <= Ex_div_stall;
-        ExMa_stall     <= Ex_mul_stall | Ex_div_stall | Ex_cfu_stall;
-        ExMa_mdc_rslt  <= Ex_mul_rslt | Ex_div_rslt | Ex_cfu_rslt;
+        ExMa_stall     <= Ex_div_stall | Ex_cfu_stall | Ex_wrs_stall | Ex_fpu_stall | Ex_vec_stall;
+        ExMa_mdc_rslt  <= Ex_div_rslt | Ex_cfu_rslt;
         if (rst) begin
             ExMa_v  <= 0;
             ExMa_pc <= 0;
@@ -398,6 +629,7 @@ module cpu (
             ExMa_v             <= Ex_v;
             ExMa_pc            <= IdEx_pc;
             ExMa_ir            <= IdEx_ir;
+            ExMa_rvc           <= IdEx_rvc;
             ExMa_pat_hist      <= IdEx_pat_hist;
             ExMa_is_ctrl_tsfr  <= Ex_is_ctrl_tsfr;
             ExMa_br_tkn        <= Ex_br_tkn;
@@ -405,10 +637,15 @@ module cpu (
             ExMa_br_misp_rslt2 <= Ex_br_misp_rslt2;
             ExMa_br_tkn_pc     <= Ex_br_tkn_pc;
             ExMa_lsu_ctrl      <= IdEx_lsu_ctrl;
+            ExMa_is_mul        <= IdEx_mul_ctrl[`MUL_CTRL_IS_MUL];
+            ExMa_is_fpu        <= IdEx_fpu_ctrl[`FPU_CTRL_IS_FPU];
+            ExMa_frf_we        <= IdEx_fpu_ctrl[`FPU_CTRL_IS_FRD];
+            ExMa_sys_ctrl      <= IdEx_sys_ctrl;
+            ExMa_csr_src       <= Ex_src1;
             ExMa_dbus_offset   <= dbus_offset;
             ExMa_rf_we         <= IdEx_rf_we;
             ExMa_rd            <= IdEx_rd;
-            ExMa_rslt          <= Ex_alu_rslt;
+            ExMa_rslt          <= Ex_alu_rslt | Ex_psimd_rslt | Ex_vec_rslt;
             ExMa_j_b_insn      <= IdEx_bru_ctrl[0] & Ex_v;
         end
     end
@@ -425,7 +662,57 @@ module cpu (
         .rslt_o       (Ma_load_rslt)       // output wire           [`XLEN-1:0]
     );
 
-    wire [`XLEN-1:0] Ma_rslt = ExMa_rslt | ExMa_mdc_rslt | Ma_load_rslt;
+    // performance monitoring events of this cycle
+    wire                    Ma_done = ExMa_v && !ExMa_stall && !w_stall && !rst;
+    wire [`PMU_NEVENTS-1:0] Ma_pmu_ev;
+    assign Ma_pmu_ev[`PMU_EV_NONE]       = 1'b0;
+    assign Ma_pmu_ev[`PMU_EV_CYCLE]      = 1'b1;
+    assign Ma_pmu_ev[`PMU_EV_INSTRET]    = Ma_done;
+    assign Ma_pmu_ev[`PMU_EV_DMEM_STALL] = pmu_dbus_ev_i[0];
+    assign Ma_pmu_ev[`PMU_EV_VMEM_STALL] = pmu_dbus_ev_i[1];
+    assign Ma_pmu_ev[`PMU_EV_MMIO_STALL] = pmu_dbus_ev_i[2];
+    assign Ma_pmu_ev[`PMU_EV_ARB_LOSS]   = pmu_dbus_ev_i[3];
+    assign Ma_pmu_ev[`PMU_EV_SC_FAIL]    = Ma_done && ExMa_lsu_ctrl[`LSU_CTRL_IS_SC] && Ma_load_rslt[0];
+    assign Ma_pmu_ev[`PMU_EV_BR_MISP]    = Ma_done && Ma_ctrl_misp;
+    assign Ma_pmu_ev[`PMU_EV_MUL_STALL]  = Id_mul_busy && !IfId_load_muldiv_use && !ExMa_stall && !w_stall && !rst;
+    assign Ma_pmu_ev[`PMU_EV_DIV_STALL]  = Ex_div_stall;
+    assign Ma_pmu_ev[`PMU_EV_CFU_STALL]  = Ex_cfu_stall;
+    assign Ma_pmu_ev[`PMU_EV_LOAD_USE]   = IfId_load_muldiv_use && !ExMa_stall && !w_stall && !rst;
+    assign Ma_pmu_ev[`PMU_EV_BRANCH]     = Ma_done && ExMa_is_ctrl_tsfr;
+    assign Ma_pmu_ev[`PMU_EV_WRS_STALL]  = Ex_wrs_stall;
+    assign Ma_pmu_ev[`PMU_EV_FPU_STALL]  = Ex_fpu_stall ||
+                                           (Id_fpu_busy && !IfId_load_muldiv_use && !Id_mul_busy && !ExMa_stall && !w_stall && !rst);
+
+    // control and status registers, traps and interrupts
+    wire [`XLEN-1:0] Ma_csr_rslt;
+    csr_file csr_file (
+        .clk_i      (clk_i),                            // input  wire
+        .rst_i      (rst),                              // input  wire
+        .stall_i    (w_stall),                          // input  wire
+        .valid_i    (ExMa_v && !ExMa_stall && !rst),    // input  wire
+        .sys_ctrl_i (ExMa_sys_ctrl),                    // input  wire [`SYS_CTRL_WIDTH-1:0]
+        .ir_i       (ExMa_ir),                          // input  wire           [31:0]
+        .rvc_i      (ExMa_rvc),                         // input  wire
+        .src_i      (ExMa_csr_src),                     // input  wire    [`XLEN-1:0]
+        .pc_i       (ExMa_pc),                          // input  wire    [`XLEN-1:0]
+        .npc_i      (Ma_npc),                           // input  wire    [`XLEN-1:0]
+        .irq_soft_i (irq_soft_i),                       // input  wire
+        .irq_timer_i(irq_timer_i),                      // input  wire
+        .mtime_i    (mtime_i),                          // input  wire           [63:0]
+        .pmu_run_i  (pmu_run_i),                        // input  wire
+        .hart_id_i  (hart_index),                       // input  wire           [31:0]
+        .pmu_ev_i   (Ma_pmu_ev),                        // input  wire [`PMU_NEVENTS-1:0]
+        .fflags_i   (Wb_fpu_fflags),                    // input  wire            [4:0]
+        .vl_i       (Ex_vec_vl),                        // input  wire           [31:0]
+        .vtype_i    (Ex_vec_vtype),                     // input  wire           [31:0]
+        .frm_o      (Ma_frm),                           // output wire            [2:0]
+        .rslt_o     (Ma_csr_rslt),                      // output wire    [`XLEN-1:0]
+        .trap_o     (Ma_trap),                          // output wire
+        .trap_pc_o  (Ma_trap_pc),                       // output wire    [`XLEN-1:0]
+        .wake_o     (Ma_irq_wake)                       // output wire
+    );
+
+    wire [`XLEN-1:0] Ma_rslt = ExMa_rslt | ExMa_mdc_rslt | Ma_load_rslt | Ma_csr_rslt;
 
     always @(posedge clk_i) if (!w_stall) begin
         if (rst) begin
@@ -433,12 +720,13 @@ module cpu (
             MaWb_pc <= 0;
             MaWb_ir <= `NOP;
         end else if (!ExMa_stall) begin
-            MaWb_v     <= Ma_v;
-            MaWb_pc    <= ExMa_pc;
-            MaWb_ir    <= ExMa_ir;
-            MaWb_rf_we <= ExMa_rf_we;
-            MaWb_rd    <= ExMa_rd;
-            MaWb_rslt  <= Ma_rslt;
+            MaWb_v      <= Ma_v;
+            MaWb_pc     <= ExMa_pc;
+            MaWb_ir     <= ExMa_ir;
+            MaWb_rf_we  <= ExMa_rf_we;
+            MaWb_frf_we <= ExMa_frf_we;
+            MaWb_rd     <= ExMa_rd;
+            MaWb_rslt   <= Ma_rslt;
         end
     end
 
@@ -448,7 +736,12 @@ module cpu (
 endmodule
 
 `define BTB_IDXW $clog2(`BTB_ENTRY)  // BTB index width
+`ifdef USE_RVC
+`define BTB_OSTW 1                   // BTB offset width, instructions are 2-byte aligned
+`else
 `define BTB_OSTW $clog2(`XBYTES)     // BTB offset width
+`endif
+`define BTB_ENTW (`PC_W+2-`BTB_OSTW) // BTB entry width, the upper target pc bits and a counter
 /******************************************************************************************/
 module bimodal (
     input  wire             clk_i,
@@ -466,7 +759,7 @@ module bimodal (
 );
 
     integer i;
-    (* ram_style = "block" *) reg [`PC_W-1:0] btb[0:`BTB_ENTRY-1];  // BTB, branch target buf
+    (* ram_style = "block" *) reg [`BTB_ENTW-1:0] btb[0:`BTB_ENTRY-1];  // BTB, branch target buf
     initial for (i = 0; i < `BTB_ENTRY; i = i + 1) btb[i] = 0;  // init with weak untaken
 
     wire [1:0] w_cnt = (br_tkn_i) ? pat_hist_i + (pat_hist_i < 3) : pat_hist_i - (pat_hist_i > 0);
@@ -477,13 +770,106 @@ module bimodal (
     always @(posedge clk_i) if (!stall_i) begin
         r_btb_entry <= btb[btb_ridx];
         if (br_tsfr_i) begin
-            btb[btb_widx] <= {br_tkn_pc_i[`PC_W-1:2], w_cnt};  // lower tow bits for counter
+            btb[btb_widx] <= {br_tkn_pc_i[`PC_W-1:`BTB_OSTW], w_cnt};  // lower tow bits for counter
         end
     end
 
     assign pat_hist_o    = r_btb_entry[1:0];
     assign br_pred_tkn_o = r_btb_entry[1];
-    assign br_pred_pc_o  = {r_btb_entry[`PC_W-1:2], 2'b0};
+    assign br_pred_pc_o  = {r_btb_entry[`BTB_ENTW-1:2], {`BTB_OSTW{1'b0}}};
+endmodule
+
+/******************************************************************************************/
+module rvc_expander (  ///// RV32C (with C.FLW/C.FSW of RV32FC) to the 32-bit instruction
+    input  wire [15:0] ir_i,
+    output reg  [31:0] ir_o
+);
+
+    localparam LOAD     = 7'b0000011;
+    localparam LOAD_FP  = 7'b0000111;
+    localparam OP_IMM   = 7'b0010011;
+    localparam STORE    = 7'b0100011;
+    localparam STORE_FP = 7'b0100111;
+    localparam OP       = 7'b0110011;
+    localparam LUI      = 7'b0110111;
+    localparam BRANCH   = 7'b1100011;
+    localparam JALR     = 7'b1100111;
+    localparam JAL      = 7'b1101111;
+
+    wire [4:0] rd   = ir_i[11:7];              // rd and rs1 of the full register forms
+    wire [4:0] rs2  = ir_i[6:2];
+    wire [4:0] rdp  = {2'b01, ir_i[4:2]};      // rd' and rs2'
+    wire [4:0] rs1p = {2'b01, ir_i[9:7]};      // rs1' and rd'
+
+    wire [11:0] imm6   = {{7{ir_i[12]}}, ir_i[6:2]};  // c.addi, c.li, c.andi
+    wire [11:0] a4spn  = {2'd0, ir_i[10:7], ir_i[12:11], ir_i[5], ir_i[6], 2'b00};
+    wire [11:0] a16sp  = {{3{ir_i[12]}}, ir_i[4:3], ir_i[5], ir_i[2], ir_i[6], 4'd0};
+    wire [11:0] lw_off = {5'd0, ir_i[5], ir_i[12:10], ir_i[6], 2'b00};
+    wire [11:0] lwsp   = {4'd0, ir_i[3:2], ir_i[12], ir_i[6:4], 2'b00};
+    wire [11:0] swsp   = {4'd0, ir_i[8:7], ir_i[12:9], 2'b00};
+    wire [20:0] j_off  = {{10{ir_i[12]}}, ir_i[8], ir_i[10:9], ir_i[6], ir_i[7], ir_i[2], ir_i[11],
+                          ir_i[5:3], 1'b0};
+    wire [12:0] b_off  = {{5{ir_i[12]}}, ir_i[6:5], ir_i[2], ir_i[11:10], ir_i[4:3], 1'b0};
+    wire [31:0] j_insn = {j_off[20], j_off[10:1], j_off[11], j_off[19:12], 5'd0, JAL};
+    wire [31:0] b_insn = {b_off[12], b_off[10:5], 5'd0, rs1p, 3'b000, b_off[4:1], b_off[11], BRANCH};
+
+    // A reserved or illegal parcel (0x0000, a zero immediate, rd = 0, shamt[5] = 1, RV64/D
+    // encodings) is passed on as {16'd0, parcel}. Its low bits are not 2'b11, so the decoder
+    // raises an illegal-instruction trap with the parcel in mtval.
+    always @(*) begin
+        ir_o = {16'd0, ir_i};
+        case ({ir_i[15:13], ir_i[1:0]})
+            5'b000_00: if (a4spn != 0) ir_o = {a4spn, 5'd2, 3'b000, rdp, OP_IMM};  // c.addi4spn
+            5'b010_00: ir_o = {lw_off, rs1p, 3'b010, rdp, LOAD};                   // c.lw
+            5'b011_00: ir_o = {lw_off, rs1p, 3'b010, rdp, LOAD_FP};                // c.flw
+            5'b110_00: ir_o = {lw_off[11:5], rdp, rs1p, 3'b010, lw_off[4:0], STORE};     // c.sw
+            5'b111_00: ir_o = {lw_off[11:5], rdp, rs1p, 3'b010, lw_off[4:0], STORE_FP};  // c.fsw
+            5'b000_01: ir_o = {imm6, rd, 3'b000, rd, OP_IMM};                      // c.addi, c.nop
+            5'b001_01: ir_o = j_insn | {20'd0, 5'd1, 7'd0};                        // c.jal
+            5'b010_01: ir_o = {imm6, 5'd0, 3'b000, rd, OP_IMM};                    // c.li
+            5'b011_01: if (ir_i[12] || ir_i[6:2] != 0) begin
+                ir_o = (rd == 2) ? {a16sp, 5'd2, 3'b000, 5'd2, OP_IMM} :            // c.addi16sp
+                                   {{15{ir_i[12]}}, ir_i[6:2], rd, LUI};           // c.lui
+            end
+            5'b100_01: begin
+                case (ir_i[11:10])
+                    2'b00: if (!ir_i[12]) ir_o = {7'b0000000, rs2, rs1p, 3'b101, rs1p, OP_IMM};  // c.srli
+                    2'b01: if (!ir_i[12]) ir_o = {7'b0100000, rs2, rs1p, 3'b101, rs1p, OP_IMM};  // c.srai
+                    2'b10: ir_o = {imm6, rs1p, 3'b111, rs1p, OP_IMM};                          // c.andi
+                    default: if (!ir_i[12]) begin  // c.sub, c.xor, c.or, c.and
+                        case (ir_i[6:5])
+                            2'b00:   ir_o = {7'b0100000, rdp, rs1p, 3'b000, rs1p, OP};
+                            2'b01:   ir_o = {7'b0000000, rdp, rs1p, 3'b100, rs1p, OP};
+                            2'b10:   ir_o = {7'b0000000, rdp, rs1p, 3'b110, rs1p, OP};
+                            default: ir_o = {7'b0000000, rdp, rs1p, 3'b111, rs1p, OP};
+                        endcase
+                    end
+                endcase
+            end
+            5'b101_01: ir_o = j_insn;                                              // c.j
+            5'b110_01: ir_o = b_insn;                                              // c.beqz
+            5'b111_01: ir_o = b_insn | {17'd0, 3'b001, 12'd0};                     // c.bnez
+            5'b000_10: if (!ir_i[12]) ir_o = {7'b0000000, rs2, rd, 3'b001, rd, OP_IMM};  // c.slli
+            5'b010_10: if (rd != 0) ir_o = {lwsp, 5'd2, 3'b010, rd, LOAD};         // c.lwsp
+            5'b011_10: ir_o = {lwsp, 5'd2, 3'b010, rd, LOAD_FP};                   // c.flwsp
+            5'b100_10: begin
+                if (!ir_i[12] && rs2 == 0) begin
+                    if (rd != 0) ir_o = {12'd0, rd, 3'b000, 5'd0, JALR};           // c.jr
+                end else if (!ir_i[12]) begin
+                    ir_o = {7'b0000000, rs2, 5'd0, 3'b000, rd, OP};                // c.mv
+                end else if (rs2 == 0 && rd == 0) begin
+                    ir_o = 32'h00100073;                                           // c.ebreak
+                end else if (rs2 == 0) begin
+                    ir_o = {12'd0, rd, 3'b000, 5'd1, JALR};                        // c.jalr
+                end else begin
+                    ir_o = {7'b0000000, rs2, rd, 3'b000, rd, OP};                  // c.add
+                end
+            end
+            5'b110_10: ir_o = {swsp[11:5], rs2, 5'd2, 3'b010, swsp[4:0], STORE};   // c.swsp
+            5'b111_10: ir_o = {swsp[11:5], rs2, 5'd2, 3'b010, swsp[4:0], STORE_FP};  // c.fswsp
+            default: ;
+        endcase
+    end
 endmodule
 
 /******************************************************************************************/
@@ -497,7 +883,8 @@ module pre_decoder (
 );
 
     wire [4:0] opcode = ir_i[6:2];
-    assign instr_type_o = (opcode == 5'b01101) ? `U_TYPE :  // LUI
+    assign instr_type_o = (ir_i[1:0] != 2'b11) ? `NONE_TYPE :  // an illegal RVC parcel
+        (opcode == 5'b01101) ? `U_TYPE :  // LUI
         (opcode == 5'b00101) ? `U_TYPE :  // AUIPC
         (opcode == 5'b11011) ? `J_TYPE :  // JAL
         (opcode == 5'b11001) ? `I_TYPE :  // JALR
@@ -507,13 +894,36 @@ module pre_decoder (
         (opcode == 5'b00100) ? `I_TYPE :  // OP-IMM
         (opcode == 5'b01100) ? `R_TYPE :  // OP
         (opcode == 5'b01011) ? `R_TYPE :  // AMO
+        (opcode == 5'b11100) ? `I_TYPE :  // SYSTEM
+        (opcode == 5'b00001 && ir_i[14:12] == 3'b010) ? `I_TYPE :  // LOAD-FP, flw
+        (opcode == 5'b00001) ? `R_TYPE :  // LOAD-FP, vector loads, rs2 is the stride
+        (opcode == 5'b01001) ? `S_TYPE :  // STORE-FP
+        (opcode == 5'b10100) ? `R_TYPE :  // OP-FP
+        (opcode[4:2] == 3'b100) ? `R_TYPE :  // MADD, MSUB, NMSUB, NMADD
+`ifdef USE_PSIMD
+        (opcode == 5'b01010) ? `R_TYPE :  // CUSTOM-1
+`endif
+`ifdef USE_VECTOR
+        (opcode == 5'b10101) ? `R_TYPE :  // OP-V
+`endif
         (opcode == 5'b00010) ? `R_TYPE : `NONE_TYPE;  // CUSTOM-0 : NONE
 
+    // an FP instruction writes an integer register only for fcvt.w[u].s, fmv.x.w, fclass and
+    // the compares
+    wire fp_rd = (opcode == 5'b00001) || (opcode[4:2] == 3'b100) ||
+                 (opcode == 5'b10100 && !((ir_i[31:30] == 2'b11 && !ir_i[28]) || ir_i[31:27] == 5'b10100));
+
     assign rd_o = ((instr_type_o == `S_TYPE) | (instr_type_o == `B_TYPE)) ? 0 : ir_i[11:7];
     assign rs1_o = ((instr_type_o == `U_TYPE) | (instr_type_o == `J_TYPE)) ? 0 : ir_i[19:15];
     assign rs2_o = ((instr_type_o==`I_TYPE) |
                     (instr_type_o==`U_TYPE) | (instr_type_o==`J_TYPE)) ? 0 : ir_i[24:20];
-    assign rf_we_o = (rd_o != 0);
+    // a vector instruction writes an integer register only for vset{i}vl{i} and vmv.x.s, an
+    // unimplemented one raises an illegal-instruction trap without writing rd
+    wire v_rd = (opcode == 5'b10101) &&
+                !((ir_i[14:12] == 3'b111 && (!ir_i[31] || ir_i[30] || ir_i[30:25] == 0)) ||
+                  (ir_i[14:12] == 3'b010 && ir_i[31:25] == 7'b0100001 && ir_i[19:15] == 0));
+
+    assign rf_we_o = (rd_o != 0) && (ir_i[1:0] == 2'b11) && !fp_rd && !v_rd;
 endmodule
 
 /******************************************************************************************/
@@ -548,31 +958,82 @@ module alu (
     output wire                [31:0] rslt_o
 );
 
+    function [5:0] clz32;
+        input [31:0] x;
+        integer b;
+        begin
+            clz32 = 32;
+            for (b = 0; b < 32; b = b + 1) if (x[b]) clz32 = 31 - b;
+        end
+    endfunction
+
+    function [5:0] ctz32;
+        input [31:0] x;
+        integer b;
+        begin
+            ctz32 = 32;
+            for (b = 31; b >= 0; b = b - 1) if (x[b]) ctz32 = b;
+        end
+    endfunction
+
+    function [5:0] cpop32;
+        input [31:0] x;
+        integer b;
+        begin
+            cpop32 = 0;
+            for (b = 0; b < 32; b = b + 1) cpop32 = cpop32 + x[b];
+        end
+    endfunction
+
     wire w_signed = alu_ctrl_i[`ALU_CTRL_IS_SIGNED];
     wire w_neg    = alu_ctrl_i[`ALU_CTRL_IS_NEG];
     wire w_less   = alu_ctrl_i[`ALU_CTRL_IS_LESS];
 
-    wire [33:0] adder_src1   = {w_signed && src1_i[31], src1_i, 1'b1};
+    wire  [1:0] shadd        = {alu_ctrl_i[`ALU_CTRL_IS_SHADD2], alu_ctrl_i[`ALU_CTRL_IS_SHADD1]};
+    wire [33:0] adder_src1   = {w_signed && src1_i[31], src1_i << shadd, 1'b1};
     wire [33:0] adder_src2   = {w_signed && src2_i[31], src2_i, 1'b0} ^ {34{w_neg}};
     wire [33:0] adder_rslt_t = adder_src1+adder_src2;
     wire        less_rslt    = w_less && adder_rslt_t[33];
     wire [31:0] adder_rslt   = (alu_ctrl_i[`ALU_CTRL_IS_ADD]) ? adder_rslt_t[32:1] : 0;
+    wire [31:0] minmax_rslt  = ((alu_ctrl_i[`ALU_CTRL_IS_MIN]) ? ((adder_rslt_t[33]) ? src1_i : src2_i) : 0) |
+                               ((alu_ctrl_i[`ALU_CTRL_IS_MAX]) ? ((adder_rslt_t[33]) ? src2_i : src1_i) : 0);
 
     wire signed  [32:0] right_shifter_src1 = {w_signed && src1_i[31], src1_i};
     wire  [4:0] shamt              = src2_i[4:0];
+    wire  [4:0] shamt_n            = -shamt;  // the other half of a rotate
     wire [31:0] left_shifter_rslt  = (alu_ctrl_i[`ALU_CTRL_IS_SHIFT_LEFT] ) ?
                                      src1_i <<  shamt : 0;
     wire [31:0] right_shifter_rslt = (alu_ctrl_i[`ALU_CTRL_IS_SHIFT_RIGHT]) ?
                                      right_shifter_src1 >>> shamt : 0;
+    wire [31:0] rotate_rslt        = (!alu_ctrl_i[`ALU_CTRL_IS_ROTATE]) ? 0 :
+                                     (alu_ctrl_i[`ALU_CTRL_IS_SHIFT_LEFT]) ? src1_i >> shamt_n :
+                                                                             src1_i << shamt_n;
 
+    ///// andn, orn, xnor and the single-bit operations replace src2 of the bitwise operations
+    wire [31:0] bitwise_src2_t     = (alu_ctrl_i[`ALU_CTRL_IS_BIT_MASK]) ? 32'd1 << shamt : src2_i;
+    wire [31:0] bitwise_src2       = (alu_ctrl_i[`ALU_CTRL_IS_INV_SRC2]) ? ~bitwise_src2_t : bitwise_src2_t;
     wire [31:0] bitwise_rslt       = ((alu_ctrl_i[`ALU_CTRL_IS_XOR_OR]) ?
-                                     (src1_i ^ src2_i) : 0) |
+                                     (src1_i ^ bitwise_src2) : 0) |
                                      ((alu_ctrl_i[`ALU_CTRL_IS_OR_AND])
-                                      ? (src1_i & src2_i) : 0);
+                                      ? (src1_i & bitwise_src2) : 0);
+    wire [31:0] bext_rslt          = (alu_ctrl_i[`ALU_CTRL_IS_BEXT]) ? {31'd0, src1_i[shamt]} : 0;
     wire [31:0] lui_auipc_rslt     = (alu_ctrl_i[`ALU_CTRL_IS_SRC2]) ? src2_i : 0;
 
+    ///// unary Zbb operations
+    wire [31:0] count_rslt = ((alu_ctrl_i[`ALU_CTRL_IS_CLZ] ) ? {26'd0, clz32(src1_i)}  : 0) |
+                             ((alu_ctrl_i[`ALU_CTRL_IS_CTZ] ) ? {26'd0, ctz32(src1_i)}  : 0) |
+                             ((alu_ctrl_i[`ALU_CTRL_IS_CPOP]) ? {26'd0, cpop32(src1_i)} : 0);
+    wire [31:0] ext_rslt   = ((alu_ctrl_i[`ALU_CTRL_IS_SEXT_B]) ? {{24{src1_i[7]}}, src1_i[7:0]}   : 0) |
+                             ((alu_ctrl_i[`ALU_CTRL_IS_SEXT_H]) ? {{16{src1_i[15]}}, src1_i[15:0]} : 0) |
+                             ((alu_ctrl_i[`ALU_CTRL_IS_ZEXT_H]) ? {16'd0, src1_i[15:0]}            : 0);
+    wire [31:0] byte_rslt  = ((alu_ctrl_i[`ALU_CTRL_IS_REV8]) ?
+                              {src1_i[7:0], src1_i[15:8], src1_i[23:16], src1_i[31:24]} : 0) |
+                             ((alu_ctrl_i[`ALU_CTRL_IS_ORC_B]) ?
+                              {{8{|src1_i[31:24]}}, {8{|src1_i[23:16]}}, {8{|src1_i[15:8]}}, {8{|src1_i[7:0]}}} : 0);
+
     assign rslt_o = less_rslt | adder_rslt | left_shifter_rslt | right_shifter_rslt |
-                    bitwise_rslt | lui_auipc_rslt | j_pc4_i;
+                    bitwise_rslt | lui_auipc_rslt | j_pc4_i | minmax_rslt | rotate_rslt |
+                    bext_rslt | count_rslt | ext_rslt | byte_rslt;
 endmodule
 
 /******************************************************************************************/
@@ -581,6 +1042,7 @@ module bru (
     input  wire [               31:0] src1_i,
     input  wire [               31:0] src2_i,
     input  wire [               31:0] pc_i,
+    input  wire                       rvc_i,  // a 16-bit instruction, the next one is at pc+2
     input  wire [               31:0] imm_i,
     input  wire [               31:0] npc_i,
     input  wire                       br_pred_tkn_i,
@@ -610,14 +1072,15 @@ module bru (
     assign is_ctrl_tsfr_o  = (bru_ctrl_i[`BRU_CTRL_IS_CTRL_TSFR] || br_pred_tkn_i);
 
     assign br_misp_rslt1_o = (npc_i != br_tkn_pc_o);
-    assign br_misp_rslt2_o = (npc_i != (pc_i + 'h4));
+    assign br_misp_rslt2_o = (npc_i != (pc_i + ((rvc_i) ? 'h2 : 'h4)));
 endmodule
 
 `define DIV_IDLE 0
 `define DIV_CHECK 1
-`define DIV_EXEC 2
-`define DIV_RET 3
-module divider (
+`define DIV_NORM 2
+`define DIV_EXEC 3
+`define DIV_RET 4
+module divider (  ///// radix-4 divider with early termination
     input  wire        clk_i      ,
     input  wire        rst_i      ,
     input  wire        stall_i    ,
@@ -629,23 +1092,54 @@ module divider (
     output wire [31:0] rslt_o
 );
 
-    reg [1:0] state = `DIV_IDLE;
+    // CHECK takes the absolute values, and NORM skips the leading quotient bits that are
+    // known to be zero from the leading zeros of the operands. A power-of-two divisor and a
+    // dividend smaller than the divisor are finished in NORM. EXEC retires two quotient bits
+    // per cycle, so a div/rem takes 3 + (significant quotient bits + 1) / 2 cycles.
+    reg [2:0] state = `DIV_IDLE;
     assign stall_o = (w_state!=`DIV_IDLE);
 
     reg        is_dividend_neg;
     reg        is_divisor_neg;
     reg [31:0] remainder;
     reg [31:0] divisor;
+    reg [33:0] divisor3;
     reg [31:0] quotient;
     reg        is_div_rslt_neg;
     reg        is_rem_rslt_neg;
     reg        is_rem;
-    reg  [4:0] cntr;
+    reg  [3:0] cntr;
+
+    function [5:0] clz32;
+        input [31:0] x;
+        integer b;
+        begin
+            clz32 = 32;
+            for (b = 0; b < 32; b = b + 1) if (x[b]) clz32 = 31 - b;
+        end
+    endfunction
 
     wire [31:0] uintx_remainder = (is_dividend_neg) ? ~remainder+1 : remainder;
     wire [31:0] uintx_divisor   = (is_divisor_neg ) ? ~divisor+1   : divisor;
-    wire [32:0] difference      = {remainder[30:0], quotient[31]} - divisor;
-    wire        q               = !difference[32];
+
+    ///// normalization, the dividend is in quotient
+    wire  [5:0] nlz_dividend = clz32(quotient);
+    wire  [5:0] nlz_divisor  = clz32(divisor);
+    wire [31:0] divisor_m1   = divisor - 1;
+    wire        is_pow2      = ((divisor & divisor_m1) == 0);
+    wire        is_small     = (nlz_dividend > nlz_divisor);  // dividend < divisor
+    wire  [5:0] nbits        = nlz_divisor - nlz_dividend + 1;  // significant quotient bits
+    wire  [4:0] nsteps       = (nbits + 1) >> 1;
+    wire [63:0] norm         = {32'd0, quotient} << (32 - 2*nsteps);
+
+    ///// radix-4 step
+    wire [33:0] partial = {remainder, quotient[31:30]};
+    wire [34:0] diff1   = {1'b0, partial} - {3'd0, divisor};
+    wire [34:0] diff2   = {1'b0, partial} - {2'd0, divisor, 1'b0};
+    wire [34:0] diff3   = {1'b0, partial} - {1'b0, divisor3};
+    wire  [1:0] q       = (!diff3[34]) ? 3 : (!diff2[34]) ? 2 : (!diff1[34]) ? 1 : 0;
+    wire [31:0] next_remainder = (!diff3[34]) ? diff3[31:0] : (!diff2[34]) ? diff2[31:0] :
+                                 (!diff1[34]) ? diff1[31:0] : partial[31:0];
 
     assign rslt_o = (state!=`DIV_RET) ? 0 :
                     (is_rem) ? ((is_rem_rslt_neg) ? ~remainder+1 : remainder) :
@@ -653,9 +1147,11 @@ module divider (
 
     wire w_div    = div_ctrl_i[`DIV_CTRL_IS_DIV];
     wire w_signed = div_ctrl_i[`DIV_CTRL_IS_SIGNED];
-    wire [1:0] w_state = (w_init) ? `DIV_CHECK :
+    wire [2:0] w_state = (w_init) ? `DIV_CHECK :
                          (state==`DIV_CHECK && divisor==0) ? `DIV_RET : // Note
-                         (state==`DIV_CHECK && divisor!=0) ? `DIV_EXEC :
+                         (state==`DIV_CHECK && divisor!=0) ? `DIV_NORM :
+                         (state==`DIV_NORM  && (is_pow2 || is_small)) ? `DIV_RET :
+                         (state==`DIV_NORM) ? `DIV_EXEC :
                          (state==`DIV_EXEC  && cntr==0) ? `DIV_RET :
                          (state==`DIV_EXEC  && cntr!=0) ? `DIV_EXEC : `DIV_IDLE;
 
@@ -671,24 +1167,24 @@ module divider (
 
         divisor <= (w_init) ? src2_i :
                    (state==`DIV_CHECK && divisor!=0) ? uintx_divisor : divisor;
+        divisor3 <= {2'd0, divisor} + {1'b0, divisor, 1'b0};
 
         {remainder, quotient} <= (w_init) ? {src1_i, 32'd0} :
                    (state==`DIV_CHECK && divisor==0) ? {remainder, {32{1'b1}}} :
                    (state==`DIV_CHECK && divisor!=0) ? {32'd0, uintx_remainder} :
-                   (state==`DIV_EXEC) ? ((q) ? {difference[31:0], quotient[30:0], 1'b1} :
-                                               {remainder[30:0], quotient, 1'b0}) :
+                   (state==`DIV_NORM  && is_pow2) ? {quotient & divisor_m1, quotient >> (31 - nlz_divisor)} :
+                   (state==`DIV_NORM  && is_small) ? {quotient, 32'd0} :
+                   (state==`DIV_NORM) ? norm :
+                   (state==`DIV_EXEC) ? {next_remainder, quotient[29:0], q} :
                    {remainder, quotient};
 
-        cntr <= (state==`DIV_CHECK) ? 31 : (state==`DIV_EXEC) ?  cntr-1 : cntr;
+        cntr <= (state==`DIV_NORM) ? nsteps-1 : (state==`DIV_EXEC) ?  cntr-1 : cntr;
         state <= w_state;
     end
 endmodule
 
-`define MUL_IDLE 0
-`define MUL_EXEC 1
-`define MUL_RET 2
 /******************************************************************************************/
-module multiplier (
+module multiplier (  ///// two-stage pipelined multiplier, a new multiply every cycle
     input  wire        clk_i,
     input  wire        rst_i,
     input  wire        stall_i,
@@ -696,37 +1192,383 @@ module multiplier (
     input  wire [ 3:0] mul_ctrl_i,
     input  wire [31:0] src1_i,
     input  wire [31:0] src2_i,
-    output wire        stall_o,
     output wire [31:0] rslt_o
 );
 
-    reg        [ 1:0] state = `MUL_IDLE;
+    // The operands are registered at the end of EX and the product at the end of MA,
+    // so that the DSP blocks have both input and output registers. The result is
+    // returned in WB.
+    reg               ma_v = 0;
     reg signed [32:0] r_multiplicand;  // 33bit
     reg signed [32:0] r_multiplier;  // 33bit
+    reg               ma_is_high;
+    reg               wb_v = 0;
     reg        [63:0] product;  // 64bit
-    reg               is_high;  //
+    reg               wb_is_high;
 
-    assign rslt_o = (state != `MUL_RET) ? 0 : (is_high) ? product[63:32] : product[31:0];
+    assign rslt_o = (!wb_v) ? 0 : (wb_is_high) ? product[63:32] : product[31:0];
 
     wire w_mul = mul_ctrl_i[`MUL_CTRL_IS_MUL];
     wire w_src1_signed = mul_ctrl_i[`MUL_CTRL_IS_SRC1_SIGNED];
     wire w_src2_signed = mul_ctrl_i[`MUL_CTRL_IS_SRC2_SIGNED];
     wire w_is_high = mul_ctrl_i[`MUL_CTRL_IS_HIGH];
-    wire [1:0] w_state = (state==`MUL_IDLE && valid_i && w_mul) ? `MUL_EXEC :
-                         (state==`MUL_EXEC) ? `MUL_RET : `MUL_IDLE;
 
     always @(posedge clk_i) if (!stall_i) begin
         if (rst_i) begin
-            state <= `MUL_IDLE;
-        end else if (!stall_i) begin
-            if (state == `MUL_IDLE) r_multiplicand <= {w_src1_signed && src1_i[31], src1_i};
-            if (state == `MUL_IDLE) r_multiplier <= {w_src2_signed && src2_i[31], src2_i};
-            if (state == `MUL_IDLE) is_high <= w_is_high;
-            if (state == `MUL_EXEC) product <= r_multiplicand * r_multiplier;
+            ma_v <= 0;
+            wb_v <= 0;
+        end else begin
+            ma_v           <= valid_i && w_mul;
+            r_multiplicand <= {w_src1_signed && src1_i[31], src1_i};
+            r_multiplier   <= {w_src2_signed && src2_i[31], src2_i};
+            ma_is_high     <= w_is_high;
+            wb_v           <= ma_v;
+            product        <= r_multiplicand * r_multiplier;
+            wb_is_high     <= ma_is_high;
+        end
+    end
+endmodule
+
+/******************************************************************************************/
+module psimd_lane #(  ///// one lane of the packed simd unit
+    parameter W = 8
+) (
+    input  wire [   6:0] op_i,
+    input  wire [ W-1:0] a_i,
+    input  wire [ W-1:0] b_i,
+    input  wire [   3:0] shamt_i,
+    output reg  [ W-1:0] rslt_o
+);
+
+    wire [W:0] sum  = {1'b0, a_i} + {1'b0, b_i};
+    wire [W:0] diff = {1'b0, a_i} - {1'b0, b_i};
+    wire       add_ovf = (a_i[W-1] == b_i[W-1]) && (sum[W-1]  != a_i[W-1]);
+    wire       sub_ovf = (a_i[W-1] != b_i[W-1]) && (diff[W-1] != a_i[W-1]);
+    wire       lt  = (a_i[W-1] != b_i[W-1]) ? a_i[W-1] : diff[W-1];
+    wire       ltu = diff[W];
+    wire [W-1:0] smax = {1'b0, {(W-1){1'b1}}};
+    wire [W-1:0] smin = {1'b1, {(W-1){1'b0}}};
+    wire [$clog2(W)-1:0] sh = shamt_i[$clog2(W)-1:0];
+
+    always @(*) begin
+        case (op_i)
+            `PSIMD_OP_ADD:    rslt_o = sum[W-1:0];
+            `PSIMD_OP_SUB:    rslt_o = diff[W-1:0];
+            `PSIMD_OP_ADDS:   rslt_o = (add_ovf) ? ((a_i[W-1]) ? smin : smax) : sum[W-1:0];
+            `PSIMD_OP_ADDUS:  rslt_o = (sum[W]) ? {W{1'b1}} : sum[W-1:0];
+            `PSIMD_OP_SUBS:   rslt_o = (sub_ovf) ? ((a_i[W-1]) ? smin : smax) : diff[W-1:0];
+            `PSIMD_OP_SUBUS:  rslt_o = (diff[W]) ? {W{1'b0}} : diff[W-1:0];
+            `PSIMD_OP_CMPEQ:  rslt_o = {W{a_i == b_i}};
+            `PSIMD_OP_CMPLT:  rslt_o = {W{lt}};
+            `PSIMD_OP_CMPLTU: rslt_o = {W{ltu}};
+            `PSIMD_OP_MIN:    rslt_o = (lt)  ? a_i : b_i;
+            `PSIMD_OP_MINU:   rslt_o = (ltu) ? a_i : b_i;
+            `PSIMD_OP_MAX:    rslt_o = (lt)  ? b_i : a_i;
+            `PSIMD_OP_MAXU:   rslt_o = (ltu) ? b_i : a_i;
+            `PSIMD_OP_SLL:    rslt_o = a_i << sh;
+            `PSIMD_OP_SRL:    rslt_o = a_i >> sh;
+            `PSIMD_OP_SRA:    rslt_o = $signed(a_i) >>> sh;
+            default:          rslt_o = 0;
+        endcase
+    end
+endmodule
+
+/******************************************************************************************/
+module psimd (  ///// packed simd unit, 4 x 8-bit or 2 x 16-bit lanes in one cycle
+    input  wire [`PSIMD_CTRL_WIDTH-1:0] psimd_ctrl_i,
+    input  wire                  [31:0] src1_i,
+    input  wire                  [31:0] src2_i,
+    output wire                  [31:0] rslt_o
+);
+
+    wire       w_psimd = psimd_ctrl_i[`PSIMD_CTRL_IS_PSIMD];
+    wire [2:0] funct3  = psimd_ctrl_i[3:1];
+    wire [6:0] op      = psimd_ctrl_i[10:4];
+
+    wire [31:0] rslt8;
+    wire [31:0] rslt16;
+    genvar i;
+    generate
+        for (i = 0; i < 4; i = i + 1) begin : gen_lane8
+            psimd_lane #(.W(8)) lane (
+                .op_i   (op),
+                .a_i    (src1_i[8*i +: 8]),
+                .b_i    (src2_i[8*i +: 8]),
+                .shamt_i(src2_i[3:0]),
+                .rslt_o (rslt8[8*i +: 8])
+            );
+        end
+        for (i = 0; i < 2; i = i + 1) begin : gen_lane16
+            psimd_lane #(.W(16)) lane (
+                .op_i   (op),
+                .a_i    (src1_i[16*i +: 16]),
+                .b_i    (src2_i[16*i +: 16]),
+                .shamt_i(src2_i[3:0]),
+                .rslt_o (rslt16[16*i +: 16])
+            );
+        end
+    endgenerate
+
+    ///// dot products, the lanes are sign or zero extended by one bit
+    wire               w_dot_s = (op == `PSIMD_OP_DOT);
+    wire signed [17:0] p8_0  = $signed({w_dot_s && src1_i[ 7], src1_i[ 7: 0]}) * $signed({w_dot_s && src2_i[ 7], src2_i[ 7: 0]});
+    wire signed [17:0] p8_1  = $signed({w_dot_s && src1_i[15], src1_i[15: 8]}) * $signed({w_dot_s && src2_i[15], src2_i[15: 8]});
+    wire signed [17:0] p8_2  = $signed({w_dot_s && src1_i[23], src1_i[23:16]}) * $signed({w_dot_s && src2_i[23], src2_i[23:16]});
+    wire signed [17:0] p8_3  = $signed({w_dot_s && src1_i[31], src1_i[31:24]}) * $signed({w_dot_s && src2_i[31], src2_i[31:24]});
+    wire signed [33:0] p16_0 = $signed({w_dot_s && src1_i[15], src1_i[15: 0]}) * $signed({w_dot_s && src2_i[15], src2_i[15: 0]});
+    wire signed [33:0] p16_1 = $signed({w_dot_s && src1_i[31], src1_i[31:16]}) * $signed({w_dot_s && src2_i[31], src2_i[31:16]});
+    wire        [31:0] dot8  = p8_0 + p8_1 + p8_2 + p8_3;
+    wire        [31:0] dot16 = p16_0 + p16_1;
+
+    wire        w_dot = (op == `PSIMD_OP_DOT) || (op == `PSIMD_OP_DOTU);
+    wire [31:0] rslt  = (funct3 == 0) ? ((w_dot) ? dot8  : rslt8) :
+                        (funct3 == 1) ? ((w_dot) ? dot16 : rslt16) : 0;
+    assign rslt_o = (w_psimd) ? rslt : 0;
+endmodule
+
+`define WRS_IDLE 0
+`define WRS_WAIT 1
+/******************************************************************************************/
+module wrs_unit (  ///// Zawrs wrs.nto / wrs.sto and wfi
+    input  wire                       clk_i,
+    input  wire                       rst_i,
+    input  wire                       stall_i,
+    input  wire                       valid_i,
+    input  wire [`LSU_CTRL_WIDTH-1:0] lsu_ctrl_i,
+    input  wire                       wfi_i,
+    input  wire                       rsv_valid_i,
+    input  wire                       wake_i,       // an enabled interrupt is pending
+    output wire                       stall_o
+);
+
+    // The core is parked in EX while the reservation set by a preceding LR is valid.
+    // The data memory controller drops the reservation when another core writes the
+    // reserved word, which wakes the core up without any bus request while it waits.
+    // wfi is parked in the same way until an interrupt enabled in mie is pending.
+    reg        state = `WRS_IDLE;
+    reg [31:0] cntr;
+    reg        is_sto;
+    reg        is_wfi;
+
+    wire w_wrs     = lsu_ctrl_i[`LSU_CTRL_IS_WRS];
+    wire w_timeout = is_sto && (cntr == `WRS_STO_CYCLES);
+    wire w_state   = (state==`WRS_IDLE && valid_i && !wake_i && ((w_wrs && rsv_valid_i) || wfi_i)) ? `WRS_WAIT :
+                     (state==`WRS_WAIT && !wake_i && (is_wfi || (rsv_valid_i && !w_timeout))) ? `WRS_WAIT : `WRS_IDLE;
+
+    always @(posedge clk_i) if (!stall_i) begin
+        if (rst_i) begin
+            state <= `WRS_IDLE;
+        end else begin
+            if (state == `WRS_IDLE) is_sto <= lsu_ctrl_i[`LSU_CTRL_IS_WRS_STO];
+            if (state == `WRS_IDLE) is_wfi <= wfi_i;
+            cntr  <= (state == `WRS_IDLE) ? 1 : cntr + 1;
             state <= w_state;
         end
     end
-    assign stall_o = (w_state != `MUL_IDLE);
+    assign stall_o = (w_state != `WRS_IDLE);
+endmodule
+
+/******************************************************************************************/
+module csr_file #(  ///// machine-mode CSRs and trap control
+    parameter NHPM = `PMU_COUNTERS
+) (
+    input  wire                       clk_i,
+    input  wire                       rst_i,
+    input  wire                       stall_i,
+    input  wire                       valid_i,     // the instruction in MA completes this cycle
+    input  wire [`SYS_CTRL_WIDTH-1:0] sys_ctrl_i,
+    input  wire [31:0]                ir_i,
+    input  wire                       rvc_i,       // ir_i is expanded from a 16-bit instruction
+    input  wire [31:0]                src_i,
+    input  wire [31:0]                pc_i,
+    input  wire [31:0]                npc_i,       // the next pc of the instruction in MA
+    input  wire                       irq_soft_i,
+    input  wire                       irq_timer_i,
+    input  wire [63:0]                mtime_i,
+    input  wire                       pmu_run_i,   // the shared counter enable, with mcountinhibit
+    input  wire [31:0]                hart_id_i,
+    input  wire [`PMU_NEVENTS-1:0]    pmu_ev_i,
+    input  wire [ 4:0]                fflags_i,    // the FP exception flags of the instruction in WB
+    input  wire [31:0]                vl_i,
+    input  wire [31:0]                vtype_i,
+    output wire [ 2:0]                frm_o,
+    output wire [31:0]                rslt_o,
+    output wire                       trap_o,
+    output wire [31:0]                trap_pc_o,
+    output wire                       wake_o
+);
+
+    reg        mstatus_mie  = 0;
+    reg        mstatus_mpie = 0;
+    reg        mie_msie     = 0;
+    reg        mie_mtie     = 0;
+    reg [31:0] mtvec        = 0;
+    reg [31:0] mscratch     = 0;
+    reg [31:0] mepc         = 0;
+    reg [31:0] mcause       = 0;
+    reg [31:0] mtval        = 0;
+    reg [63:0] mcycle       = 0;
+    reg [63:0] minstret     = 0;
+    reg        inhibit_cy   = 0;  // mcountinhibit.CY
+    reg        inhibit_ir   = 0;  // mcountinhibit.IR
+    reg  [4:0] fflags       = 0;
+    reg  [2:0] frm          = 0;
+    integer    k;
+
+    assign frm_o = frm;
+
+    // programmable event counters mhpmcounter3.. selected by mhpmevent3..
+    localparam HPMW = (NHPM > 0) ? NHPM : 1;
+    reg               [63:0] hpm_cntr  [0:HPMW-1];
+    reg [`PMU_EV_WIDTH-1:0] hpm_event [0:HPMW-1];
+    reg           [HPMW-1:0] inhibit_hpm = 0;  // mcountinhibit.HPM3..
+    initial begin
+        for (k = 0; k < HPMW; k = k + 1) begin
+            hpm_cntr[k]  = 0;
+            hpm_event[k] = 0;
+        end
+    end
+
+    wire w_csr    = sys_ctrl_i[`SYS_CTRL_IS_CSR];
+    wire w_ecall  = sys_ctrl_i[`SYS_CTRL_IS_ECALL];
+    wire w_ebreak = sys_ctrl_i[`SYS_CTRL_IS_EBREAK];
+    wire w_mret   = sys_ctrl_i[`SYS_CTRL_IS_MRET];
+    wire w_ill    = sys_ctrl_i[`SYS_CTRL_IS_ILLEGAL];
+
+    ///// csr read
+    wire [11:0] csr_addr = ir_i[31:20];
+    reg  [31:0] csr_rdata;
+    always @(*) begin
+        case (csr_addr)
+            `CSR_FFLAGS:   csr_rdata = {27'd0, fflags | fflags_i};  // with the flags of WB
+            `CSR_FRM:      csr_rdata = {29'd0, frm};
+            `CSR_FCSR:     csr_rdata = {24'd0, frm, fflags | fflags_i};
+            `CSR_MSTATUS:  csr_rdata = {19'd0, 2'b11, 3'd0, mstatus_mpie, 3'd0, mstatus_mie, 3'd0};
+            `CSR_MIE:      csr_rdata = {24'd0, mie_mtie, 3'd0, mie_msie, 3'd0};
+            `CSR_MTVEC:    csr_rdata = mtvec;
+            `CSR_MSCRATCH: csr_rdata = mscratch;
+            `CSR_MEPC:     csr_rdata = mepc;
+            `CSR_MCAUSE:   csr_rdata = mcause;
+            `CSR_MTVAL:    csr_rdata = mtval;
+            `CSR_MIP:      csr_rdata = {24'd0, irq_timer_i, 3'd0, irq_soft_i, 3'd0};
+            `CSR_MCOUNTINHIBIT: csr_rdata = {{(29-HPMW){1'b0}}, inhibit_hpm, inhibit_ir, 1'b0, inhibit_cy};
+            `CSR_MCYCLE,    `CSR_CYCLE:    csr_rdata = mcycle[31:0];
+            `CSR_MCYCLEH,   `CSR_CYCLEH:   csr_rdata = mcycle[63:32];
+            `CSR_MINSTRET,  `CSR_INSTRET:  csr_rdata = minstret[31:0];
+            `CSR_MINSTRETH, `CSR_INSTRETH: csr_rdata = minstret[63:32];
+            `CSR_TIME:     csr_rdata = mtime_i[31:0];
+            `CSR_TIMEH:    csr_rdata = mtime_i[63:32];
+            `CSR_MHARTID:  csr_rdata = hart_id_i;
+`ifdef USE_VECTOR
+            `CSR_VL:       csr_rdata = vl_i;
+            `CSR_VTYPE:    csr_rdata = vtype_i;
+            `CSR_VLENB:    csr_rdata = `VLEN / 8;
+`endif
+            default:       csr_rdata = 0;
+        endcase
+        for (k = 0; k < NHPM; k = k + 1) begin
+            if (csr_addr == `CSR_MHPMEVENT3 + k)    csr_rdata = hpm_event[k];
+            if (csr_addr == `CSR_MHPMCOUNTER3 + k  || csr_addr == `CSR_HPMCOUNTER3 + k)  csr_rdata = hpm_cntr[k][31:0];
+            if (csr_addr == `CSR_MHPMCOUNTER3H + k || csr_addr == `CSR_HPMCOUNTER3H + k) csr_rdata = hpm_cntr[k][63:32];
+        end
+    end
+    assign rslt_o = (w_csr) ? csr_rdata : 0;
+
+    ///// csr write, csrrs/csrrc with rs1 = x0 (or uimm = 0) do not write
+    wire [31:0] w_src   = (ir_i[14]) ? {27'd0, ir_i[19:15]} : src_i;
+    wire        w_csr_we = valid_i && w_csr && (ir_i[13:12] == 2'b01 || ir_i[19:15] != 0);
+    wire [31:0] w_wdata = (ir_i[13:12] == 2'b01) ? w_src :
+                          (ir_i[13:12] == 2'b10) ? csr_rdata | w_src : csr_rdata & ~w_src;
+
+    ///// traps, an interrupt is taken after the instruction in MA unless it is a SYSTEM one
+    wire w_soft  = irq_soft_i && mie_msie;
+    wire w_timer = irq_timer_i && mie_mtie;
+    assign wake_o = w_soft || w_timer;
+
+    wire w_exc  = valid_i && (w_ecall || w_ebreak || w_ill);
+    wire w_ret  = valid_i && w_mret;
+    wire w_intr = valid_i && mstatus_mie && wake_o && !(w_csr || w_ecall || w_ebreak || w_ill || w_mret);
+
+    assign trap_o    = w_exc || w_ret || w_intr;
+    assign trap_pc_o = (w_ret) ? mepc : {mtvec[31:2], 2'b00};
+
+    always @(posedge clk_i) if (!stall_i) begin
+        if (rst_i) begin
+            mstatus_mie  <= 0;
+            mstatus_mpie <= 0;
+            mie_msie     <= 0;
+            mie_mtie     <= 0;
+        end else if (w_exc || w_intr) begin
+            mstatus_mie  <= 0;
+            mstatus_mpie <= mstatus_mie;
+            mepc         <= (w_exc) ? pc_i : npc_i;
+            mcause       <= (w_ecall && valid_i) ? 11 : (w_ebreak && valid_i) ? 3 : (w_ill && valid_i) ? 2 :
+                            (w_soft) ? {1'b1, 31'd3} : {1'b1, 31'd7};
+            // the instruction bits of an ebreak or an illegal instruction, so that the handler
+            // knows its length. An illegal RVC parcel arrives as {16'd0, parcel}, and c.ebreak
+            // arrives expanded, so its parcel 0x9002 is restored here.
+            mtval        <= (w_ebreak && valid_i && rvc_i) ? 32'h00009002 :
+                            ((w_ebreak || w_ill) && valid_i) ? ir_i : 0;
+        end else if (w_ret) begin
+            mstatus_mie  <= mstatus_mpie;
+            mstatus_mpie <= 1;
+        end else if (w_csr_we) begin
+            case (csr_addr)
+                `CSR_MSTATUS:  begin mstatus_mie <= w_wdata[3]; mstatus_mpie <= w_wdata[7]; end
+                `CSR_MIE:      begin mie_msie <= w_wdata[3]; mie_mtie <= w_wdata[7]; end
+                `CSR_MTVEC:    mtvec    <= {w_wdata[31:2], 2'b00};
+                `CSR_MSCRATCH: mscratch <= w_wdata;
+`ifdef USE_RVC
+                `CSR_MEPC:     mepc     <= {w_wdata[31:1], 1'b0};
+`else
+                `CSR_MEPC:     mepc     <= {w_wdata[31:2], 2'b00};
+`endif
+                `CSR_MCAUSE:   mcause   <= w_wdata;
+                `CSR_MTVAL:    mtval    <= w_wdata;
+                `CSR_MCOUNTINHIBIT: begin
+                    inhibit_cy  <= w_wdata[0];
+                    inhibit_ir  <= w_wdata[2];
+                    inhibit_hpm <= w_wdata[HPMW+2:3];
+                end
+                default: ;
+            endcase
+        end
+    end
+
+    ///// floating-point flags, accrued by the FPU operations in WB
+    always @(posedge clk_i) if (!stall_i) begin
+        if (rst_i) begin
+            fflags <= 0;
+            frm    <= 0;
+        end else begin
+            if (w_csr_we && (csr_addr == `CSR_FFLAGS || csr_addr == `CSR_FCSR)) fflags <= w_wdata[4:0];
+            else                                                                 fflags <= fflags | fflags_i;
+            if (w_csr_we && csr_addr == `CSR_FRM)  frm <= w_wdata[2:0];
+            if (w_csr_we && csr_addr == `CSR_FCSR) frm <= w_wdata[7:5];
+        end
+    end
+
+    ///// counters, mcycle counts every cycle including the stalled ones
+    wire w_cntr_we = w_csr_we && !stall_i && !rst_i;
+    wire w_retire  = valid_i && !stall_i && !rst_i && !(w_ecall || w_ebreak || w_ill);
+    always @(posedge clk_i) begin
+        if      (w_cntr_we && csr_addr == `CSR_MCYCLE)  mcycle[31:0]  <= w_wdata;
+        else if (w_cntr_we && csr_addr == `CSR_MCYCLEH) mcycle[63:32] <= w_wdata;
+        else if (!inhibit_cy && pmu_run_i)              mcycle        <= mcycle + 1;
+
+        if      (w_cntr_we && csr_addr == `CSR_MINSTRET)  minstret[31:0]  <= w_wdata;
+        else if (w_cntr_we && csr_addr == `CSR_MINSTRETH) minstret[63:32] <= w_wdata;
+        else if (w_retire && !inhibit_ir && pmu_run_i)    minstret        <= minstret + 1;
+
+        for (k = 0; k < NHPM; k = k + 1) begin
+            if      (w_cntr_we && csr_addr == `CSR_MHPMCOUNTER3 + k)  hpm_cntr[k][31:0]  <= w_wdata;
+            else if (w_cntr_we && csr_addr == `CSR_MHPMCOUNTER3H + k) hpm_cntr[k][63:32] <= w_wdata;
+            else if (!inhibit_hpm[k] && pmu_run_i && pmu_ev_i[hpm_event[k]])
+                hpm_cntr[k] <= hpm_cntr[k] + 1;
+            if (w_cntr_we && csr_addr == `CSR_MHPMEVENT3 + k)
+                hpm_event[k] <= (w_wdata < `PMU_NEVENTS) ? w_wdata[`PMU_EV_WIDTH-1:0] : `PMU_EV_NONE;
+        end
+    end
 endmodule
 
 /******************************************************************************************/
@@ -736,27 +1578,36 @@ module store_unit (
     input  wire [31:0]                src1_i,
     input  wire [31:0]                src2_i,
     input  wire [31:0]                imm_i,
+    input  wire [`AMO_OP_WIDTH-1:0]   amo_op_i,
     output wire [31:0]                dbus_addr_o,
     output wire [ 1:0]                dbus_offset_o,
     output wire                       dbus_wvalid_o,
     output wire [31:0]                dbus_wdata_o,
     output wire [ 3:0]                dbus_wstrb_o,
     output wire                       dbus_is_lr_o,
-    output wire                       dbus_is_sc_o
+    output wire                       dbus_is_sc_o,
+    output wire                       dbus_is_amo_o,
+    output wire [`AMO_OP_WIDTH-1:0]   dbus_amo_op_o,
+    output wire                       dbus_is_fence_o
 );
 
     wire is_load  = lsu_ctrl_i[`LSU_CTRL_IS_LOAD];
     wire is_store = lsu_ctrl_i[`LSU_CTRL_IS_STORE];
     wire is_lr    = lsu_ctrl_i[`LSU_CTRL_IS_LR];
     wire is_sc    = lsu_ctrl_i[`LSU_CTRL_IS_SC];
+    wire is_amo   = lsu_ctrl_i[`LSU_CTRL_IS_AMO];
+    wire is_fence = lsu_ctrl_i[`LSU_CTRL_IS_FENCE];
 
     assign dbus_addr_o = (valid_i && (is_load || is_store))
-                         ? ((is_lr || is_sc) ? src1_i : src1_i + imm_i)
+                         ? ((is_lr || is_sc || is_amo) ? src1_i : src1_i + imm_i)
                          : 0;
     assign dbus_offset_o = dbus_addr_o[1:0];
     assign dbus_wvalid_o = valid_i && is_store;
     assign dbus_is_lr_o  = valid_i && is_lr;
     assign dbus_is_sc_o  = valid_i && is_sc;
+    assign dbus_is_amo_o = valid_i && is_amo;
+    assign dbus_amo_op_o = (valid_i && is_amo) ? amo_op_i : 0;
+    assign dbus_is_fence_o = valid_i && is_fence;  // no bus request, observed by the store buffer
 
     wire w_sb = lsu_ctrl_i[`LSU_CTRL_IS_BYTE];
     wire w_sh = lsu_ctrl_i[`LSU_CTRL_IS_HALFWORD];
@@ -838,15 +1689,81 @@ module decoder (
     output wire [ `LSU_CTRL_WIDTH-1:0] lsu_ctrl_o,
     output wire [ `MUL_CTRL_WIDTH-1:0] mul_ctrl_o,
     output wire [ `DIV_CTRL_WIDTH-1:0] div_ctrl_o,
-    output wire [ `CFU_CTRL_WIDTH-1:0] cfu_ctrl_o
+    output wire [ `CFU_CTRL_WIDTH-1:0] cfu_ctrl_o,
+    output wire [ `SYS_CTRL_WIDTH-1:0] sys_ctrl_o,
+    output wire [ `FPU_CTRL_WIDTH-1:0] fpu_ctrl_o,
+    output wire [`PSIMD_CTRL_WIDTH-1:0] psimd_ctrl_o,
+    output wire [ `VEC_CTRL_WIDTH-1:0] vec_ctrl_o
 );
 
-    wire [31:0] ir = ir_i;
+    // an instruction without the low bits 2'b11 is an illegal RVC parcel, decoded as a nop
+    // that traps
+    wire        rvc_ill = (ir_i[1:0] != 2'b11);
+    wire [31:0] ir = (rvc_ill) ? `NOP : ir_i;
     wire [ 6:0] opcode = ir[6:0];
     wire [ 4:0] op = ir[6:2];
     wire [ 2:0] f3 = ir[14:12];
     wire [ 6:0] f7 = ir[31:25];
     assign cfu_ctrl_o = (op == 5'b00010) ? {f7, f3, 1'b1} : 0;
+`ifdef USE_PSIMD
+    assign psimd_ctrl_o = (op == 5'b01010) ? {f7, f3, 1'b1} : 0;
+`else
+    assign psimd_ctrl_o = 0;
+`endif
+
+`ifdef USE_VECTOR
+    // Only the instructions implemented by vector_unit are issued, the other vector encodings
+    // (other element widths, masked, indexed, segment and the other arithmetic) are illegal.
+    wire [5:0] f6 = ir[31:26];
+    wire is_vmem = (f3 == 3'b110) && (ir[31:28] == 0) && ir[25] &&  // 32-bit elements, unmasked
+                   (ir[27:26] == 2'b10 || (ir[27:26] == 2'b00 && ir[24:20] == 0));  // strided, unit-stride
+    wire is_vls  = (op == 5'b00001 || op == 5'b01001) && (f3 == 3'b000 || f3[2:1] == 2'b11 || f3 == 3'b101);
+    wire is_vcfg = (f3 == 3'b111) && (!ir[31] || ir[30] || ir[30:25] == 0);  // vsetvli, vsetivli, vsetvl
+    // vsub and vmin/vmax have no .vi form, and vrsub has no .vv form
+    wire is_vsub_minmax = (f6 == 6'b000010) || (f6[5:2] == 4'b0001);
+    wire is_valu = (f3 == 3'b000 || f3 == 3'b011 || f3 == 3'b100) && ir[25] &&  // OPIVV, OPIVI, OPIVX
+                   ((f6 == 6'b000000) || (is_vsub_minmax && f3 != 3'b011) || (f6 == 6'b000011 && f3 != 3'b000) ||
+                    f6 == 6'b001001 || f6 == 6'b001010 || f6 == 6'b001011 ||
+                    (f6 == 6'b010111 && ir[24:20] == 0) || f6 == 6'b100101 || f6 == 6'b101000 || f6 == 6'b101001);
+    wire is_vred = (f3 == 3'b010) && ir[25] && (f6[5:3] == 3'b000);  // vred*.vs
+    wire is_vmv  = ir[25] && (f6 == 6'b010000) &&
+                   ((f3 == 3'b010 && ir[19:15] == 0) || (f3 == 3'b110 && ir[24:20] == 0));  // vmv.x.s, vmv.s.x
+    wire vec_c1 = (op == 5'b00001) && is_vmem;  // IS_LOAD
+    wire vec_c2 = (op == 5'b01001) && is_vmem;  // IS_STORE
+    wire vec_c0 = vec_c1 || vec_c2 || (op == 5'b10101 && (is_vcfg || is_valu || is_vred || is_vmv));  // IS_VEC
+    assign vec_ctrl_o = {vec_c2, vec_c1, vec_c0};
+    wire vec_illegal = (op == 5'b10101 && !vec_c0) || (is_vls && !is_vmem);
+`else
+    assign vec_ctrl_o = 0;
+    wire vec_illegal = 0;
+`endif
+
+    wire sys_c0 = (op == 5'b11100) && (f3 != 0) && (f3 != 4);  // IS_CSR
+    wire sys_c1 = (ir == 32'h00000073);  // IS_ECALL
+    wire sys_c2 = (ir == 32'h00100073);  // IS_EBREAK
+    wire sys_c3 = (ir == 32'h30200073);  // IS_MRET
+    wire sys_c4 = (ir == 32'h10500073);  // IS_WFI
+    wire sys_c5 = vec_illegal || rvc_ill;  // IS_ILLEGAL
+    assign sys_ctrl_o = {sys_c5, sys_c4, sys_c3, sys_c2, sys_c1, sys_c0};
+
+`ifdef USE_FPU
+    wire is_flw    = (op == 5'b00001 && f3 == 2);
+    wire is_fsw    = (op == 5'b01001 && f3 == 2);
+    wire is_fp_op  = (op == 5'b10100 || op[4:2] == 3'b100) && (f7[1:0] == 2'b00);  // single precision
+    wire is_fp_r4  = (op[4:2] == 3'b100);
+    wire fp_int_rd = (f7[6:5] == 2'b11 && !f7[3]) || (f7 == 7'b1010000);  // fcvt.w.s, fmv.x.w, fclass, compares
+    wire fp_int_rs = (f7[6:5] == 2'b11 &&  f7[3]);  // fcvt.s.w, fmv.w.x
+    wire fpu_c0 = is_fp_op;  // IS_FPU
+    wire fpu_c1 = is_flw || (is_fp_op && (is_fp_r4 || !fp_int_rd));  // IS_FRD
+    wire fpu_c2 = is_fp_op && (is_fp_r4 || !fp_int_rs);  // IS_FRS1
+    wire fpu_c3 = is_fsw || (is_fp_op && (is_fp_r4 || f7[6:5] == 2'b00 || f7 == 7'b1010000));  // IS_FRS2
+    wire fpu_c4 = is_fp_op && is_fp_r4;  // IS_FRS3
+    assign fpu_ctrl_o = {fpu_c4, fpu_c3, fpu_c2, fpu_c1, fpu_c0};
+`else
+    wire is_flw = 0;
+    wire is_fsw = 0;
+    assign fpu_ctrl_o = 0;
+`endif
 
     wire src2_c0 = (op == 5'b00101);  // AUIPC
     wire src2_c1 = (op == 5'b01101) | (op == 5'b00100);  // LUI, OP-IMM
@@ -862,15 +1779,24 @@ module decoder (
     wire bru_c7 = (op == 5'b11011) || (op == 5'b11001);  // IS_JAL_JALR
     assign bru_ctrl_o = {bru_c7, bru_c6, bru_c5, bru_c4, bru_c3, bru_c2, bru_c1, bru_c0};
 
-    wire lsu_c0 = (op == 0) || (op == 5'b01011 && f7[6:2] == 5'b00010);  // IS_LOAD
-    wire lsu_c1 = (op == 8) || (op == 5'b01011 && f7[6:2] == 5'b00011);  // IS_STORE
+    wire is_amo = (op == 5'b01011 && f3 == 2) &&
+                  (f7[6:2] == `AMO_OP_ADD || f7[6:2] == `AMO_OP_SWAP || f7[6:2] == `AMO_OP_XOR ||
+                   f7[6:2] == `AMO_OP_OR  || f7[6:2] == `AMO_OP_AND  || f7[6:2] == `AMO_OP_MIN ||
+                   f7[6:2] == `AMO_OP_MAX || f7[6:2] == `AMO_OP_MINU || f7[6:2] == `AMO_OP_MAXU);
+    wire lsu_c0 = (op == 0) || (op == 5'b01011 && f7[6:2] == 5'b00010) || is_amo || is_flw;  // IS_LOAD
+    wire lsu_c1 = (op == 8) || (op == 5'b01011 && f7[6:2] == 5'b00011) || is_amo || is_fsw;  // IS_STORE
     wire lsu_c2 = (op == 0 && (f3 == 0 || f3 == 1 || f3 == 2));  // IS_SIGNED
     wire lsu_c3 = (op == 0 && (f3 == 0 || f3 == 4)) || (op == 8 && (f3 == 0));  // BYTE
     wire lsu_c4 = (op == 0 && (f3 == 1 || f3 == 5)) || (op == 8 && (f3 == 1));  // HALFWORD
-    wire lsu_c5 = (op == 0 && (f3 == 2)) || (op == 8 && (f3 == 2)) || (op == 5'b01011 && f3 == 2);  // WORD
+    wire lsu_c5 = (op == 0 && (f3 == 2)) || (op == 8 && (f3 == 2)) || (op == 5'b01011 && f3 == 2) ||
+                  is_flw || is_fsw;  // WORD
     wire lsu_c6 = (op == 5'b01011 && f7[6:2] == 5'b00010 && f3 == 2);  // IS_LR
     wire lsu_c7 = (op == 5'b01011 && f7[6:2] == 5'b00011 && f3 == 2);  // IS_SC
-    assign lsu_ctrl_o = {lsu_c7, lsu_c6, lsu_c5, lsu_c4, lsu_c3, lsu_c2, lsu_c1, lsu_c0};
+    wire lsu_c8 = is_amo;  // IS_AMO
+    wire lsu_c9 = (op == 5'b00011);  // IS_FENCE
+    wire lsu_c10 = (ir == 32'h00d00073) || (ir == 32'h01d00073);  // IS_WRS (wrs.nto, wrs.sto)
+    wire lsu_c11 = (ir == 32'h01d00073);  // IS_WRS_STO
+    assign lsu_ctrl_o = {lsu_c11, lsu_c10, lsu_c9, lsu_c8, lsu_c7, lsu_c6, lsu_c5, lsu_c4, lsu_c3, lsu_c2, lsu_c1, lsu_c0};
 
     wire mul_c0 = (op == 12) && (f7 == 1) && (f3 == 0 || f3 == 1 || f3 == 2 || f3 == 3);  // IS_MUL
     wire mul_c1 = (op == 12) && (f7 == 1) && (f3 == 1 || f3 == 2);  // IS_SRC1_SIGNED
@@ -884,21 +1810,67 @@ module decoder (
     assign div_ctrl_o = {div_c2, div_c1, div_c0};
 
     wire [9:0] f10 = {f7, f3};
+
+`ifdef USE_BITMANIP
+    wire [4:0] f5u = ir[24:20];  // selects the unary Zbb operations
+    wire zb_shadd  = (op == 12 && f7 == 7'b0010000 && (f3 == 2 || f3 == 4 || f3 == 6));  // sh1add, sh2add, sh3add
+    wire zb_andn   = (op == 12 && f10 == 10'b0100000111);
+    wire zb_orn    = (op == 12 && f10 == 10'b0100000110);
+    wire zb_xnor   = (op == 12 && f10 == 10'b0100000100);
+    wire zb_minmax = (op == 12 && f7 == 7'b0000101 && f3[2]);  // min, minu, max, maxu
+    wire zb_rot    = (op == 12 && f7 == 7'b0110000 && (f3 == 1 || f3 == 5)) ||
+                     (op == 4 && f7 == 7'b0110000 && f3 == 5);  // rol, ror, rori
+    wire zb_unary  = (op == 4 && f7 == 7'b0110000 && f3 == 1);  // clz, ctz, cpop, sext.b, sext.h
+    wire zb_zext_h = (op == 12 && f10 == 10'b0000100100 && f5u == 0);
+    wire zb_rev8   = (op == 4 && ir[31:20] == 12'h698 && f3 == 5);
+    wire zb_orc_b  = (op == 4 && ir[31:20] == 12'h287 && f3 == 5);
+    wire zb_bclr   = (op == 12 || op == 4) && f10 == 10'b0100100001;  // bclr, bclri
+    wire zb_bext   = (op == 12 || op == 4) && f10 == 10'b0100100101;  // bext, bexti
+    wire zb_binv   = (op == 12 || op == 4) && f10 == 10'b0110100001;  // binv, binvi
+    wire zb_bset   = (op == 12 || op == 4) && f10 == 10'b0010100001;  // bset, bseti
+`else
+    wire [4:0] f5u = 0;
+    wire zb_shadd = 0, zb_andn = 0, zb_orn = 0, zb_xnor = 0, zb_minmax = 0, zb_rot = 0, zb_unary = 0;
+    wire zb_zext_h = 0, zb_rev8 = 0, zb_orc_b = 0, zb_bclr = 0, zb_bext = 0, zb_binv = 0, zb_bset = 0;
+`endif
+
     wire alu_c0 = (op==4 && f3==2) || (op==4 && f3==5 && f7==7'b0100000) ||
-                  (op==5'b01100 && (f10==10'b10 || f10==10'b0100000101)); // IS_SIGNED
+                  (op==5'b01100 && (f10==10'b10 || f10==10'b0100000101)) ||
+                  (zb_minmax && !f3[0]); // IS_SIGNED
     wire alu_c1 = (op==4 && (f3==2 || f3==3)) || (op==5'b01100 &&
-                  (f10==10'b100000000 || f10==10'b10 || f10==10'b11)); // IS_NEG
+                  (f10==10'b100000000 || f10==10'b10 || f10==10'b11)) || zb_minmax; // IS_NEG
     wire alu_c2 = (op==4 && (f3==2 || f3==3)) ||
                   (op==5'b01100 && (f10==10'b10 || f10==10'b11)); // IS_LESS
     wire alu_c3 = (op==4 && f3==0) ||
-                  (op==5'b01100 && (f10==10'b0 || f10==10'b100000000)); // IS_ADD
-    wire alu_c4 = (op == 4 && f3 == 1 && f7 == 7'b0) || (op == 12 && f10 == 1);  // IS_SHIFT_LEFT
+                  (op==5'b01100 && (f10==10'b0 || f10==10'b100000000)) || zb_shadd; // IS_ADD
+    wire alu_c4 = (op == 4 && f3 == 1 && f7 == 7'b0) || (op == 12 && f10 == 1) ||
+                  (zb_rot && f3 == 1);  // IS_SHIFT_LEFT
     wire alu_c5 = (op==4 && f3==5 && (f7==7'b0 || f7==7'b100000)) || (op==12 &&
-                  (f10==10'b101 || f10==10'b0100000101)); // IS_SHIFT_RIGHT
-    wire alu_c6 = (op==4 && (f3==4 || f3==6)) || (op==12 && (f10==4 || f10==6));//IS_XOR_OR
-    wire alu_c7 = (op==4 && (f3==6 || f3==7)) || (op==12 && (f10==6 || f10==7));//IS_OR_AND
+                  (f10==10'b101 || f10==10'b0100000101)) || (zb_rot && f3 == 5); // IS_SHIFT_RIGHT
+    wire alu_c6 = (op==4 && (f3==4 || f3==6)) || (op==12 && (f10==4 || f10==6)) ||
+                  zb_orn || zb_xnor || zb_binv || zb_bset;//IS_XOR_OR
+    wire alu_c7 = (op==4 && (f3==6 || f3==7)) || (op==12 && (f10==6 || f10==7)) ||
+                  zb_andn || zb_orn || zb_bclr || zb_bset;//IS_OR_AND
     wire alu_c8 = (op == 5'b01101 || op == 5'b00101);  // IS_SRC2
-    assign alu_ctrl_o = {alu_c8, alu_c7, alu_c6, alu_c5, alu_c4, alu_c3, alu_c2, alu_c1, alu_c0};
+    wire alu_c9  = zb_shadd && f3[1];  // IS_SHADD1
+    wire alu_c10 = zb_shadd && f3[2];  // IS_SHADD2
+    wire alu_c11 = zb_andn || zb_orn || zb_xnor || zb_bclr;  // IS_INV_SRC2
+    wire alu_c12 = zb_bclr || zb_binv || zb_bset;  // IS_BIT_MASK
+    wire alu_c13 = zb_bext;  // IS_BEXT
+    wire alu_c14 = zb_rot;  // IS_ROTATE
+    wire alu_c15 = zb_minmax && !f3[1];  // IS_MIN
+    wire alu_c16 = zb_minmax &&  f3[1];  // IS_MAX
+    wire alu_c17 = zb_unary && f5u == 0;  // IS_CLZ
+    wire alu_c18 = zb_unary && f5u == 1;  // IS_CTZ
+    wire alu_c19 = zb_unary && f5u == 2;  // IS_CPOP
+    wire alu_c20 = zb_unary && f5u == 4;  // IS_SEXT_B
+    wire alu_c21 = zb_unary && f5u == 5;  // IS_SEXT_H
+    wire alu_c22 = zb_zext_h;  // IS_ZEXT_H
+    wire alu_c23 = zb_rev8;  // IS_REV8
+    wire alu_c24 = zb_orc_b;  // IS_ORC_B
+    assign alu_ctrl_o = {alu_c24, alu_c23, alu_c22, alu_c21, alu_c20, alu_c19, alu_c18, alu_c17,
+                         alu_c16, alu_c15, alu_c14, alu_c13, alu_c12, alu_c11, alu_c10, alu_c9,
+                         alu_c8, alu_c7, alu_c6, alu_c5, alu_c4, alu_c3, alu_c2, alu_c1, alu_c0};
 endmodule
 /******************************************************************************************/
 
@@ -0,0 +1,200 @@
+/* CFU Proving Ground since 2025-02    Copyright(c) 2025 Archlab. Science Tokyo /
+/ Released under the MIT license https://opensource.org/licenses/mit           */
+
+`default_nettype none
+`include "config.vh"
+
+`define VOP_IVV 3'b000
+`define VOP_MVV 3'b010
+`define VOP_IVI 3'b011
+`define VOP_IVX 3'b100
+`define VOP_MVX 3'b110
+`define VOP_CFG 3'b111
+/******************************************************************************************/
+module vector_unit #(  ///// minimal vector unit (Zve32x subset) with VLEN-bit registers
+    parameter VLEN = `VLEN
+) (
+    input  wire                       clk_i,
+    input  wire                       rst_i,
+    input  wire                       stall_i,
+    input  wire                       valid_i,
+    input  wire [`VEC_CTRL_WIDTH-1:0] vec_ctrl_i,
+    input  wire [               31:0] ir_i,
+    input  wire [               31:0] src1_i,
+    input  wire [               31:0] src2_i,
+    output wire                       stall_o,
+    output wire [               31:0] rslt_o,      // the x[rd] of vset{i}vl{i} and vmv.x.s
+    output wire [               31:0] vl_o,
+    output wire [               31:0] vtype_o,
+    output wire [               31:0] dbus_addr_o,
+    output wire                       dbus_wvalid_o,
+    output wire [               31:0] dbus_wdata_o,
+    output wire [                3:0] dbus_wstrb_o,
+    input  wire [               31:0] dbus_rdata_i
+);
+
+    // Only SEW=32 and LMUL=1 are supported, another vtype sets vill and vl to 0. The vector
+    // instructions are unmasked and leave the tail elements undisturbed. The arithmetic and
+    // the reductions process all the VLEN/32 elements in EX in one cycle. The loads and
+    // stores are unit-stride or strided, and issue one element per cycle on the data bus
+    // while the pipeline is held like the divider, so that a vector memory instruction is
+    // ordered with the scalar ones around it.
+    localparam NE  = VLEN / 32;           // the elements of a vector register
+    localparam VLW = $clog2(NE + 1);      // the width of vl
+
+    function [31:0] valu;
+        input [ 5:0] f6;
+        input [31:0] a;  // vs2[i]
+        input [31:0] b;  // vs1[i], x[rs1] or the immediate
+        begin
+            case (f6)
+                6'b000000: valu = a + b;                                    // vadd
+                6'b000010: valu = a - b;                                    // vsub
+                6'b000011: valu = b - a;                                    // vrsub
+                6'b000100: valu = (a < b) ? a : b;                          // vminu
+                6'b000101: valu = ($signed(a) < $signed(b)) ? a : b;        // vmin
+                6'b000110: valu = (a < b) ? b : a;                          // vmaxu
+                6'b000111: valu = ($signed(a) < $signed(b)) ? b : a;        // vmax
+                6'b001001: valu = a & b;                                    // vand
+                6'b001010: valu = a | b;                                    // vor
+                6'b001011: valu = a ^ b;                                    // vxor
+                6'b010111: valu = b;                                        // vmv.v.*
+                6'b100101: valu = a << b[4:0];                              // vsll
+                6'b101000: valu = a >> b[4:0];                              // vsrl
+                6'b101001: valu = $signed(a) >>> b[4:0];                    // vsra
+                default:   valu = 0;
+            endcase
+        end
+    endfunction
+
+    function [31:0] vred;
+        input [ 2:0] f6;  // funct6[2:0] of vredsum, vredand, vredor, vredxor, vredminu, vredmin, vredmaxu, vredmax
+        input [31:0] acc;
+        input [31:0] x;
+        begin
+            case (f6)
+                3'd0: vred = acc + x;
+                3'd1: vred = acc & x;
+                3'd2: vred = acc | x;
+                3'd3: vred = acc ^ x;
+                3'd4: vred = (x < acc) ? x : acc;
+                3'd5: vred = ($signed(x) < $signed(acc)) ? x : acc;
+                3'd6: vred = (x < acc) ? acc : x;
+                default: vred = ($signed(x) < $signed(acc)) ? acc : x;
+            endcase
+        end
+    endfunction
+
+    reg [VLEN-1:0] vrf [0:31];
+    reg  [VLW-1:0] vl    = 0;
+    reg     [31:0] vtype = 32'h80000000;  // vill
+
+    assign vl_o    = vl;
+    assign vtype_o = vtype;
+
+    wire       w_vec = vec_ctrl_i[`VEC_CTRL_IS_VEC];
+    wire       is_ld = vec_ctrl_i[`VEC_CTRL_IS_LOAD];
+    wire       is_st = vec_ctrl_i[`VEC_CTRL_IS_STORE];
+    wire [4:0] vd    = ir_i[11:7];
+    wire [4:0] vs1   = ir_i[19:15];
+    wire [4:0] vs2   = ir_i[24:20];
+    wire [2:0] f3    = ir_i[14:12];
+    wire [5:0] f6    = ir_i[31:26];
+    wire       is_op = w_vec && !is_ld && !is_st;
+
+    wire [VLEN-1:0] v1 = vrf[vs1];
+    wire [VLEN-1:0] v2 = vrf[vs2];
+    wire [VLEN-1:0] v3 = vrf[vd];   // the tail elements, and the data of a store
+
+    ///// vsetvli, vsetivli and vsetvl
+    wire          is_cfg    = is_op && (f3 == `VOP_CFG);
+    wire          is_setivl = (ir_i[31:30] == 2'b11);
+    wire          is_setvl  = (ir_i[31:30] == 2'b10);
+    wire   [31:0] new_vtype = (is_setvl) ? src2_i : (is_setivl) ? {22'd0, ir_i[29:20]} : {21'd0, ir_i[30:20]};
+    wire   [31:0] avl       = (is_setivl) ? {27'd0, vs1} : (vs1 != 0) ? src1_i :
+                              (vd != 0) ? 32'hffffffff : vl;
+    wire          vtype_ok  = (new_vtype[31:8] == 0) && (new_vtype[5:3] == 3'b010) && (new_vtype[2:0] == 0);
+    wire [VLW-1:0] new_vl   = (!vtype_ok) ? 0 : (avl > NE) ? NE : avl[VLW-1:0];
+
+    ///// element-wise arithmetic, the scalar operand is x[rs1] or the sign-extended simm5
+    wire        is_valu = is_op && (f3 == `VOP_IVV || f3 == `VOP_IVX || f3 == `VOP_IVI) &&
+                          (f6[5:3] == 3'b000 || f6 == 6'b001001 || f6 == 6'b001010 || f6 == 6'b001011 ||
+                           f6 == 6'b010111 || f6 == 6'b100101 || f6 == 6'b101000 || f6 == 6'b101001);
+    wire [31:0] scalar  = (f3 == `VOP_IVI) ? {{27{vs1[4]}}, vs1} : src1_i;
+    wire [VLEN-1:0] valu_rslt;
+    genvar e;
+    generate
+        for (e = 0; e < NE; e = e + 1) begin : gen_elem
+            wire [31:0] b = (f3 == `VOP_IVV) ? v1[32*e +: 32] : scalar;
+            assign valu_rslt[32*e +: 32] = (e < vl) ? valu(f6, v2[32*e +: 32], b) : v3[32*e +: 32];
+        end
+    endgenerate
+
+    ///// reductions vd[0] = vs1[0] op vs2[0..vl-1], and the moves of element 0
+    wire is_vred   = is_op && (f3 == `VOP_MVV) && (f6[5:3] == 3'b000);
+    wire is_vmv_xs = is_op && (f3 == `VOP_MVV) && (f6 == 6'b010000) && (vs1 == 0);
+    wire is_vmv_sx = is_op && (f3 == `VOP_MVX) && (f6 == 6'b010000) && (vs2 == 0);
+    reg  [31:0] red;
+    integer i;
+    always @(*) begin
+        red = v1[31:0];
+        for (i = 0; i < NE; i = i + 1) if (i < vl) red = vred(f6[2:0], red, v2[32*i +: 32]);
+    end
+
+    wire            op_we   = valid_i && (is_valu || ((is_vred || is_vmv_sx) && vl != 0));
+    wire [VLEN-1:0] op_rslt = (is_valu) ? valu_rslt : {v3[VLEN-1:32], (is_vred) ? red : src1_i};
+
+    assign rslt_o = (is_cfg) ? {{(32-VLW){1'b0}}, new_vl} : (is_vmv_xs) ? v2[31:0] : 0;
+
+    ///// unit-stride and strided loads and stores, one element per cycle
+    reg             m_busy = 0;
+    reg             m_load;
+    reg       [4:0] m_vd;
+    reg   [VLW-1:0] m_idx;     // the element requested in this cycle, the previous one returns
+    reg   [VLW-1:0] m_vl;
+    reg      [31:0] m_addr;
+    reg      [31:0] m_stride;
+
+    wire            m_start  = valid_i && (is_ld || is_st) && (vl != 0) && !m_busy;
+    wire     [31:0] stride   = (ir_i[27:26] == 2'b10) ? src2_i : 32'd4;
+    wire  [VLW-1:0] req_idx  = (m_busy) ? m_idx : 0;
+    wire  [VLW-1:0] req_vl   = (m_busy) ? m_vl : vl;
+    wire            req_st   = (m_busy) ? !m_load : is_st;
+    wire            req_v    = m_start || (m_busy && m_idx < m_vl);
+    wire [VLEN-1:0] st_vreg  = vrf[(m_busy) ? m_vd : vd];
+
+    assign dbus_addr_o   = (req_v && !stall_i) ? ((m_busy) ? m_addr : src1_i) : 0;
+    assign dbus_wvalid_o = req_v && !stall_i && req_st;
+    assign dbus_wdata_o  = (req_v && req_st) ? st_vreg[32*req_idx +: 32] : 0;
+    assign dbus_wstrb_o  = (req_v && req_st) ? 4'hf : 0;
+
+    // the pipeline is held until the last store is issued or the last load returns
+    assign stall_o = req_v && !(req_st && req_idx == req_vl - 1);
+
+    always @(posedge clk_i) if (!stall_i) begin
+        if (valid_i && is_cfg) begin
+            vl    <= new_vl;
+            vtype <= (vtype_ok) ? new_vtype : 32'h80000000;
+        end
+        if (op_we) vrf[vd] <= op_rslt;
+
+        if (rst_i) begin
+            m_busy <= 0;
+        end else if (m_start) begin
+            m_busy   <= !(is_st && vl == 1);
+            m_load   <= is_ld;
+            m_vd     <= vd;
+            m_idx    <= 1;
+            m_vl     <= vl;
+            m_addr   <= src1_i + stride;
+            m_stride <= stride;
+        end else if (m_busy) begin
+            if (m_load) vrf[m_vd][32*(m_idx-1) +: 32] <= dbus_rdata_i;
+            m_idx  <= m_idx + 1;
+            m_addr <= m_addr + m_stride;
+            if ((m_load) ? (m_idx == m_vl) : (m_idx == m_vl - 1)) m_busy <= 0;
+        end
+    end
+endmodule
+
+`resetall
@@ -0,0 +1,93 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Fetch-and-add work dispensers with NDISP counters, mapped at 0x40006000
+//   0x000 + 16*d : load returns the value of dispenser d and adds its stride to it,
+//                  store sets the value
+//   0x004 + 16*d : stride (load/store)
+//   0x008 + 16*d : limit (load/store), the value is not advanced once it reaches the limit
+//   0x00C + 16*d : 1 if the value has reached the limit, 0 otherwise (load)
+//   0xFFC        : the number of dispensers (load), zero when the unit is not present
+// The loads of the same cycle to a dispenser are all served in that cycle in core index
+// order, so a load never stalls. The value and the limit are compared as unsigned numbers.
+module dispenser_unit #(
+    parameter NCORES = `NCORES,
+    parameter NDISP  = `HW_DISPENSERS
+) (
+    input  wire                 clk_i,
+    input  wire [NCORES-1:0]    re_packed_i,
+    input  wire [NCORES-1:0]    we_packed_i,
+    input  wire [10*NCORES-1:0] addr_packed_i,   // word address within the 4 KiB page
+    input  wire [32*NCORES-1:0] wdata_packed_i,
+    output wire [32*NCORES-1:0] rdata_packed_o
+);
+    localparam DW = (NDISP > 1) ? $clog2(NDISP) : 1;
+    integer d, j;
+
+    reg [31:0] value_q  [0:NDISP-1];
+    reg [31:0] stride_q [0:NDISP-1];
+    reg [31:0] limit_q  [0:NDISP-1];
+    reg [31:0] rdata_q  [0:NCORES-1];
+
+    initial begin
+        for (d = 0; d < NDISP; d = d + 1) begin
+            value_q[d]  = 0;
+            stride_q[d] = 1;
+            limit_q[d]  = 32'hffffffff;
+        end
+    end
+
+    // Request decode
+    wire    [9:0] addr [0:NCORES-1];
+    wire [DW-1:0] id   [0:NCORES-1];
+    wire [NCORES-1:0] in_range;
+    genvar i;
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : gen_decode
+            assign addr[i]     = addr_packed_i[10*i +: 10];
+            assign id[i]       = addr[i][DW+1:2];
+            assign in_range[i] = (addr[i][9:2] < NDISP);
+
+            assign rdata_packed_o[32*i +: 32] = rdata_q[i];
+        end
+    endgenerate
+
+    // Fetch-and-add, the loads of this cycle take consecutive values
+    reg [31:0] value_d [0:NDISP-1];
+    reg [31:0] fetch   [0:NCORES-1];
+    always @(*) begin
+        for (d = 0; d < NDISP; d = d + 1) value_d[d] = value_q[d];
+        for (j = 0; j < NCORES; j = j + 1) begin
+            fetch[j] = value_d[id[j]];
+            if (re_packed_i[j] && in_range[j] && addr[j][1:0] == 0 && value_d[id[j]] < limit_q[id[j]]) begin
+                value_d[id[j]] = value_d[id[j]] + stride_q[id[j]];
+            end
+        end
+        // A store sets the value after the loads of the same cycle
+        for (j = 0; j < NCORES; j = j + 1) begin
+            if (we_packed_i[j] && in_range[j] && addr[j][1:0] == 0) value_d[id[j]] = wdata_packed_i[32*j +: 32];
+        end
+    end
+
+    always @(posedge clk_i) begin
+        for (d = 0; d < NDISP; d = d + 1) value_q[d] <= value_d[d];
+
+        for (j = 0; j < NCORES; j = j + 1) begin
+            if (we_packed_i[j] && in_range[j] && addr[j][1:0] == 1) stride_q[id[j]] <= wdata_packed_i[32*j +: 32];
+            if (we_packed_i[j] && in_range[j] && addr[j][1:0] == 2) limit_q[id[j]]  <= wdata_packed_i[32*j +: 32];
+
+            if (re_packed_i[j]) begin
+                rdata_q[j] <= (addr[j] == 10'h3ff) ? NDISP :
+                              !in_range[j] ? 0 :
+                              (addr[j][1:0] == 0) ? fetch[j] :
+                              (addr[j][1:0] == 1) ? stride_q[id[j]] :
+                              (addr[j][1:0] == 2) ? limit_q[id[j]] :
+                              (value_q[id[j]] >= limit_q[id[j]]);
+            end
+        end
+    end
+endmodule
+
+`resetall
@@ -0,0 +1,30 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Read-modify-write unit of AMO instructions placed next to the data memory
+module amo_alu (
+    input  wire [`AMO_OP_WIDTH-1:0] op_i,
+    input  wire              [31:0] mem_i,   // value read from the memory
+    input  wire              [31:0] src_i,   // rs2 of the AMO instruction
+    output wire              [31:0] rslt_o   // value written back to the memory
+);
+    wire signed [31:0] s_mem = mem_i;
+    wire signed [31:0] s_src = src_i;
+
+    wire lt_s = (s_mem < s_src);
+    wire lt_u = (mem_i < src_i);
+
+    assign rslt_o = (op_i == `AMO_OP_ADD ) ? mem_i + src_i :
+                    (op_i == `AMO_OP_SWAP) ? src_i :
+                    (op_i == `AMO_OP_XOR ) ? mem_i ^ src_i :
+                    (op_i == `AMO_OP_OR  ) ? mem_i | src_i :
+                    (op_i == `AMO_OP_AND ) ? mem_i & src_i :
+                    (op_i == `AMO_OP_MIN ) ? (lt_s ? mem_i : src_i) :
+                    (op_i == `AMO_OP_MAX ) ? (lt_s ? src_i : mem_i) :
+                    (op_i == `AMO_OP_MINU) ? (lt_u ? mem_i : src_i) :
+                    (op_i == `AMO_OP_MAXU) ? (lt_u ? src_i : mem_i) : mem_i;
+endmodule
+
+`resetall
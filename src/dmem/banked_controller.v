@@ -0,0 +1,320 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Data memory controller with word-interleaved banks
+// The low address bits select one of NBANKS single-port banks. Every bank has its own
+// round-robin arbiter, so cores accessing different banks are served in the same cycle.
+module banked_dmem_controller #(
+    parameter NCORES = `NCORES,
+    parameter DMEM_ADDRW = `DMEM_ADDRW,
+    parameter NBANKS = `DMEM_NBANKS
+) (
+    input wire clk_i,
+    input wire [NCORES-1:0] re_packed_i,
+    input wire [NCORES-1:0] we_packed_i,
+    input wire [DMEM_ADDRW*NCORES-1:0] addr_packed_i,
+    input wire [32*NCORES-1:0] wdata_packed_i,
+    input wire [4*NCORES-1:0] wstrb_packed_i,
+    input wire [NCORES-1:0] is_lr_packed_i,
+    input wire [NCORES-1:0] is_sc_packed_i,
+    input wire [NCORES-1:0] is_amo_packed_i,
+    input wire [`AMO_OP_WIDTH*NCORES-1:0] amo_op_packed_i,
+    output wire [32*NCORES-1:0] rdata_packed_o,
+    output wire [NCORES-1:0] stall_packed_o,
+    output wire [NCORES-1:0] rsv_valid_packed_o,  // LR/SC reservation of each core, for wrs
+    output wire [32*NBANKS-1:0] conflict_cnt_packed_o  // cycles in which a request waited for the bank
+);
+    genvar i;
+    integer j;
+    integer b;
+
+    localparam NCORES_W = (NCORES > 1) ? $clog2(NCORES) : 1;
+    localparam BANKW = (NBANKS > 1) ? $clog2(NBANKS) : 1;
+    localparam ROWW = $clog2(`DMEM_ENTRIES/NBANKS);
+
+    // Unpack input arrays
+    wire                     re    [0:NCORES-1];
+    wire                     we    [0:NCORES-1];
+    wire    [DMEM_ADDRW-1:0] addr  [0:NCORES-1];
+    wire              [31:0] wdata [0:NCORES-1];
+    wire               [3:0] wstrb [0:NCORES-1];
+    wire                     is_lr [0:NCORES-1];
+    wire                     is_sc [0:NCORES-1];
+    wire                     is_amo[0:NCORES-1];
+    wire [`AMO_OP_WIDTH-1:0] amo_op[0:NCORES-1];
+    reg               [31:0] rdata [0:NCORES-1];
+    reg                      stall_d[0:NCORES-1];
+    reg                      stall_q[0:NCORES-1];
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : unpack_arrays
+            assign re[i]     = re_packed_i[i];
+            assign we[i]     = we_packed_i[i];
+            assign addr[i]   = addr_packed_i[DMEM_ADDRW*(i+1)-1:DMEM_ADDRW*i];
+            assign wdata[i]  = wdata_packed_i[32*(i+1)-1:32*i];
+            assign wstrb[i]  = wstrb_packed_i[4*(i+1)-1:4*i];
+            assign is_lr[i]  = is_lr_packed_i[i];
+            assign is_sc[i]  = is_sc_packed_i[i];
+            assign is_amo[i] = is_amo_packed_i[i];
+            assign amo_op[i] = amo_op_packed_i[`AMO_OP_WIDTH*(i+1)-1:`AMO_OP_WIDTH*i];
+            assign rdata_packed_o[32*(i+1)-1:32*i] = rdata[i];
+            assign stall_packed_o[i] = stall_q[i];
+        end
+    endgenerate
+
+    // Pending request registers for each core (to hold request info when stalled)
+    reg                     req_valid_q [0:NCORES-1];
+    reg                     req_re_q    [0:NCORES-1];
+    reg                     req_we_q    [0:NCORES-1];
+    reg    [DMEM_ADDRW-1:0] req_addr_q  [0:NCORES-1];
+    reg              [31:0] req_wdata_q [0:NCORES-1];
+    reg               [3:0] req_wstrb_q [0:NCORES-1];
+    reg                     req_is_lr_q [0:NCORES-1];
+    reg                     req_is_sc_q [0:NCORES-1];
+    reg                     req_is_amo_q[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] req_amo_op_q[0:NCORES-1];
+
+    // Effective request signals (combining new input and pending requests)
+    reg                     eff_re    [0:NCORES-1];
+    reg                     eff_we    [0:NCORES-1];
+    reg    [DMEM_ADDRW-1:0] eff_addr  [0:NCORES-1];
+    reg              [31:0] eff_wdata [0:NCORES-1];
+    reg               [3:0] eff_wstrb [0:NCORES-1];
+    reg                     eff_is_lr [0:NCORES-1];
+    reg                     eff_is_sc [0:NCORES-1];
+    reg                     eff_is_amo[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] eff_amo_op[0:NCORES-1];
+    reg         [BANKW-1:0] eff_bank  [0:NCORES-1];
+
+    always @(*) begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            eff_re[j]     = req_valid_q[j] ? req_re_q[j]     : re[j];
+            eff_we[j]     = req_valid_q[j] ? req_we_q[j]     : we[j];
+            eff_addr[j]   = req_valid_q[j] ? req_addr_q[j]   : addr[j];
+            eff_wdata[j]  = req_valid_q[j] ? req_wdata_q[j]  : wdata[j];
+            eff_wstrb[j]  = req_valid_q[j] ? req_wstrb_q[j]  : wstrb[j];
+            eff_is_lr[j]  = req_valid_q[j] ? req_is_lr_q[j]  : is_lr[j];
+            eff_is_sc[j]  = req_valid_q[j] ? req_is_sc_q[j]  : is_sc[j];
+            eff_is_amo[j] = req_valid_q[j] ? req_is_amo_q[j] : is_amo[j];
+            eff_amo_op[j] = req_valid_q[j] ? req_amo_op_q[j] : amo_op[j];
+            eff_bank[j]   = (NBANKS > 1) ? eff_addr[j][BANKW-1:0] : 0;
+        end
+    end
+
+    // Per-bank round-robin arbitration
+    wire   [NCORES-1:0] bank_req     [0:NBANKS-1];  // cores requesting each bank
+    wire                bank_req_any [0:NBANKS-1];
+    wire [NCORES_W-1:0] bank_sel     [0:NBANKS-1];  // selected core of each bank
+    reg  [NCORES_W-1:0] rr_ptr_q     [0:NBANKS-1];
+
+    // AMO write-back: the old value is read in the cycle the AMO is served and the new value
+    // is written in the next cycle, during which the bank does not accept another request
+    reg                     amo_wb_q  [0:NBANKS-1];
+    reg          [ROWW-1:0] amo_row_q [0:NBANKS-1];
+    reg              [31:0] amo_src_q [0:NBANKS-1];
+    reg [`AMO_OP_WIDTH-1:0] amo_op_q  [0:NBANKS-1];
+    wire             [31:0] amo_rslt  [0:NBANKS-1];
+
+    wire bank_valid[0:NBANKS-1];  // the bank serves bank_sel this cycle
+    wire bank_wait [0:NBANKS-1];  // a request to the bank is not served this cycle
+
+    // Bank memory interface
+    reg             bank_re   [0:NBANKS-1];
+    reg             bank_we   [0:NBANKS-1];
+    reg  [ROWW-1:0] bank_row  [0:NBANKS-1];
+    reg      [31:0] bank_wdata[0:NBANKS-1];
+    reg       [3:0] bank_wstrb[0:NBANKS-1];
+    wire     [31:0] bank_rdata[0:NBANKS-1];
+
+    // Per-bank conflict counters
+    reg [31:0] conflict_cnt_q[0:NBANKS-1];
+
+    genvar g;
+    generate
+        for (g = 0; g < NBANKS; g = g + 1) begin : gen_bank
+            for (i = 0; i < NCORES; i = i + 1) begin : gen_bank_req
+                assign bank_req[g][i] = (eff_re[i] || eff_we[i]) && (eff_bank[i] == g);
+            end
+
+            single_issue_arbiter #(
+                .NCORES(NCORES)
+            ) arbiter (
+                .rr_ptr_i   (rr_ptr_q[g]),
+                .req_valid_i(bank_req[g]),
+                .valid_o    (bank_req_any[g]),
+                .selector_o (bank_sel[g])
+            );
+
+            assign bank_valid[g] = bank_req_any[g] && !amo_wb_q[g];
+
+            wire [NCORES-1:0] bank_gnt = (bank_valid[g]) ? ({{(NCORES-1){1'b0}}, 1'b1} << bank_sel[g]) : 0;
+            assign bank_wait[g] = |(bank_req[g] & ~bank_gnt);
+
+            amo_alu amo_alu (
+                .op_i  (amo_op_q[g]),     // input  wire [`AMO_OP_WIDTH-1:0]
+                .mem_i (bank_rdata[g]),   // input  wire [31:0]
+                .src_i (amo_src_q[g]),    // input  wire [31:0]
+                .rslt_o(amo_rslt[g])      // output wire [31:0]
+            );
+
+            m_dmem_bank #(
+                .NBANKS(NBANKS),
+                .BANK  (g),
+                .ROWW  (ROWW)
+            ) bank (
+                .clk_i  (clk_i),           // input  wire
+                .re_i   (bank_re[g]),      // input  wire
+                .we_i   (bank_we[g]),      // input  wire
+                .addr_i (bank_row[g]),     // input  wire [ROWW-1:0]
+                .wdata_i(bank_wdata[g]),   // input  wire [31:0]
+                .wstrb_i(bank_wstrb[g]),   // input  wire [3:0]
+                .rdata_o(bank_rdata[g])    // output wire [31:0]
+            );
+
+            assign conflict_cnt_packed_o[32*(g+1)-1:32*g] = conflict_cnt_q[g];
+
+            initial begin
+                rr_ptr_q[g]       = 0;
+                amo_wb_q[g]       = 1'b0;
+                conflict_cnt_q[g] = 0;
+            end
+        end
+    endgenerate
+
+    // LR/SC reservation registers for each core
+    reg                  reservation_valid_q [0:NCORES-1];
+    reg [DMEM_ADDRW-1:0] reservation_addr_q  [0:NCORES-1];
+    reg                  reservation_valid_d [0:NCORES-1];
+    reg [DMEM_ADDRW-1:0] reservation_addr_d  [0:NCORES-1];
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : pack_rsv_valid
+            assign rsv_valid_packed_o[i] = reservation_valid_q[i];
+        end
+    endgenerate
+
+    // Return path
+    reg             served    [0:NCORES-1];
+    reg             ret_valid_q[0:NCORES-1];
+    reg [BANKW-1:0] ret_bank_q [0:NCORES-1];
+    reg             ret_is_sc_q[0:NCORES-1];
+    reg             sc_success_q[0:NCORES-1];
+    reg             sc_success_d[0:NCORES-1];
+
+    reg [NCORES_W-1:0] c;
+
+    always @(*) begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            served[j]              = bank_valid[eff_bank[j]] && (bank_sel[eff_bank[j]] == j);
+            stall_d[j]             = (eff_re[j] || eff_we[j]) && !served[j];
+            sc_success_d[j]        = 1'b0;
+            reservation_valid_d[j] = reservation_valid_q[j];
+            reservation_addr_d[j]  = reservation_addr_q[j];
+        end
+
+        for (b = 0; b < NBANKS; b = b + 1) begin
+            c             = bank_sel[b];
+            bank_re[b]    = 1'b0;
+            bank_we[b]    = 1'b0;
+            bank_row[b]   = eff_addr[c][DMEM_ADDRW-1:DMEM_ADDRW-ROWW];
+            bank_wdata[b] = eff_wdata[c];
+            bank_wstrb[b] = eff_wstrb[c];
+
+            if (amo_wb_q[b]) begin
+                bank_we[b]    = 1'b1;
+                bank_row[b]   = amo_row_q[b];
+                bank_wdata[b] = amo_rslt[b];
+                bank_wstrb[b] = 4'hf;
+            end else if (bank_valid[b]) begin
+                if (eff_re[c]) begin
+                    bank_re[b] = 1'b1;
+                end else if (eff_is_sc[c]) begin
+                    // SC succeeds if reservation is valid and address matches
+                    sc_success_d[c] = reservation_valid_q[c] && (reservation_addr_q[c] == eff_addr[c]);
+                    bank_we[b]      = sc_success_d[c];
+                end else if (eff_is_amo[c]) begin
+                    bank_re[b] = 1'b1;
+                end else begin
+                    bank_we[b] = 1'b1;
+                end
+
+                // Stores, successful SCs and AMOs invalidate reservations for this address
+                if (eff_we[c] && (!eff_is_sc[c] || sc_success_d[c])) begin
+                    for (j = 0; j < NCORES; j = j + 1) begin
+                        if (reservation_valid_q[j] && reservation_addr_q[j] == eff_addr[c]) begin
+                            reservation_valid_d[j] = 1'b0;
+                        end
+                    end
+                end
+            end
+        end
+
+        // LR is applied after the invalidations so that a reservation made in this cycle stays
+        for (b = 0; b < NBANKS; b = b + 1) begin
+            c = bank_sel[b];
+            if (!amo_wb_q[b] && bank_valid[b] && eff_re[c] && eff_is_lr[c]) begin
+                reservation_valid_d[c] = 1'b1;
+                reservation_addr_d[c]  = eff_addr[c];
+            end
+        end
+
+        // Output read data
+        for (j = 0; j < NCORES; j = j + 1) begin
+            rdata[j] = (!ret_valid_q[j]) ? 32'h0 :
+                       (ret_is_sc_q[j]) ? {31'b0, !sc_success_q[j]} : bank_rdata[ret_bank_q[j]];
+        end
+    end
+
+    always @(posedge clk_i) begin
+        for (b = 0; b < NBANKS; b = b + 1) begin
+            amo_wb_q[b] <= !amo_wb_q[b] && bank_valid[b] && eff_is_amo[bank_sel[b]];
+            if (bank_valid[b]) begin
+                rr_ptr_q[b]  <= (bank_sel[b] + 1) % NCORES;
+                amo_row_q[b] <= eff_addr[bank_sel[b]][DMEM_ADDRW-1:DMEM_ADDRW-ROWW];
+                amo_src_q[b] <= eff_wdata[bank_sel[b]];
+                amo_op_q[b]  <= eff_amo_op[bank_sel[b]];
+            end
+            if (bank_wait[b]) begin
+                conflict_cnt_q[b] <= conflict_cnt_q[b] + 1;
+            end
+        end
+
+        for (j = 0; j < NCORES; j = j + 1) begin
+            stall_q[j]             <= stall_d[j];
+            ret_valid_q[j]         <= served[j];
+            ret_bank_q[j]          <= eff_bank[j];
+            ret_is_sc_q[j]         <= served[j] && eff_is_sc[j];
+            sc_success_q[j]        <= sc_success_d[j];
+            reservation_valid_q[j] <= reservation_valid_d[j];
+            reservation_addr_q[j]  <= reservation_addr_d[j];
+
+            // Save request if stalled and not already pending
+            if (stall_d[j] && !req_valid_q[j]) begin
+                req_valid_q[j]  <= 1'b1;
+                req_re_q[j]     <= re[j];
+                req_we_q[j]     <= we[j];
+                req_addr_q[j]   <= addr[j];
+                req_wdata_q[j]  <= wdata[j];
+                req_wstrb_q[j]  <= wstrb[j];
+                req_is_lr_q[j]  <= is_lr[j];
+                req_is_sc_q[j]  <= is_sc[j];
+                req_is_amo_q[j] <= is_amo[j];
+                req_amo_op_q[j] <= amo_op[j];
+            end else if (served[j]) begin
+                req_valid_q[j] <= 1'b0;
+            end
+        end
+    end
+
+    initial begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            req_valid_q[j]         = 1'b0;
+            reservation_valid_q[j] = 1'b0;
+            ret_valid_q[j]         = 1'b0;
+        end
+    end
+endmodule
+
+`resetall
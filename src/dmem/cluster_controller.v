@@ -0,0 +1,502 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Cluster-local shared memory controller
+// The cores of a cluster share one single-port memory with round-robin arbitration.
+// LR/SC reservations are kept per core of the cluster. The memory is not initialized.
+module cluster_dmem_controller #(
+    parameter NCORES = `CLUSTER_SIZE,
+    parameter CMEM_ADDRW = `CMEM_ADDRW,
+    parameter CMEM_ENTRIES = `CMEM_ENTRIES
+) (
+    input wire clk_i,
+    input wire [NCORES-1:0] re_packed_i,
+    input wire [NCORES-1:0] we_packed_i,
+    input wire [CMEM_ADDRW*NCORES-1:0] addr_packed_i,
+    input wire [32*NCORES-1:0] wdata_packed_i,
+    input wire [4*NCORES-1:0] wstrb_packed_i,
+    input wire [NCORES-1:0] is_lr_packed_i,
+    input wire [NCORES-1:0] is_sc_packed_i,
+    input wire [NCORES-1:0] is_amo_packed_i,
+    input wire [`AMO_OP_WIDTH*NCORES-1:0] amo_op_packed_i,
+    output wire [32*NCORES-1:0] rdata_packed_o,
+    output wire [NCORES-1:0] stall_packed_o,
+    output wire [NCORES-1:0] rsv_valid_packed_o  // LR/SC reservation of each core, for wrs
+);
+    genvar i;
+    integer j;
+
+    localparam NCORES_W = (NCORES > 1) ? $clog2(NCORES) : 1;
+
+    // Unpack input arrays
+    wire                     re    [0:NCORES-1];
+    wire                     we    [0:NCORES-1];
+    wire    [CMEM_ADDRW-1:0] addr  [0:NCORES-1];
+    wire              [31:0] wdata [0:NCORES-1];
+    wire               [3:0] wstrb [0:NCORES-1];
+    wire                     is_lr [0:NCORES-1];
+    wire                     is_sc [0:NCORES-1];
+    wire                     is_amo[0:NCORES-1];
+    wire [`AMO_OP_WIDTH-1:0] amo_op[0:NCORES-1];
+    reg               [31:0] rdata [0:NCORES-1];
+    reg                      stall_d[0:NCORES-1];
+    reg                      stall_q[0:NCORES-1];
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : unpack_arrays
+            assign re[i]     = re_packed_i[i];
+            assign we[i]     = we_packed_i[i];
+            assign addr[i]   = addr_packed_i[CMEM_ADDRW*(i+1)-1:CMEM_ADDRW*i];
+            assign wdata[i]  = wdata_packed_i[32*(i+1)-1:32*i];
+            assign wstrb[i]  = wstrb_packed_i[4*(i+1)-1:4*i];
+            assign is_lr[i]  = is_lr_packed_i[i];
+            assign is_sc[i]  = is_sc_packed_i[i];
+            assign is_amo[i] = is_amo_packed_i[i];
+            assign amo_op[i] = amo_op_packed_i[`AMO_OP_WIDTH*(i+1)-1:`AMO_OP_WIDTH*i];
+            assign rdata_packed_o[32*(i+1)-1:32*i] = rdata[i];
+            assign stall_packed_o[i] = stall_q[i];
+        end
+    endgenerate
+
+    // Pending request registers for each core (to hold request info when stalled)
+    reg                     req_valid_q [0:NCORES-1];
+    reg                     req_re_q    [0:NCORES-1];
+    reg                     req_we_q    [0:NCORES-1];
+    reg    [CMEM_ADDRW-1:0] req_addr_q  [0:NCORES-1];
+    reg              [31:0] req_wdata_q [0:NCORES-1];
+    reg               [3:0] req_wstrb_q [0:NCORES-1];
+    reg                     req_is_lr_q [0:NCORES-1];
+    reg                     req_is_sc_q [0:NCORES-1];
+    reg                     req_is_amo_q[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] req_amo_op_q[0:NCORES-1];
+
+    // Effective request signals (combining new input and pending requests)
+    reg                     eff_re    [0:NCORES-1];
+    reg                     eff_we    [0:NCORES-1];
+    reg    [CMEM_ADDRW-1:0] eff_addr  [0:NCORES-1];
+    reg              [31:0] eff_wdata [0:NCORES-1];
+    reg               [3:0] eff_wstrb [0:NCORES-1];
+    reg                     eff_is_lr [0:NCORES-1];
+    reg                     eff_is_sc [0:NCORES-1];
+    reg                     eff_is_amo[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] eff_amo_op[0:NCORES-1];
+    wire       [NCORES-1:0] eff_req;
+
+    always @(*) begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            eff_re[j]     = req_valid_q[j] ? req_re_q[j]     : re[j];
+            eff_we[j]     = req_valid_q[j] ? req_we_q[j]     : we[j];
+            eff_addr[j]   = req_valid_q[j] ? req_addr_q[j]   : addr[j];
+            eff_wdata[j]  = req_valid_q[j] ? req_wdata_q[j]  : wdata[j];
+            eff_wstrb[j]  = req_valid_q[j] ? req_wstrb_q[j]  : wstrb[j];
+            eff_is_lr[j]  = req_valid_q[j] ? req_is_lr_q[j]  : is_lr[j];
+            eff_is_sc[j]  = req_valid_q[j] ? req_is_sc_q[j]  : is_sc[j];
+            eff_is_amo[j] = req_valid_q[j] ? req_is_amo_q[j] : is_amo[j];
+            eff_amo_op[j] = req_valid_q[j] ? req_amo_op_q[j] : amo_op[j];
+        end
+    end
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : gen_eff_req
+            assign eff_req[i] = eff_re[i] || eff_we[i];
+        end
+    endgenerate
+
+    // Round-robin arbitration
+    wire                req_any;
+    wire [NCORES_W-1:0] sel;
+    reg  [NCORES_W-1:0] rr_ptr_q = 0;
+
+    single_issue_arbiter #(
+        .NCORES(NCORES)
+    ) arbiter (
+        .rr_ptr_i   (rr_ptr_q),
+        .req_valid_i(eff_req),
+        .valid_o    (req_any),
+        .selector_o (sel)
+    );
+
+    // AMO write-back: the old value is read in the cycle the AMO is served and the new value
+    // is written in the next cycle, during which the memory does not accept another request
+    reg                     amo_wb_q = 1'b0;
+    reg    [CMEM_ADDRW-1:0] amo_addr_q;
+    reg              [31:0] amo_src_q;
+    reg [`AMO_OP_WIDTH-1:0] amo_op_q;
+    wire             [31:0] amo_rslt;
+
+    wire valid = req_any && !amo_wb_q;
+
+    // LR/SC reservation registers for each core
+    reg                  reservation_valid_q [0:NCORES-1];
+    reg [CMEM_ADDRW-1:0] reservation_addr_q  [0:NCORES-1];
+    reg                  reservation_valid_d [0:NCORES-1];
+    reg [CMEM_ADDRW-1:0] reservation_addr_d  [0:NCORES-1];
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : pack_rsv_valid
+            assign rsv_valid_packed_o[i] = reservation_valid_q[i];
+        end
+    endgenerate
+
+    // Memory interface
+    reg                  mem_re;
+    reg                  mem_we;
+    reg [CMEM_ADDRW-1:0] mem_addr;
+    reg           [31:0] mem_wdata;
+    reg            [3:0] mem_wstrb;
+    wire          [31:0] mem_rdata;
+    reg                  sc_success;
+
+    // Return path
+    reg                ret_valid_q = 1'b0;
+    reg [NCORES_W-1:0] ret_core_q;
+    reg                ret_is_sc_q;
+    reg                sc_success_q;
+
+    always @(*) begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            stall_d[j]             = eff_req[j] && !(valid && sel == j);
+            reservation_valid_d[j] = reservation_valid_q[j];
+            reservation_addr_d[j]  = reservation_addr_q[j];
+        end
+
+        mem_re     = 1'b0;
+        mem_we     = 1'b0;
+        mem_addr   = eff_addr[sel];
+        mem_wdata  = eff_wdata[sel];
+        mem_wstrb  = eff_wstrb[sel];
+        sc_success = 1'b0;
+
+        if (amo_wb_q) begin
+            mem_we    = 1'b1;
+            mem_addr  = amo_addr_q;
+            mem_wdata = amo_rslt;
+            mem_wstrb = 4'hf;
+        end else if (valid) begin
+            if (eff_re[sel]) begin
+                mem_re = 1'b1;
+                if (eff_is_lr[sel]) begin
+                    reservation_valid_d[sel] = 1'b1;
+                    reservation_addr_d[sel]  = eff_addr[sel];
+                end
+            end else if (eff_is_sc[sel]) begin
+                // SC succeeds if reservation is valid and address matches
+                sc_success = reservation_valid_q[sel] && (reservation_addr_q[sel] == eff_addr[sel]);
+                mem_we     = sc_success;
+            end else if (eff_is_amo[sel]) begin
+                mem_re = 1'b1;
+            end else begin
+                mem_we = 1'b1;
+            end
+
+            // Stores, successful SCs and AMOs invalidate reservations for this address
+            if (eff_we[sel] && (!eff_is_sc[sel] || sc_success)) begin
+                for (j = 0; j < NCORES; j = j + 1) begin
+                    if (reservation_valid_q[j] && reservation_addr_q[j] == eff_addr[sel]) begin
+                        reservation_valid_d[j] = 1'b0;
+                    end
+                end
+            end
+        end
+
+        // Output read data
+        for (j = 0; j < NCORES; j = j + 1) begin
+            rdata[j] = (!ret_valid_q || ret_core_q != j) ? 32'h0 :
+                       (ret_is_sc_q) ? {31'b0, !sc_success_q} : mem_rdata;
+        end
+    end
+
+    always @(posedge clk_i) begin
+        amo_wb_q     <= valid && eff_is_amo[sel];
+        ret_valid_q  <= valid;
+        ret_core_q   <= sel;
+        ret_is_sc_q  <= eff_is_sc[sel];
+        sc_success_q <= sc_success;
+        if (valid) begin
+            rr_ptr_q   <= (sel + 1) % NCORES;
+            amo_addr_q <= eff_addr[sel];
+            amo_src_q  <= eff_wdata[sel];
+            amo_op_q   <= eff_amo_op[sel];
+        end
+
+        for (j = 0; j < NCORES; j = j + 1) begin
+            stall_q[j]             <= stall_d[j];
+            reservation_valid_q[j] <= reservation_valid_d[j];
+            reservation_addr_q[j]  <= reservation_addr_d[j];
+
+            // Save request if stalled and not already pending
+            if (stall_d[j] && !req_valid_q[j]) begin
+                req_valid_q[j]  <= 1'b1;
+                req_re_q[j]     <= re[j];
+                req_we_q[j]     <= we[j];
+                req_addr_q[j]   <= addr[j];
+                req_wdata_q[j]  <= wdata[j];
+                req_wstrb_q[j]  <= wstrb[j];
+                req_is_lr_q[j]  <= is_lr[j];
+                req_is_sc_q[j]  <= is_sc[j];
+                req_is_amo_q[j] <= is_amo[j];
+                req_amo_op_q[j] <= amo_op[j];
+            end else if (!stall_d[j]) begin
+                req_valid_q[j] <= 1'b0;
+            end
+        end
+    end
+
+    amo_alu amo_alu (
+        .op_i  (amo_op_q),   // input  wire [`AMO_OP_WIDTH-1:0]
+        .mem_i (mem_rdata),  // input  wire [31:0]
+        .src_i (amo_src_q),  // input  wire [31:0]
+        .rslt_o(amo_rslt)    // output wire [31:0]
+    );
+
+    stack_dmem #(
+        .STACK_ADDRW  (CMEM_ADDRW),
+        .STACK_ENTRIES(CMEM_ENTRIES)
+    ) cmem (
+        .clk_i   (clk_i),      // input  wire
+        .re_i    (mem_re),     // input  wire
+        .we_i    (mem_we),     // input  wire
+        .addr_i  (mem_addr),   // input  wire [CMEM_ADDRW-1:0]
+        .wdata_i (mem_wdata),  // input  wire [31:0]
+        .wstrb_i (mem_wstrb),  // input  wire [3:0]
+        .rdata_o (mem_rdata)   // output wire [31:0]
+    );
+
+    initial begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            req_valid_q[j]         = 1'b0;
+            reservation_valid_q[j] = 1'b0;
+            stall_q[j]             = 1'b0;
+        end
+    end
+endmodule
+
+`resetall
+
+`default_nettype none
+
+// Second-level port of a cluster to the global data memory controller
+// One request of the cluster is forwarded at a time, and the global controller sees each
+// cluster as a single core. The global controller keeps one LR/SC reservation per cluster,
+// so the bridge records which core of the cluster made it. An SC from another core of the
+// cluster fails here without reaching the global memory.
+module cluster_bridge #(
+    parameter NCORES = `CLUSTER_SIZE,
+    parameter DMEM_ADDRW = `DMEM_ADDRW
+) (
+    input wire clk_i,
+    // cores of the cluster
+    input wire [NCORES-1:0] re_packed_i,
+    input wire [NCORES-1:0] we_packed_i,
+    input wire [DMEM_ADDRW*NCORES-1:0] addr_packed_i,
+    input wire [32*NCORES-1:0] wdata_packed_i,
+    input wire [4*NCORES-1:0] wstrb_packed_i,
+    input wire [NCORES-1:0] is_lr_packed_i,
+    input wire [NCORES-1:0] is_sc_packed_i,
+    input wire [NCORES-1:0] is_amo_packed_i,
+    input wire [`AMO_OP_WIDTH*NCORES-1:0] amo_op_packed_i,
+    output wire [32*NCORES-1:0] rdata_packed_o,
+    output wire [NCORES-1:0] stall_packed_o,
+    output wire [NCORES-1:0] rsv_valid_packed_o,  // LR/SC reservation of each core, for wrs
+    // global data memory controller
+    output wire                     g_re_o,
+    output wire                     g_we_o,
+    output wire    [DMEM_ADDRW-1:0] g_addr_o,
+    output wire              [31:0] g_wdata_o,
+    output wire               [3:0] g_wstrb_o,
+    output wire                     g_is_lr_o,
+    output wire                     g_is_sc_o,
+    output wire                     g_is_amo_o,
+    output wire [`AMO_OP_WIDTH-1:0] g_amo_op_o,
+    input  wire              [31:0] g_rdata_i,
+    input  wire                     g_stall_i,
+    input  wire                     g_rsv_valid_i
+);
+    genvar i;
+    integer j;
+
+    localparam NCORES_W = (NCORES > 1) ? $clog2(NCORES) : 1;
+
+    // Unpack input arrays
+    wire                     re    [0:NCORES-1];
+    wire                     we    [0:NCORES-1];
+    wire    [DMEM_ADDRW-1:0] addr  [0:NCORES-1];
+    wire              [31:0] wdata [0:NCORES-1];
+    wire               [3:0] wstrb [0:NCORES-1];
+    wire                     is_lr [0:NCORES-1];
+    wire                     is_sc [0:NCORES-1];
+    wire                     is_amo[0:NCORES-1];
+    wire [`AMO_OP_WIDTH-1:0] amo_op[0:NCORES-1];
+    reg               [31:0] rdata [0:NCORES-1];
+    reg                      stall_d[0:NCORES-1];
+    reg                      stall_q[0:NCORES-1];
+
+    // The core whose request is in the global controller
+    reg                busy_q = 1'b0;
+    reg [NCORES_W-1:0] owner_q = 0;
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : unpack_arrays
+            assign re[i]     = re_packed_i[i];
+            assign we[i]     = we_packed_i[i];
+            assign addr[i]   = addr_packed_i[DMEM_ADDRW*(i+1)-1:DMEM_ADDRW*i];
+            assign wdata[i]  = wdata_packed_i[32*(i+1)-1:32*i];
+            assign wstrb[i]  = wstrb_packed_i[4*(i+1)-1:4*i];
+            assign is_lr[i]  = is_lr_packed_i[i];
+            assign is_sc[i]  = is_sc_packed_i[i];
+            assign is_amo[i] = is_amo_packed_i[i];
+            assign amo_op[i] = amo_op_packed_i[`AMO_OP_WIDTH*(i+1)-1:`AMO_OP_WIDTH*i];
+            assign rdata_packed_o[32*(i+1)-1:32*i] = rdata[i];
+            // the owner follows the stall of the global controller
+            assign stall_packed_o[i] = stall_q[i] || (busy_q && owner_q == i && g_stall_i);
+        end
+    endgenerate
+
+    // Pending request registers for each core (to hold request info when stalled)
+    reg                     req_valid_q [0:NCORES-1];
+    reg                     req_re_q    [0:NCORES-1];
+    reg                     req_we_q    [0:NCORES-1];
+    reg    [DMEM_ADDRW-1:0] req_addr_q  [0:NCORES-1];
+    reg              [31:0] req_wdata_q [0:NCORES-1];
+    reg               [3:0] req_wstrb_q [0:NCORES-1];
+    reg                     req_is_lr_q [0:NCORES-1];
+    reg                     req_is_sc_q [0:NCORES-1];
+    reg                     req_is_amo_q[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] req_amo_op_q[0:NCORES-1];
+
+    // Effective request signals (combining new input and pending requests)
+    reg                     eff_re    [0:NCORES-1];
+    reg                     eff_we    [0:NCORES-1];
+    reg    [DMEM_ADDRW-1:0] eff_addr  [0:NCORES-1];
+    reg              [31:0] eff_wdata [0:NCORES-1];
+    reg               [3:0] eff_wstrb [0:NCORES-1];
+    reg                     eff_is_lr [0:NCORES-1];
+    reg                     eff_is_sc [0:NCORES-1];
+    reg                     eff_is_amo[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] eff_amo_op[0:NCORES-1];
+    wire       [NCORES-1:0] eff_req;
+
+    always @(*) begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            eff_re[j]     = req_valid_q[j] ? req_re_q[j]     : re[j];
+            eff_we[j]     = req_valid_q[j] ? req_we_q[j]     : we[j];
+            eff_addr[j]   = req_valid_q[j] ? req_addr_q[j]   : addr[j];
+            eff_wdata[j]  = req_valid_q[j] ? req_wdata_q[j]  : wdata[j];
+            eff_wstrb[j]  = req_valid_q[j] ? req_wstrb_q[j]  : wstrb[j];
+            eff_is_lr[j]  = req_valid_q[j] ? req_is_lr_q[j]  : is_lr[j];
+            eff_is_sc[j]  = req_valid_q[j] ? req_is_sc_q[j]  : is_sc[j];
+            eff_is_amo[j] = req_valid_q[j] ? req_is_amo_q[j] : is_amo[j];
+            eff_amo_op[j] = req_valid_q[j] ? req_amo_op_q[j] : amo_op[j];
+        end
+    end
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : gen_eff_req
+            assign eff_req[i] = eff_re[i] || eff_we[i];
+        end
+    endgenerate
+
+    // Round-robin arbitration of the global port
+    wire                req_any;
+    wire [NCORES_W-1:0] sel;
+    reg  [NCORES_W-1:0] rr_ptr_q = 0;
+
+    single_issue_arbiter #(
+        .NCORES(NCORES)
+    ) arbiter (
+        .rr_ptr_i   (rr_ptr_q),
+        .req_valid_i(eff_req),
+        .valid_o    (req_any),
+        .selector_o (sel)
+    );
+
+    // The core of the cluster holding the reservation in the global controller
+    reg                rsv_valid_q = 1'b0;
+    reg [NCORES_W-1:0] rsv_core_q;
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : pack_rsv_valid
+            assign rsv_valid_packed_o[i] = g_rsv_valid_i && rsv_valid_q && (rsv_core_q == i);
+        end
+    endgenerate
+
+    // The global controller accepts a new request in the cycle the previous one completes
+    wire port_free     = !(busy_q && g_stall_i);
+    wire valid         = req_any && port_free;
+    wire sc_local_fail = eff_is_sc[sel] && !(rsv_valid_q && rsv_core_q == sel);
+    wire issue         = valid && !sc_local_fail;
+
+    reg sc_fail_q[0:NCORES-1];
+
+    assign g_re_o     = issue && eff_re[sel];
+    assign g_we_o     = issue && eff_we[sel];
+    assign g_addr_o   = eff_addr[sel];
+    assign g_wdata_o  = eff_wdata[sel];
+    assign g_wstrb_o  = eff_wstrb[sel];
+    assign g_is_lr_o  = issue && eff_is_lr[sel];
+    assign g_is_sc_o  = issue && eff_is_sc[sel];
+    assign g_is_amo_o = issue && eff_is_amo[sel];
+    assign g_amo_op_o = eff_amo_op[sel];
+
+    always @(*) begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            stall_d[j] = eff_req[j] && !(valid && sel == j);
+            rdata[j]   = (busy_q && owner_q == j) ? g_rdata_i :
+                         (sc_fail_q[j]) ? 32'h1 : 32'h0;
+        end
+    end
+
+    always @(posedge clk_i) begin
+        if (issue) begin
+            busy_q  <= 1'b1;
+            owner_q <= sel;
+        end else if (port_free) begin
+            busy_q  <= 1'b0;
+        end
+
+        if (valid) begin
+            rr_ptr_q <= (sel + 1) % NCORES;
+        end
+
+        // An LR takes the reservation, an SC of the reservation owner consumes it
+        if (issue && eff_is_lr[sel]) begin
+            rsv_valid_q <= 1'b1;
+            rsv_core_q  <= sel;
+        end else if (issue && eff_is_sc[sel]) begin
+            rsv_valid_q <= 1'b0;
+        end
+
+        for (j = 0; j < NCORES; j = j + 1) begin
+            stall_q[j]   <= stall_d[j];
+            sc_fail_q[j] <= valid && sc_local_fail && sel == j;
+
+            // Save request if stalled and not already pending
+            if (stall_d[j] && !req_valid_q[j]) begin
+                req_valid_q[j]  <= 1'b1;
+                req_re_q[j]     <= re[j];
+                req_we_q[j]     <= we[j];
+                req_addr_q[j]   <= addr[j];
+                req_wdata_q[j]  <= wdata[j];
+                req_wstrb_q[j]  <= wstrb[j];
+                req_is_lr_q[j]  <= is_lr[j];
+                req_is_sc_q[j]  <= is_sc[j];
+                req_is_amo_q[j] <= is_amo[j];
+                req_amo_op_q[j] <= amo_op[j];
+            end else if (!stall_d[j]) begin
+                req_valid_q[j] <= 1'b0;
+            end
+        end
+    end
+
+    initial begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            req_valid_q[j] = 1'b0;
+            stall_q[j]     = 1'b0;
+            sc_fail_q[j]   = 1'b0;
+        end
+    end
+endmodule
+
+`resetall
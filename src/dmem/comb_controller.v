@@ -13,8 +13,11 @@ module comb_dmem_controller #(
     input wire [4*NCORES-1:0] wstrb_packed_i,
     input wire [NCORES-1:0] is_lr_packed_i,
     input wire [NCORES-1:0] is_sc_packed_i,
+    input wire [NCORES-1:0] is_amo_packed_i,
+    input wire [`AMO_OP_WIDTH*NCORES-1:0] amo_op_packed_i,
     output wire [32*NCORES-1:0] rdata_packed_o,
-    output wire [NCORES-1:0] stall_packed_o
+    output wire [NCORES-1:0] stall_packed_o,
+    output wire [NCORES-1:0] rsv_valid_packed_o  // LR/SC reservation of each core, for wrs
 );
     genvar i;
     integer j;
@@ -33,6 +36,8 @@ module comb_dmem_controller #(
     wire [3:0]            wstrb[0:NCORES-1];
     wire                  is_lr[0:NCORES-1];
     wire                  is_sc[0:NCORES-1];
+    wire                  is_amo[0:NCORES-1];
+    wire [`AMO_OP_WIDTH-1:0] amo_op[0:NCORES-1];
     reg  [31:0]           rdata[0:NCORES-1];
     reg                   stall_d[0:NCORES-1];
     reg                   stall_q[0:NCORES-1];
@@ -46,6 +51,8 @@ module comb_dmem_controller #(
             assign wstrb[i] = wstrb_packed_i[4*(i+1)-1:4*i];
             assign is_lr[i] = is_lr_packed_i[i];
             assign is_sc[i] = is_sc_packed_i[i];
+            assign is_amo[i] = is_amo_packed_i[i];
+            assign amo_op[i] = amo_op_packed_i[`AMO_OP_WIDTH*(i+1)-1:`AMO_OP_WIDTH*i];
             assign rdata_packed_o[32*(i+1)-1:32*i] = rdata[i];
             assign stall_packed_o[i] = stall_q[i];
         end
@@ -60,6 +67,8 @@ module comb_dmem_controller #(
     reg [3:0]            req_wstrb_q [0:NCORES-1];
     reg                  req_is_lr_q [0:NCORES-1];
     reg                  req_is_sc_q [0:NCORES-1];
+    reg                  req_is_amo_q[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] req_amo_op_q[0:NCORES-1];
 
     reg                  req_valid_d [0:NCORES-1];
     reg                  req_re_d    [0:NCORES-1];
@@ -69,6 +78,8 @@ module comb_dmem_controller #(
     reg [3:0]            req_wstrb_d [0:NCORES-1];
     reg                  req_is_lr_d [0:NCORES-1];
     reg                  req_is_sc_d [0:NCORES-1];
+    reg                  req_is_amo_d[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] req_amo_op_d[0:NCORES-1];
 
     // Effective request signals (combining new input and pending requests)
     reg                  eff_re   [0:NCORES-1];
@@ -78,6 +89,21 @@ module comb_dmem_controller #(
     reg [3:0]            eff_wstrb[0:NCORES-1];
     reg                  eff_is_lr[0:NCORES-1];
     reg                  eff_is_sc[0:NCORES-1];
+    reg                  eff_is_amo[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] eff_amo_op[0:NCORES-1];
+
+    // AMO write-back: the old value is read in the cycle the AMO is served and the new value
+    // is written in the next cycle, during which the port does not accept another request
+    reg                     amo_wb_a_q = 1'b0;
+    reg                     amo_wb_b_q = 1'b0;
+    reg    [DMEM_ADDRW-1:0] amo_addr_a_q;
+    reg    [DMEM_ADDRW-1:0] amo_addr_b_q;
+    reg              [31:0] amo_src_a_q;
+    reg              [31:0] amo_src_b_q;
+    reg [`AMO_OP_WIDTH-1:0] amo_op_a_q;
+    reg [`AMO_OP_WIDTH-1:0] amo_op_b_q;
+    wire             [31:0] amo_rslt_a;
+    wire             [31:0] amo_rslt_b;
 
     // Round-robin pointers for port A and B
     reg [NCORES_A_W-1:0] rr_ptr_a_q = 0;
@@ -112,6 +138,8 @@ module comb_dmem_controller #(
                 eff_wstrb[j] = req_wstrb_q[j];
                 eff_is_lr[j] = req_is_lr_q[j];
                 eff_is_sc[j] = req_is_sc_q[j];
+                eff_is_amo[j] = req_is_amo_q[j];
+                eff_amo_op[j] = req_amo_op_q[j];
             end else begin
                 // Use new input
                 eff_re[j]    = re[j];
@@ -121,6 +149,8 @@ module comb_dmem_controller #(
                 eff_wstrb[j] = wstrb[j];
                 eff_is_lr[j] = is_lr[j];
                 eff_is_sc[j] = is_sc[j];
+                eff_is_amo[j] = is_amo[j];
+                eff_amo_op[j] = amo_op[j];
             end
         end
 
@@ -144,6 +174,10 @@ module comb_dmem_controller #(
                 valid_a = 1'b1;
             end
         end
+        // Port A is busy with an AMO write-back, or port B is writing back an AMO to the same address
+        if (amo_wb_a_q || (amo_wb_b_q && amo_addr_b_q == addr_a[sel_a])) begin
+            valid_a = 1'b0;
+        end
 
         // Port B arbitration
         sel_b = 0;
@@ -158,6 +192,8 @@ module comb_dmem_controller #(
         // Invalidate port B if it conflicts with port A's address
         if (valid_a && valid_b_pre && (addr_a[sel_a] == addr_b[sel_b])) begin
             valid_b = 1'b0;
+        end else if (amo_wb_b_q || (amo_wb_a_q && amo_addr_a_q == addr_b[sel_b])) begin
+            valid_b = 1'b0;
         end else begin
             valid_b = valid_b_pre;
         end
@@ -170,6 +206,12 @@ module comb_dmem_controller #(
     reg                  reservation_valid_d [0:NCORES-1];
     reg [DMEM_ADDRW-1:0] reservation_addr_d  [0:NCORES-1];
 
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : pack_rsv_valid
+            assign rsv_valid_packed_o[i] = reservation_valid_q[i];
+        end
+    endgenerate
+
     // Memory interface signals
     reg                  rea_int;
     reg                  reb_int;
@@ -227,6 +269,24 @@ module comb_dmem_controller #(
             req_wstrb_d[j] = req_wstrb_q[j];
             req_is_lr_d[j] = req_is_lr_q[j];
             req_is_sc_d[j] = req_is_sc_q[j];
+            req_is_amo_d[j] = req_is_amo_q[j];
+            req_amo_op_d[j] = req_amo_op_q[j];
+        end
+
+        // AMO write-back
+        amo_wb_a_d = 1'b0;
+        amo_wb_b_d = 1'b0;
+        if (amo_wb_a_q) begin
+            wea_int = 1'b1;
+            addra_int = amo_addr_a_q;
+            wdataa_int = amo_rslt_a;
+            wstrba_int = 4'hf;
+        end
+        if (amo_wb_b_q) begin
+            web_int = 1'b1;
+            addrb_int = amo_addr_b_q;
+            wdatab_int = amo_rslt_b;
+            wstrbb_int = 4'hf;
         end
 
         // Port A access
@@ -258,6 +318,16 @@ module comb_dmem_controller #(
                             end
                         end
                     end
+                end else if (eff_is_amo[sel_a]) begin
+                    // AMO: read the old value now, write the new value in the next cycle
+                    rea_int = 1'b1;
+                    amo_wb_a_d = 1'b1;
+                    // Invalidate reservations for this address
+                    for (j = 0; j < NCORES; j = j + 1) begin
+                        if (reservation_valid_q[j] && reservation_addr_q[j] == eff_addr[sel_a]) begin
+                            reservation_valid_d[j] = 1'b0;
+                        end
+                    end
                 end else begin
                     // Regular store
                     wea_int = 1'b1;
@@ -304,6 +374,16 @@ module comb_dmem_controller #(
                             end
                         end
                     end
+                end else if (eff_is_amo[NCORES_A + sel_b]) begin
+                    // AMO: read the old value now, write the new value in the next cycle
+                    reb_int = 1'b1;
+                    amo_wb_b_d = 1'b1;
+                    // Invalidate reservations for this address
+                    for (j = 0; j < NCORES; j = j + 1) begin
+                        if (reservation_valid_q[j] && reservation_addr_q[j] == eff_addr[NCORES_A + sel_b]) begin
+                            reservation_valid_d[j] = 1'b0;
+                        end
+                    end
                 end else begin
                     // Regular store
                     web_int = 1'b1;
@@ -335,6 +415,8 @@ module comb_dmem_controller #(
                 req_wstrb_d[j] = wstrb[j];
                 req_is_lr_d[j] = is_lr[j];
                 req_is_sc_d[j] = is_sc[j];
+                req_is_amo_d[j] = is_amo[j];
+                req_amo_op_d[j] = amo_op[j];
             end
         end
         for (j = 0; j < NCORES_B; j = j + 1) begin
@@ -349,6 +431,8 @@ module comb_dmem_controller #(
                 req_wstrb_d[NCORES_A + j] = wstrb[NCORES_A + j];
                 req_is_lr_d[NCORES_A + j] = is_lr[NCORES_A + j];
                 req_is_sc_d[NCORES_A + j] = is_sc[NCORES_A + j];
+                req_is_amo_d[NCORES_A + j] = is_amo[NCORES_A + j];
+                req_amo_op_d[NCORES_A + j] = amo_op[NCORES_A + j];
             end
         end
 
@@ -387,6 +471,8 @@ module comb_dmem_controller #(
     reg ret_is_sc_b_d;
     reg sc_success_a_d;
     reg sc_success_b_d;
+    reg amo_wb_a_d;
+    reg amo_wb_b_d;
 
     always @(*) begin
         // Update round-robin pointers
@@ -422,6 +508,18 @@ module comb_dmem_controller #(
         ret_is_sc_b_q <= ret_is_sc_b_d;
         sc_success_a_q <= sc_success_a_d;
         sc_success_b_q <= sc_success_b_d;
+        amo_wb_a_q <= amo_wb_a_d;
+        amo_wb_b_q <= amo_wb_b_d;
+        if (valid_a) begin
+            amo_addr_a_q <= eff_addr[sel_a];
+            amo_src_a_q  <= eff_wdata[sel_a];
+            amo_op_a_q   <= eff_amo_op[sel_a];
+        end
+        if (valid_b) begin
+            amo_addr_b_q <= eff_addr[NCORES_A + sel_b];
+            amo_src_b_q  <= eff_wdata[NCORES_A + sel_b];
+            amo_op_b_q   <= eff_amo_op[NCORES_A + sel_b];
+        end
 
         for (j = 0; j < NCORES; j = j + 1) begin
             reservation_valid_q[j] <= reservation_valid_d[j];
@@ -435,9 +533,25 @@ module comb_dmem_controller #(
             req_wstrb_q[j] <= req_wstrb_d[j];
             req_is_lr_q[j] <= req_is_lr_d[j];
             req_is_sc_q[j] <= req_is_sc_d[j];
+            req_is_amo_q[j] <= req_is_amo_d[j];
+            req_amo_op_q[j] <= req_amo_op_d[j];
         end
     end
 
+    amo_alu amo_alu_a (
+        .op_i  (amo_op_a_q),   // input  wire [`AMO_OP_WIDTH-1:0]
+        .mem_i (rdataa_dmem),  // input  wire [31:0]
+        .src_i (amo_src_a_q),  // input  wire [31:0]
+        .rslt_o(amo_rslt_a)    // output wire [31:0]
+    );
+
+    amo_alu amo_alu_b (
+        .op_i  (amo_op_b_q),   // input  wire [`AMO_OP_WIDTH-1:0]
+        .mem_i (rdatab_dmem),  // input  wire [31:0]
+        .src_i (amo_src_b_q),  // input  wire [31:0]
+        .rslt_o(amo_rslt_b)    // output wire [31:0]
+    );
+
     m_dmem dmem (
         .clk_i   (clk_i),            // input  wire
         .rea_i   (rea_int),          // input  wire
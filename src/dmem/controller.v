@@ -13,8 +13,11 @@ module dmem_controller #(
     input wire [4*NCORES-1:0] wstrb_packed_i,
     input wire [NCORES-1:0] is_lr_packed_i,
     input wire [NCORES-1:0] is_sc_packed_i,
+    input wire [NCORES-1:0] is_amo_packed_i,
+    input wire [`AMO_OP_WIDTH*NCORES-1:0] amo_op_packed_i,
     output wire [32*NCORES-1:0] rdata_packed_o,
-    output wire [NCORES-1:0] stall_packed_o
+    output wire [NCORES-1:0] stall_packed_o,
+    output wire [NCORES-1:0] rsv_valid_packed_o  // LR/SC reservation of each core, for wrs
 );
     genvar i;
     integer j;
@@ -27,9 +30,18 @@ module dmem_controller #(
     localparam ACCESS = 'd2;
     localparam STATE_WIDTH = 'd3;
 
+`ifdef USE_DUAL_ISSUE_DBUS
+    // Port assignment: dual_issue_arbiter picks two cores from all requesters every cycle,
+    // so any core can be served on either port
+    localparam NCORES_A = NCORES;
+    localparam NCORES_B = NCORES;
+    localparam PORT_B_BASE = 0;
+`else
     // Port assignment: cores 0 to NCORES_A-1 use port A, cores NCORES_A to NCORES-1 use port B
     localparam NCORES_A = NCORES / 2;           // Cores assigned to port A
     localparam NCORES_B = NCORES - NCORES_A;    // Cores assigned to port B
+    localparam PORT_B_BASE = NCORES_A;          // Global index of the first core on port B
+`endif
     localparam NCORES_A_W = (NCORES_A > 1) ? $clog2(NCORES_A) : 1;
     localparam NCORES_B_W = (NCORES_B > 1) ? $clog2(NCORES_B) : 1;
 
@@ -46,6 +58,8 @@ module dmem_controller #(
     wire [3:0]            wstrb[0:NCORES-1];
     wire                  is_lr[0:NCORES-1];
     wire                  is_sc[0:NCORES-1];
+    wire                  is_amo[0:NCORES-1];
+    wire [`AMO_OP_WIDTH-1:0] amo_op[0:NCORES-1];
     reg  [31:0]           rdata [0:NCORES-1];
     reg                   stall_q [0:NCORES-1];
     reg                   stall_d [0:NCORES-1];
@@ -59,6 +73,8 @@ module dmem_controller #(
             assign wstrb[i] = wstrb_packed_i[4*(i+1)-1:4*i];
             assign is_lr[i] = is_lr_packed_i[i];
             assign is_sc[i] = is_sc_packed_i[i];
+            assign is_amo[i] = is_amo_packed_i[i];
+            assign amo_op[i] = amo_op_packed_i[`AMO_OP_WIDTH*(i+1)-1:`AMO_OP_WIDTH*i];
             assign rdata_packed_o[32*(i+1)-1:32*i] = rdata[i];
             assign stall_packed_o[i] = stall_q[i];
         end
@@ -73,6 +89,8 @@ module dmem_controller #(
     reg [3:0]            req_wstrb_q [0:NCORES-1];
     reg                  req_is_lr_q [0:NCORES-1];
     reg                  req_is_sc_q [0:NCORES-1];
+    reg                  req_is_amo_q[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] req_amo_op_q[0:NCORES-1];
 
     reg                  req_valid_d [0:NCORES-1];
     reg                  req_re_d    [0:NCORES-1];
@@ -82,6 +100,8 @@ module dmem_controller #(
     reg [3:0]            req_wstrb_d [0:NCORES-1];
     reg                  req_is_lr_d [0:NCORES-1];
     reg                  req_is_sc_d [0:NCORES-1];
+    reg                  req_is_amo_d[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] req_amo_op_d[0:NCORES-1];
 
     // Round-robin state (separate for each port)
     reg [NCORES_A_W-1:0] rr_ptr_a_q = 0;  // points to next core to serve on port A
@@ -101,8 +121,8 @@ module dmem_controller #(
     reg [DMEM_ADDRW-1:0] sel_addr_b_d;
 
     // Global core index for return path
-    reg [$clog2(NCORES)-1:0] sel_core_a_global;
-    reg [$clog2(NCORES)-1:0] sel_core_b_global;
+    wire [$clog2(NCORES)-1:0] sel_core_a_global = sel_core_a_q;
+    wire [$clog2(NCORES)-1:0] sel_core_b_global = PORT_B_BASE + sel_core_b_q;
 
     // Arbiter outputs (local indices)
     wire [NCORES_A_W-1:0] sel_core_a_arb;
@@ -117,6 +137,12 @@ module dmem_controller #(
     reg [DMEM_ADDRW-1:0] reservation_addr_q    [0:NCORES-1];
     reg                  rsvcheck_sc_success_q [0:NCORES-1];
 
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : pack_rsv_valid
+            assign rsv_valid_packed_o[i] = reservation_valid_q[i];
+        end
+    endgenerate
+
     reg                  reservation_valid_d   [0:NCORES-1];
     reg [DMEM_ADDRW-1:0] reservation_addr_d    [0:NCORES-1];
     reg                  rsvcheck_sc_success_d [0:NCORES-1];
@@ -135,12 +161,18 @@ module dmem_controller #(
     wire [31:0] rdataa_dmem;
     wire [31:0] rdatab_dmem;
 
+    // AMO: the old value is read in RSVCHECK and the new value is written in ACCESS
+    wire [31:0] amo_rslt_a;
+    wire [31:0] amo_rslt_b;
+
     reg [$clog2(NCORES)-1:0] ret_core_a_q;
     reg [$clog2(NCORES)-1:0] ret_core_b_q;
     reg ret_valid_a_q;
     reg ret_valid_b_q;
     reg ret_is_sc_a_q;
     reg ret_is_sc_b_q;
+    reg [NCORES-1:0] ret_coal_a_q = 0;  // cores served by coalescing with port A
+    reg [NCORES-1:0] ret_coal_b_q = 0;  // cores served by coalescing with port B
 
     reg [$clog2(NCORES)-1:0] ret_core_a_d;
     reg [$clog2(NCORES)-1:0] ret_core_b_d;
@@ -149,15 +181,102 @@ module dmem_controller #(
     reg ret_is_sc_a_d;
     reg ret_is_sc_b_d;
 
+    // Requests visible to the arbiters: the pending request, or with USE_DBUS_BYPASS
+    // also a new request in the cycle it arrives
+    reg                  eff_valid [0:NCORES-1];
+    reg                  eff_re    [0:NCORES-1];
+    reg                  eff_we    [0:NCORES-1];
+    reg [DMEM_ADDRW-1:0] eff_addr  [0:NCORES-1];
+    reg                  eff_plain [0:NCORES-1];  // load or store without LR/SC/AMO
+
+    always @(*) begin
+        for (k = 0; k < NCORES; k = k + 1) begin
+`ifdef USE_DBUS_BYPASS
+            eff_valid[k] = req_valid_q[k] || re[k] || we[k];
+            eff_re[k]    = req_valid_q[k] ? req_re_q[k]   : re[k];
+            eff_we[k]    = req_valid_q[k] ? req_we_q[k]   : we[k];
+            eff_addr[k]  = req_valid_q[k] ? req_addr_q[k] : addr[k];
+            eff_plain[k] = req_valid_q[k] ? (req_re_q[k] ? !req_is_lr_q[k] : !(req_is_sc_q[k] || req_is_amo_q[k]))
+                                          : (re[k] ? !is_lr[k] : !(is_sc[k] || is_amo[k]));
+`else
+            eff_valid[k] = req_valid_q[k];
+            eff_re[k]    = req_re_q[k];
+            eff_we[k]    = req_we_q[k];
+            eff_addr[k]  = req_addr_q[k];
+            eff_plain[k] = req_re_q[k] ? !req_is_lr_q[k] : !(req_is_sc_q[k] || req_is_amo_q[k]);
+`endif
+        end
+    end
+
+    // A port takes a new request when it is idle or in the last cycle of an access
+    wire port_a_free = (state_a_q == IDLE) || (state_a_q == ACCESS);
+    wire port_b_free = (state_b_q == IDLE) || (state_b_q == ACCESS);
+
+    // Load coalescing: a plain load in ACCESS also returns its data to every other core
+    // whose pending plain load targets the same word
+    wire coal_src_a = (state_a_q == ACCESS) && req_re_q[sel_core_a_global] && !req_is_lr_q[sel_core_a_global];
+    wire coal_src_b = (state_b_q == ACCESS) && req_re_q[sel_core_b_global] && !req_is_lr_q[sel_core_b_global];
+    wire [NCORES-1:0] coal_a;
+    wire [NCORES-1:0] coal_b;
+
+    // A request held by a port is not a candidate again
+    wire [NCORES-1:0] req_avail_packed;
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : pack_req_avail
+            wire held_a = (state_a_q != IDLE) && (sel_core_a_global == i);
+            wire held_b = (state_b_q != IDLE) && (sel_core_b_global == i);
+            wire coal_cand = req_valid_q[i] && req_re_q[i] && !req_is_lr_q[i] && !held_a && !held_b;
+
+            assign coal_a[i] = coal_src_a && coal_cand && (req_addr_q[i] == sel_addr_a_q);
+            assign coal_b[i] = coal_src_b && coal_cand && (req_addr_q[i] == sel_addr_b_q) && !coal_a[i];
+            assign req_avail_packed[i] = eff_valid[i] && !held_a && !held_b && !coal_a[i] && !coal_b[i];
+        end
+    endgenerate
+
     // Select cores in round-robin fashion
+`ifdef USE_DUAL_ISSUE_DBUS
+    wire [DMEM_ADDRW*NCORES-1:0] req_addr_packed;
+    wire            [NCORES-1:0] req_we_packed;
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : pack_req_addr
+            assign req_addr_packed[DMEM_ADDRW*(i+1)-1:DMEM_ADDRW*i] = eff_addr[i];
+            assign req_we_packed[i] = eff_we[i] || !eff_plain[i];
+        end
+    endgenerate
+
+    wire                  cand_valid_0;
+    wire                  cand_valid_1;  // also false if both access a word that one of them writes
+    wire [NCORES_A_W-1:0] cand_core_0;
+    wire [NCORES_A_W-1:0] cand_core_1;
+
+    dual_issue_arbiter #(
+        .NCORES    (NCORES),
+        .ADDR_WIDTH(DMEM_ADDRW)
+    ) arbiter (
+        .rr_ptr_i         (rr_ptr_a_q),
+        .req_valid_i      (req_avail_packed),
+        .req_we_i         (req_we_packed),
+        .req_addr_packed_i(req_addr_packed),
+        .valid_a_o        (cand_valid_0),
+        .valid_b_o        (cand_valid_1),
+        .selector_a_o     (cand_core_0),
+        .selector_b_o     (cand_core_1)
+    );
+
+    // The first candidate goes to port A if it is free, otherwise to port B
+    assign sel_valid_a_arb = cand_valid_0;
+    assign sel_core_a_arb  = cand_core_0;
+    assign sel_valid_b_arb = port_a_free ? cand_valid_1 : cand_valid_0;
+    assign sel_core_b_arb  = port_a_free ? cand_core_1 : cand_core_0;
+`else
     wire [NCORES_A-1:0] req_valid_a_packed;
     wire [NCORES_B-1:0] req_valid_b_packed;
     generate
         for (i = 0; i < NCORES_A; i = i + 1) begin : pack_req_a
-            assign req_valid_a_packed[i] = req_valid_q[i];
+            assign req_valid_a_packed[i] = req_avail_packed[i];
         end
         for (i = 0; i < NCORES_B; i = i + 1) begin : pack_req_b
-            assign req_valid_b_packed[i] = req_valid_q[NCORES_A + i];
+            assign req_valid_b_packed[i] = req_avail_packed[NCORES_A + i];
         end
     endgenerate
 
@@ -178,27 +297,51 @@ module dmem_controller #(
         .valid_o    (sel_valid_b_arb),
         .selector_o (sel_core_b_arb)
     );
+`endif
+
+    wire [$clog2(NCORES)-1:0] arb_core_a = sel_core_a_arb;                // global index
+    wire [$clog2(NCORES)-1:0] arb_core_b = PORT_B_BASE + sel_core_b_arb;  // global index
 
     wire select_a_fire;
     wire select_b_fire;
+    wire bypass_a;
+    wire bypass_b;
     wire is_access_a;
     wire is_access_b;
 
-    // Address conflict check: Port B should not fire if it would access the same address as Port A
-    wire addr_conflict_at_idle = select_a_fire && sel_valid_b_arb
-                               && (req_addr_q[sel_core_a_arb] == req_addr_q[NCORES_A + sel_core_b_arb]);
+    // Address conflict check: Port B should not fire if it would access the same address as Port A.
+    // dual_issue_arbiter already makes this check for the two requests it grants in a cycle.
+`ifdef USE_DUAL_ISSUE_DBUS
+    wire addr_conflict_at_idle = 1'b0;
+`else
+    wire addr_conflict_at_idle = (select_a_fire || bypass_a) && sel_valid_b_arb
+                               && (eff_addr[arb_core_a] == eff_addr[arb_core_b]);
+`endif
     wire addr_conflict_a_busy  = (state_a_q != IDLE)
-                               && (sel_addr_a_q == req_addr_q[NCORES_A + sel_core_b_arb]);
-
-    assign select_a_fire = (state_a_q == IDLE) && sel_valid_a_arb;
-    assign select_b_fire = (state_b_q == IDLE) && sel_valid_b_arb
-                         && !addr_conflict_at_idle && !addr_conflict_a_busy;
+                               && (sel_addr_a_q == eff_addr[arb_core_b]);
+    // and vice versa, so that the read and the write of an AMO are not split by the other port
+    wire addr_conflict_b_busy  = (state_b_q != IDLE)
+                               && (sel_addr_b_q == eff_addr[arb_core_a]);
+
+`ifdef USE_DBUS_BYPASS
+    // Single-cycle bypass: a new plain load or store that wins an idle port is served in the
+    // cycle it arrives, without being registered as a pending request
+    assign bypass_a = (state_a_q == IDLE) && sel_valid_a_arb && !addr_conflict_b_busy
+                    && !req_valid_q[arb_core_a] && eff_plain[arb_core_a];
+    assign bypass_b = (state_b_q == IDLE) && sel_valid_b_arb && !addr_conflict_at_idle && !addr_conflict_a_busy
+                    && !req_valid_q[arb_core_b] && eff_plain[arb_core_b];
+`else
+    assign bypass_a = 1'b0;
+    assign bypass_b = 1'b0;
+`endif
+
+    assign select_a_fire = port_a_free && sel_valid_a_arb && !addr_conflict_b_busy && !bypass_a;
+    assign select_b_fire = port_b_free && sel_valid_b_arb
+                         && !addr_conflict_at_idle && !addr_conflict_a_busy && !bypass_b;
     assign is_access_a = (state_a_q == ACCESS);
     assign is_access_b = (state_b_q == ACCESS);
 
     always @(*) begin
-        sel_core_a_global = sel_core_a_q;
-        sel_core_b_global = NCORES_A + sel_core_b_q;
         state_a_d         = state_a_q;
         sel_core_a_d      = sel_core_a_q;
         sel_addr_a_d      = sel_addr_a_q;
@@ -207,8 +350,8 @@ module dmem_controller #(
         sel_addr_b_d      = sel_addr_b_q;
         rr_ptr_a_d        = rr_ptr_a_q;
         rr_ptr_b_d        = rr_ptr_b_q;
-        ret_valid_a_d     = ret_valid_a_q;
-        ret_valid_b_d     = ret_valid_b_q;
+        ret_valid_a_d     = 1'b0;
+        ret_valid_b_d     = 1'b0;
         ret_core_a_d      = ret_core_a_q;
         ret_core_b_d      = ret_core_b_q;
         ret_is_sc_a_d     = ret_is_sc_a_q;
@@ -227,7 +370,10 @@ module dmem_controller #(
         // Calculate being_served for all cores first
         for (k = 0; k < NCORES; k = k + 1) begin
             being_served[k] = (is_access_a && sel_core_a_global == k)
-                           || (is_access_b && sel_core_b_global == k);
+                           || (is_access_b && sel_core_b_global == k)
+                           || (bypass_a && arb_core_a == k)
+                           || (bypass_b && arb_core_b == k)
+                           || coal_a[k] || coal_b[k];
         end
 
         for (k = 0; k < NCORES; k = k + 1) begin
@@ -235,7 +381,9 @@ module dmem_controller #(
                                         || req_valid_q[k]) // or any pending request exists
                                        && !being_served[k]; // but not being served
             rdata[k]                 = (ret_valid_a_q && ret_core_a_q == k) ? (ret_is_sc_a_q ? {31'b0, !rsvcheck_sc_success_q[k]} : rdataa_dmem) :
-                                       (ret_valid_b_q && ret_core_b_q == k) ? (ret_is_sc_b_q ? {31'b0, !rsvcheck_sc_success_q[k]} : rdatab_dmem) : 32'h0;
+                                       (ret_valid_b_q && ret_core_b_q == k) ? (ret_is_sc_b_q ? {31'b0, !rsvcheck_sc_success_q[k]} : rdatab_dmem) :
+                                       ret_coal_a_q[k] ? rdataa_dmem :
+                                       ret_coal_b_q[k] ? rdatab_dmem : 32'h0;
             req_valid_d[k]           = req_valid_q[k];
             req_re_d[k]              = req_re_q[k];
             req_we_d[k]              = req_we_q[k];
@@ -244,11 +392,13 @@ module dmem_controller #(
             req_wstrb_d[k]           = req_wstrb_q[k];
             req_is_lr_d[k]           = req_is_lr_q[k];
             req_is_sc_d[k]           = req_is_sc_q[k];
+            req_is_amo_d[k]          = req_is_amo_q[k];
+            req_amo_op_d[k]          = req_amo_op_q[k];
             reservation_valid_d[k]   = reservation_valid_q[k];
             reservation_addr_d[k]    = reservation_addr_q[k];
             rsvcheck_sc_success_d[k] = rsvcheck_sc_success_q[k];
             if (!req_valid_q[k]) begin
-                req_valid_d[k] = (re[k] || we[k]);
+                req_valid_d[k] = (re[k] || we[k]) && !being_served[k];
                 req_re_d[k]    = re[k];
                 req_we_d[k]    = we[k];
                 req_addr_d[k]  = addr[k];
@@ -256,27 +406,47 @@ module dmem_controller #(
                 req_wstrb_d[k] = wstrb[k];
                 req_is_lr_d[k] = is_lr[k];
                 req_is_sc_d[k] = is_sc[k];
+                req_is_amo_d[k] = is_amo[k];
+                req_amo_op_d[k] = amo_op[k];
             end else if (being_served[k]) begin
                 req_valid_d[k] = 1'b0;
             end
         end
 
+        if (ret_valid_a_q) rsvcheck_sc_success_d[ret_core_a_q] = 1'b0;
+        if (ret_valid_b_q) rsvcheck_sc_success_d[ret_core_b_q] = 1'b0;
+
+        // Port A issues the next request while the current access completes
+        if (select_a_fire) begin
+            if (eff_plain[arb_core_a]) begin // simple load or store
+                state_a_d = ACCESS;
+            end else begin
+                state_a_d = RSVCHECK;
+            end
+            sel_core_a_d = sel_core_a_arb;
+            sel_addr_a_d = eff_addr[arb_core_a];
+            rr_ptr_a_d   = (sel_core_a_arb + 1) % NCORES_A;
+        end
+
         case (state_a_q)
             IDLE: begin
-                if (select_a_fire) begin
-                    if (req_re_q[sel_core_a_arb] && !req_is_lr_q[sel_core_a_arb]) begin // simple load
-                        state_a_d = ACCESS;
-                    end else begin
-                        state_a_d = RSVCHECK;
+                if (bypass_a) begin
+                    ret_valid_a_d = 1'b1;
+                    ret_core_a_d  = arb_core_a;
+                    ret_is_sc_a_d = 1'b0;
+                    rea_int       = eff_re[arb_core_a];
+                    wea_int       = eff_we[arb_core_a];
+                    addra_int     = addr[arb_core_a];
+                    wdataa_int    = wdata[arb_core_a];
+                    wstrba_int    = wstrb[arb_core_a];
+                    if (we[arb_core_a]) begin
+                        for (m = 0; m < NCORES; m = m + 1) begin
+                            if (reservation_valid_q[m] && reservation_addr_q[m] == addr[arb_core_a]) begin
+                                reservation_valid_d[m] = 1'b0;
+                            end
+                        end
                     end
-                    sel_core_a_d = sel_core_a_arb;
-                    sel_addr_a_d = req_addr_q[sel_core_a_arb];
-                    rr_ptr_a_d   = (sel_core_a_arb + 1) % NCORES_A;
-                end
-
-                if (ret_valid_a_q) begin
-                    rsvcheck_sc_success_d[ret_core_a_q] = 1'b0;
-                    ret_valid_a_d = 1'b0;
+                    rr_ptr_a_d    = (sel_core_a_arb + 1) % NCORES_A;
                 end
             end
             RSVCHECK: begin
@@ -293,23 +463,33 @@ module dmem_controller #(
                             end
                         end
                     end
-                end else if (req_we_q[sel_core_a_global] && !req_is_sc_q[sel_core_a_global]) begin
+                end else if (req_is_amo_q[sel_core_a_global]) begin
                     for (m = 0; m < NCORES; m = m + 1) begin
                         if (reservation_valid_q[m] && reservation_addr_q[m] == sel_addr_a_q) begin
                             reservation_valid_d[m] = 1'b0;
                         end
                     end
+                    rea_int   = 1'b1;
+                    addra_int = sel_addr_a_q;
                 end
             end
             ACCESS: begin
-                state_a_d      = IDLE;
+                if (!select_a_fire) state_a_d = IDLE;
+                // Plain stores skip RSVCHECK and invalidate reservations together with the write
+                if (req_we_q[sel_core_a_global] && !req_is_sc_q[sel_core_a_global] && !req_is_amo_q[sel_core_a_global]) begin
+                    for (m = 0; m < NCORES; m = m + 1) begin
+                        if (reservation_valid_q[m] && reservation_addr_q[m] == sel_addr_a_q) begin
+                            reservation_valid_d[m] = 1'b0;
+                        end
+                    end
+                end
                 ret_valid_a_d  = 1'b1;
                 ret_core_a_d   = sel_core_a_global;
                 ret_is_sc_a_d  = req_is_sc_q[sel_core_a_global];
                 rea_int        = req_re_q[sel_core_a_global];
                 wea_int        = req_we_q[sel_core_a_global] && (req_is_sc_q[sel_core_a_global] ? rsvcheck_sc_success_q[sel_core_a_global] : 1'b1);
                 addra_int      = sel_addr_a_q;
-                wdataa_int     = req_wdata_q[sel_core_a_global];
+                wdataa_int     = req_is_amo_q[sel_core_a_global] ? amo_rslt_a : req_wdata_q[sel_core_a_global];
                 wstrba_int     = req_wstrb_q[sel_core_a_global];
             end
             default: begin
@@ -317,22 +497,42 @@ module dmem_controller #(
             end
         endcase
 
+        // Port B issues the next request while the current access completes
+        if (select_b_fire) begin
+            if (eff_plain[arb_core_b]) begin // simple load or store
+                state_b_d = ACCESS;
+            end else begin
+                state_b_d = RSVCHECK;
+            end
+            sel_core_b_d = sel_core_b_arb;
+            sel_addr_b_d = eff_addr[arb_core_b];
+        end
+        if (select_b_fire || bypass_b) begin
+`ifdef USE_DUAL_ISSUE_DBUS
+            rr_ptr_a_d   = (sel_core_b_arb + 1) % NCORES;  // rr_ptr_a_q is shared by both ports
+`else
+            rr_ptr_b_d   = (sel_core_b_arb + 1) % NCORES_B;
+`endif
+        end
+
         case (state_b_q)
             IDLE: begin
-                if (select_b_fire) begin
-                    if (req_re_q[NCORES_A + sel_core_b_arb] && !req_is_lr_q[NCORES_A + sel_core_b_arb]) begin // simple load
-                        state_b_d = ACCESS;
-                    end else begin
-                        state_b_d = RSVCHECK;
+                if (bypass_b) begin
+                    ret_valid_b_d = 1'b1;
+                    ret_core_b_d  = arb_core_b;
+                    ret_is_sc_b_d = 1'b0;
+                    reb_int       = eff_re[arb_core_b];
+                    web_int       = eff_we[arb_core_b];
+                    addrb_int     = addr[arb_core_b];
+                    wdatab_int    = wdata[arb_core_b];
+                    wstrbb_int    = wstrb[arb_core_b];
+                    if (we[arb_core_b]) begin
+                        for (m = 0; m < NCORES; m = m + 1) begin
+                            if (reservation_valid_q[m] && reservation_addr_q[m] == addr[arb_core_b]) begin
+                                reservation_valid_d[m] = 1'b0;
+                            end
+                        end
                     end
-                    sel_core_b_d = sel_core_b_arb;
-                    sel_addr_b_d = req_addr_q[NCORES_A + sel_core_b_arb];
-                    rr_ptr_b_d   = (sel_core_b_arb + 1) % NCORES_B;
-                end
-
-                if (ret_valid_b_q) begin
-                    rsvcheck_sc_success_d[ret_core_b_q] = 1'b0;
-                    ret_valid_b_d = 1'b0;
                 end
             end
             RSVCHECK: begin
@@ -349,23 +549,33 @@ module dmem_controller #(
                             end
                         end
                     end
-                end else if (req_we_q[sel_core_b_global] && !req_is_sc_q[sel_core_b_global]) begin
+                end else if (req_is_amo_q[sel_core_b_global]) begin
                     for (m = 0; m < NCORES; m = m + 1) begin
                         if (reservation_valid_q[m] && reservation_addr_q[m] == sel_addr_b_q) begin
                             reservation_valid_d[m] = 1'b0;
                         end
                     end
+                    reb_int   = 1'b1;
+                    addrb_int = sel_addr_b_q;
                 end
             end
             ACCESS: begin
-                state_b_d      = IDLE;
+                if (!select_b_fire) state_b_d = IDLE;
+                // Plain stores skip RSVCHECK and invalidate reservations together with the write
+                if (req_we_q[sel_core_b_global] && !req_is_sc_q[sel_core_b_global] && !req_is_amo_q[sel_core_b_global]) begin
+                    for (m = 0; m < NCORES; m = m + 1) begin
+                        if (reservation_valid_q[m] && reservation_addr_q[m] == sel_addr_b_q) begin
+                            reservation_valid_d[m] = 1'b0;
+                        end
+                    end
+                end
                 ret_valid_b_d  = 1'b1;
                 ret_core_b_d   = sel_core_b_global;
                 ret_is_sc_b_d  = req_is_sc_q[sel_core_b_global];
                 reb_int        = req_re_q[sel_core_b_global];
                 web_int        = req_we_q[sel_core_b_global] && (req_is_sc_q[sel_core_b_global] ? rsvcheck_sc_success_q[sel_core_b_global] : 1'b1);
                 addrb_int      = sel_addr_b_q;
-                wdatab_int     = req_wdata_q[sel_core_b_global];
+                wdatab_int     = req_is_amo_q[sel_core_b_global] ? amo_rslt_b : req_wdata_q[sel_core_b_global];
                 wstrbb_int     = req_wstrb_q[sel_core_b_global];
             end
             default: begin
@@ -389,6 +599,8 @@ module dmem_controller #(
         ret_core_b_q  <= ret_core_b_d;
         ret_is_sc_a_q <= ret_is_sc_a_d;
         ret_is_sc_b_q <= ret_is_sc_b_d;
+        ret_coal_a_q  <= coal_a;
+        ret_coal_b_q  <= coal_b;
 
         for (j = 0; j < NCORES; j = j + 1) begin
             stall_q[j]             <= stall_d[j];
@@ -400,12 +612,28 @@ module dmem_controller #(
             req_wstrb_q[j]         <= req_wstrb_d[j];
             req_is_lr_q[j]         <= req_is_lr_d[j];
             req_is_sc_q[j]         <= req_is_sc_d[j];
+            req_is_amo_q[j]        <= req_is_amo_d[j];
+            req_amo_op_q[j]        <= req_amo_op_d[j];
             reservation_valid_q[j] <= reservation_valid_d[j];
             reservation_addr_q[j]  <= reservation_addr_d[j];
             rsvcheck_sc_success_q[j] <= rsvcheck_sc_success_d[j];
         end
     end
 
+    amo_alu amo_alu_a (
+        .op_i  (req_amo_op_q[sel_core_a_global]),  // input  wire [`AMO_OP_WIDTH-1:0]
+        .mem_i (rdataa_dmem),                      // input  wire [31:0]
+        .src_i (req_wdata_q[sel_core_a_global]),   // input  wire [31:0]
+        .rslt_o(amo_rslt_a)                        // output wire [31:0]
+    );
+
+    amo_alu amo_alu_b (
+        .op_i  (req_amo_op_q[sel_core_b_global]),  // input  wire [`AMO_OP_WIDTH-1:0]
+        .mem_i (rdatab_dmem),                      // input  wire [31:0]
+        .src_i (req_wdata_q[sel_core_b_global]),   // input  wire [31:0]
+        .rslt_o(amo_rslt_b)                        // output wire [31:0]
+    );
+
     m_dmem dmem (
         .clk_i   (clk_i),            // input  wire
         .rea_i   (rea_int),          // input  wire
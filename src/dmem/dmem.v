@@ -49,3 +49,83 @@ module m_dmem #(
 endmodule
 
 `resetall
+
+`default_nettype none
+
+// One bank of the word-interleaved data memory used by banked_dmem_controller
+module m_dmem_bank #(
+    parameter DMEM_ENTRIES = `DMEM_ENTRIES,
+    parameter NBANKS = `DMEM_NBANKS,
+    parameter BANK = 0,
+    parameter ROWW = $clog2(`DMEM_ENTRIES/`DMEM_NBANKS)
+) (
+    input  wire            clk_i,
+    input  wire            re_i,
+    input  wire            we_i,
+    input  wire [ROWW-1:0] addr_i,
+    input  wire     [31:0] wdata_i,
+    input  wire     [ 3:0] wstrb_i,
+    output wire     [31:0] rdata_o
+);
+    localparam BANK_ENTRIES = DMEM_ENTRIES / NBANKS;
+    // memd_bankNN.mem holds every NBANKS-th word of the data memory from word BANK, written by
+    // make prog for DMEM_NBANKS in config.mk
+    localparam [7:0] DIGIT1 = 48 + BANK / 10;
+    localparam [7:0] DIGIT0 = 48 + BANK % 10;
+    localparam [8*15-1:0] INIT_FILE = {"memd_bank", DIGIT1, DIGIT0, ".mem"};
+
+    (* ram_style = "block" *) reg [31:0] bank[0:BANK_ENTRIES-1];
+    initial $readmemh(INIT_FILE, bank);
+
+    reg [31:0] rdata = 0;
+    always @(posedge clk_i) begin
+        if (we_i) begin
+            if (wstrb_i[0]) bank[addr_i][7:0] <= wdata_i[7:0];
+            if (wstrb_i[1]) bank[addr_i][15:8] <= wdata_i[15:8];
+            if (wstrb_i[2]) bank[addr_i][23:16] <= wdata_i[23:16];
+            if (wstrb_i[3]) bank[addr_i][31:24] <= wdata_i[31:24];
+        end
+        if (re_i) rdata <= bank[addr_i];
+    end
+    assign rdata_o = rdata;
+endmodule
+
+`resetall
+
+`default_nettype none
+
+// One read replica of the data memory used by replicated_dmem_controller
+// Every replica receives every write, so each one holds the whole data memory
+module m_dmem_replica #(
+    parameter DMEM_ADDRW = `DMEM_ADDRW,
+    parameter DMEM_ENTRIES = `DMEM_ENTRIES
+) (
+    input  wire                  clk_i,
+    input  wire                  we_i,
+    input  wire [DMEM_ADDRW-1:0] waddr_i,
+    input  wire           [31:0] wdata_i,
+    input  wire           [ 3:0] wstrb_i,
+    input  wire                  re_i,
+    input  wire [DMEM_ADDRW-1:0] raddr_i,
+    output wire           [31:0] rdata_o
+);
+    (* ram_style = "block" *) reg [31:0] dmem[0:DMEM_ENTRIES-1];
+    `include "memd.txt"
+
+    always @(posedge clk_i) begin
+        if (we_i) begin
+            if (wstrb_i[0]) dmem[waddr_i][7:0] <= wdata_i[7:0];
+            if (wstrb_i[1]) dmem[waddr_i][15:8] <= wdata_i[15:8];
+            if (wstrb_i[2]) dmem[waddr_i][23:16] <= wdata_i[23:16];
+            if (wstrb_i[3]) dmem[waddr_i][31:24] <= wdata_i[31:24];
+        end
+    end
+
+    reg [31:0] rdata = 0;
+    always @(posedge clk_i) begin
+        if (re_i) rdata <= dmem[raddr_i];
+    end
+    assign rdata_o = rdata;
+endmodule
+
+`resetall
@@ -0,0 +1,275 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Data memory controller with per-core L1 data caches
+// Each core owns an l1_dcache. Misses, write-backs, LR/SC and AMOs are serialized on a single
+// snooping bus in front of port A of the shared data memory.
+module l1_dmem_controller #(
+    parameter NCORES = `NCORES,
+    parameter DMEM_ADDRW = `DMEM_ADDRW
+) (
+    input wire clk_i,
+    input wire [NCORES-1:0] re_packed_i,
+    input wire [NCORES-1:0] we_packed_i,
+    input wire [DMEM_ADDRW*NCORES-1:0] addr_packed_i,
+    input wire [32*NCORES-1:0] wdata_packed_i,
+    input wire [4*NCORES-1:0] wstrb_packed_i,
+    input wire [NCORES-1:0] is_lr_packed_i,
+    input wire [NCORES-1:0] is_sc_packed_i,
+    input wire [NCORES-1:0] is_amo_packed_i,
+    input wire [`AMO_OP_WIDTH*NCORES-1:0] amo_op_packed_i,
+    output wire [32*NCORES-1:0] rdata_packed_o,
+    output wire [NCORES-1:0] stall_packed_o,
+    output wire [NCORES-1:0] rsv_valid_packed_o  // LR/SC reservation of each core, for wrs
+);
+    genvar i;
+    integer j;
+    integer m;
+
+    localparam NCORES_W = (NCORES > 1) ? $clog2(NCORES) : 1;
+
+    // Statemachine
+    localparam IDLE = 'd0;    // grant the bus
+    localparam SNOOP = 'd1;   // snoop all caches, write back the owner, check reservations
+    localparam ACCESS = 'd2;  // access the data memory
+    localparam RESP = 'd3;    // return the data to the requester, write back the AMO result
+    localparam STATE_WIDTH = 'd4;
+
+    reg [$clog2(STATE_WIDTH)-1:0] state_q = IDLE;
+    reg [$clog2(STATE_WIDTH)-1:0] state_d;
+
+    // Bus signals of each cache
+    wire                     bus_req   [0:NCORES-1];
+    wire [`L1_CMD_WIDTH-1:0] bus_cmd   [0:NCORES-1];
+    wire    [DMEM_ADDRW-1:0] bus_addr  [0:NCORES-1];
+    wire              [31:0] bus_wdata [0:NCORES-1];
+    wire               [3:0] bus_wstrb [0:NCORES-1];
+    wire                     bus_is_lr [0:NCORES-1];
+    wire                     bus_is_sc [0:NCORES-1];
+    wire                     bus_is_amo[0:NCORES-1];
+    wire [`AMO_OP_WIDTH-1:0] bus_amo_op[0:NCORES-1];
+    wire                     snoop_hit_m[0:NCORES-1];
+    wire              [31:0] snoop_data[0:NCORES-1];
+
+    wire [NCORES-1:0] bus_req_packed;
+
+    // Current bus transaction
+    reg    [NCORES_W-1:0] sel_core_q = 'd0;
+    reg [`L1_CMD_WIDTH-1:0] sel_cmd_q;
+    reg  [DMEM_ADDRW-1:0] sel_addr_q;
+    reg            [31:0] sel_wdata_q;
+    reg             [3:0] sel_wstrb_q;
+    reg                   sel_is_lr_q;
+    reg                   sel_is_sc_q;
+    reg                   sel_is_amo_q;
+    reg [`AMO_OP_WIDTH-1:0] sel_amo_op_q;
+    reg                   sc_success_q = 1'b0;
+
+    reg    [NCORES_W-1:0] rr_ptr_q = 'd0;
+
+    wire                sel_valid_arb;
+    wire [NCORES_W-1:0] sel_core_arb;
+
+    // LR/SC reservation
+    reg                  reservation_valid_q [0:NCORES-1];
+    reg [DMEM_ADDRW-1:0] reservation_addr_q  [0:NCORES-1];
+    initial for (j = 0; j < NCORES; j = j + 1) reservation_valid_q[j] = 1'b0;
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : pack_rsv_valid
+            assign rsv_valid_packed_o[i] = reservation_valid_q[i];
+        end
+    endgenerate
+
+    // Snoop results
+    reg        owner_hit;
+    reg [31:0] owner_data;
+
+    reg                  wea_int;
+    reg                  rea_int;
+    reg [DMEM_ADDRW-1:0] addra_int;
+    reg           [31:0] wdataa_int;
+    reg            [3:0] wstrba_int;
+    wire          [31:0] rdataa_dmem;
+    wire          [31:0] amo_rslt;
+
+    wire snoop_valid = (state_q == SNOOP);
+    wire snoop_inv   = (sel_cmd_q != `L1_CMD_RD);
+    wire bus_fire    = (state_q == IDLE) && sel_valid_arb;
+    wire is_resp     = (state_q == RESP);
+
+    // Write data of RDX merged into the word read from the data memory
+    wire [31:0] rdx_merge = {sel_wstrb_q[3] ? sel_wdata_q[31:24] : rdataa_dmem[31:24],
+                             sel_wstrb_q[2] ? sel_wdata_q[23:16] : rdataa_dmem[23:16],
+                             sel_wstrb_q[1] ? sel_wdata_q[15:8]  : rdataa_dmem[15:8],
+                             sel_wstrb_q[0] ? sel_wdata_q[7:0]   : rdataa_dmem[7:0]};
+
+    wire [31:0] resp_data = (sel_cmd_q == `L1_CMD_RDX) ? rdx_merge :
+                            (sel_is_sc_q) ? {31'b0, !sc_success_q} : rdataa_dmem;
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : gen_l1
+            l1_dcache l1_dcache (
+                .clk_i        (clk_i),                                         // input  wire
+                .re_i         (re_packed_i[i]),                                // input  wire
+                .we_i         (we_packed_i[i]),                                // input  wire
+                .addr_i       (addr_packed_i[DMEM_ADDRW*(i+1)-1:DMEM_ADDRW*i]), // input  wire [DMEM_ADDRW-1:0]
+                .wdata_i      (wdata_packed_i[32*(i+1)-1:32*i]),               // input  wire [31:0]
+                .wstrb_i      (wstrb_packed_i[4*(i+1)-1:4*i]),                 // input  wire [3:0]
+                .is_lr_i      (is_lr_packed_i[i]),                             // input  wire
+                .is_sc_i      (is_sc_packed_i[i]),                             // input  wire
+                .is_amo_i     (is_amo_packed_i[i]),                            // input  wire
+                .amo_op_i     (amo_op_packed_i[`AMO_OP_WIDTH*(i+1)-1:`AMO_OP_WIDTH*i]), // input  wire [`AMO_OP_WIDTH-1:0]
+                .rdata_o      (rdata_packed_o[32*(i+1)-1:32*i]),               // output wire [31:0]
+                .stall_o      (stall_packed_o[i]),                             // output wire
+                .bus_req_o    (bus_req[i]),                                    // output wire
+                .bus_cmd_o    (bus_cmd[i]),                                    // output wire [`L1_CMD_WIDTH-1:0]
+                .bus_addr_o   (bus_addr[i]),                                   // output wire [DMEM_ADDRW-1:0]
+                .bus_wdata_o  (bus_wdata[i]),                                  // output wire [31:0]
+                .bus_wstrb_o  (bus_wstrb[i]),                                  // output wire [3:0]
+                .bus_is_lr_o  (bus_is_lr[i]),                                  // output wire
+                .bus_is_sc_o  (bus_is_sc[i]),                                  // output wire
+                .bus_is_amo_o (bus_is_amo[i]),                                 // output wire
+                .bus_amo_op_o (bus_amo_op[i]),                                 // output wire [`AMO_OP_WIDTH-1:0]
+                .bus_gnt_i    (bus_fire && (sel_core_arb == i)),               // input  wire
+                .bus_ack_i    (is_resp && (sel_core_q == i)),                  // input  wire
+                .bus_rdata_i  (resp_data),                                     // input  wire [31:0]
+                .snoop_valid_i(snoop_valid),                                   // input  wire
+                .snoop_inv_i  (snoop_inv),                                     // input  wire
+                .snoop_addr_i (sel_addr_q),                                    // input  wire [DMEM_ADDRW-1:0]
+                .snoop_hit_m_o(snoop_hit_m[i]),                                // output wire
+                .snoop_data_o (snoop_data[i])                                  // output wire [31:0]
+            );
+            assign bus_req_packed[i] = bus_req[i];
+        end
+    endgenerate
+
+    single_issue_arbiter #(
+        .NCORES(NCORES)
+    ) arbiter (
+        .rr_ptr_i   (rr_ptr_q),
+        .req_valid_i(bus_req_packed),
+        .valid_o    (sel_valid_arb),
+        .selector_o (sel_core_arb)
+    );
+
+    always @(*) begin
+        owner_hit  = 1'b0;
+        owner_data = 32'h0;
+        for (m = 0; m < NCORES; m = m + 1) begin
+            owner_hit  = owner_hit  | snoop_hit_m[m];
+            owner_data = owner_data | snoop_data[m];
+        end
+    end
+
+    always @(*) begin
+        state_d    = state_q;
+        rea_int    = 1'b0;
+        wea_int    = 1'b0;
+        addra_int  = sel_addr_q;
+        wdataa_int = sel_wdata_q;
+        wstrba_int = sel_wstrb_q;
+
+        case (state_q)
+            IDLE: begin
+                if (bus_fire) begin
+                    state_d = (bus_cmd[sel_core_arb] == `L1_CMD_WB) ? ACCESS : SNOOP;
+                end
+            end
+            SNOOP: begin
+                // The owner gives up its modified copy, the data memory becomes up to date
+                state_d    = ACCESS;
+                wea_int    = owner_hit;
+                wdataa_int = owner_data;
+                wstrba_int = 4'hf;
+            end
+            ACCESS: begin
+                state_d = RESP;
+                if (sel_cmd_q == `L1_CMD_WB) begin
+                    wea_int = 1'b1;
+                end else if (sel_is_sc_q) begin
+                    wea_int = sc_success_q;
+                end else begin
+                    rea_int = 1'b1;
+                end
+            end
+            RESP: begin
+                state_d    = IDLE;
+                wea_int    = sel_is_amo_q;
+                wdataa_int = amo_rslt;
+                wstrba_int = 4'hf;
+            end
+            default: begin
+                state_d = IDLE;
+            end
+        endcase
+    end
+
+    always @(posedge clk_i) begin
+        state_q <= state_d;
+
+        if (bus_fire) begin
+            sel_core_q  <= sel_core_arb;
+            sel_cmd_q   <= bus_cmd[sel_core_arb];
+            sel_addr_q  <= bus_addr[sel_core_arb];
+            sel_wdata_q <= bus_wdata[sel_core_arb];
+            sel_wstrb_q <= bus_wstrb[sel_core_arb];
+            sel_is_lr_q <= (bus_cmd[sel_core_arb] == `L1_CMD_ATOMIC) && bus_is_lr[sel_core_arb];
+            sel_is_sc_q <= (bus_cmd[sel_core_arb] == `L1_CMD_ATOMIC) && bus_is_sc[sel_core_arb];
+            sel_is_amo_q <= (bus_cmd[sel_core_arb] == `L1_CMD_ATOMIC) && bus_is_amo[sel_core_arb];
+            sel_amo_op_q <= bus_amo_op[sel_core_arb];
+            rr_ptr_q    <= (sel_core_arb + 1) % NCORES;
+        end
+
+        if (state_q == SNOOP) begin
+            if (sel_is_lr_q) begin
+                reservation_valid_q[sel_core_q] <= 1'b1;
+                reservation_addr_q[sel_core_q]  <= sel_addr_q;
+            end else if (sel_is_sc_q) begin
+                sc_success_q <= reservation_valid_q[sel_core_q]
+                                && (reservation_addr_q[sel_core_q] == sel_addr_q);
+                if (reservation_valid_q[sel_core_q] && (reservation_addr_q[sel_core_q] == sel_addr_q)) begin
+                    for (j = 0; j < NCORES; j = j + 1) begin
+                        if (reservation_valid_q[j] && reservation_addr_q[j] == sel_addr_q) begin
+                            reservation_valid_q[j] <= 1'b0;
+                        end
+                    end
+                end
+            end else if (sel_cmd_q == `L1_CMD_RDX || sel_is_amo_q) begin
+                // Gaining ownership is the point where a cached store becomes visible
+                for (j = 0; j < NCORES; j = j + 1) begin
+                    if (reservation_valid_q[j] && reservation_addr_q[j] == sel_addr_q) begin
+                        reservation_valid_q[j] <= 1'b0;
+                    end
+                end
+            end
+        end
+    end
+
+    amo_alu amo_alu (
+        .op_i  (sel_amo_op_q),  // input  wire [`AMO_OP_WIDTH-1:0]
+        .mem_i (rdataa_dmem),   // input  wire [31:0]
+        .src_i (sel_wdata_q),   // input  wire [31:0]
+        .rslt_o(amo_rslt)       // output wire [31:0]
+    );
+
+    m_dmem dmem (
+        .clk_i   (clk_i),            // input  wire
+        .rea_i   (rea_int),          // input  wire
+        .reb_i   (1'b0),             // input  wire
+        .wea_i   (wea_int),          // input  wire
+        .web_i   (1'b0),             // input  wire
+        .addra_i (addra_int),        // input  wire [ADDR_WIDTH-1:0]
+        .addrb_i ({DMEM_ADDRW{1'b0}}), // input  wire [ADDR_WIDTH-1:0]
+        .wdataa_i(wdataa_int),       // input  wire [DATA_WIDTH-1:0]
+        .wdatab_i(32'h0),            // input  wire [DATA_WIDTH-1:0]
+        .wstrba_i(wstrba_int),       // input  wire [STRB_WIDTH-1:0]
+        .wstrbb_i(4'h0),             // input  wire [STRB_WIDTH-1:0]
+        .rdataa_o(rdataa_dmem),      // output wire [DATA_WIDTH-1:0]
+        .rdatab_o()                  // output wire [DATA_WIDTH-1:0]
+    );
+endmodule
+
+`resetall
@@ -0,0 +1,242 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Per-core write-back L1 data cache (direct-mapped, one word per line)
+// Line states follow MSI: I (!valid), S (valid & !dirty), M (valid & dirty).
+// Hits are served locally in one cycle, misses and LR/SC/AMO go to l1_dmem_controller.
+module l1_dcache #(
+    parameter DMEM_ADDRW = `DMEM_ADDRW,
+    parameter L1_ENTRIES = `L1_DCACHE_ENTRIES
+) (
+    input  wire                     clk_i,
+    // core side
+    input  wire                     re_i,
+    input  wire                     we_i,
+    input  wire    [DMEM_ADDRW-1:0] addr_i,
+    input  wire              [31:0] wdata_i,
+    input  wire               [3:0] wstrb_i,
+    input  wire                     is_lr_i,
+    input  wire                     is_sc_i,
+    input  wire                     is_amo_i,
+    input  wire [`AMO_OP_WIDTH-1:0] amo_op_i,
+    output wire              [31:0] rdata_o,
+    output wire                     stall_o,
+    // bus side
+    output wire                     bus_req_o,
+    output wire [`L1_CMD_WIDTH-1:0] bus_cmd_o,
+    output wire    [DMEM_ADDRW-1:0] bus_addr_o,
+    output wire              [31:0] bus_wdata_o,
+    output wire               [3:0] bus_wstrb_o,
+    output wire                     bus_is_lr_o,
+    output wire                     bus_is_sc_o,
+    output wire                     bus_is_amo_o,
+    output wire [`AMO_OP_WIDTH-1:0] bus_amo_op_o,
+    input  wire                     bus_gnt_i,
+    input  wire                     bus_ack_i,
+    input  wire              [31:0] bus_rdata_i,
+    // snoop
+    input  wire                     snoop_valid_i,
+    input  wire                     snoop_inv_i,
+    input  wire    [DMEM_ADDRW-1:0] snoop_addr_i,
+    output wire                     snoop_hit_m_o,
+    output wire              [31:0] snoop_data_o
+);
+    integer k;
+
+    localparam IDXW = $clog2(L1_ENTRIES);
+    localparam TAGW = DMEM_ADDRW - IDXW;
+
+    // Statemachine
+    localparam IDLE = 'd0;    // accept a new request from the core
+    localparam LOOKUP = 'd1;  // retry the pending request (snoop conflict or dropped write-back)
+    localparam WB = 'd2;      // write back the modified victim
+    localparam BUS = 'd3;     // wait for the bus transaction of the pending request
+    localparam STATE_WIDTH = 'd4;
+
+    reg [$clog2(STATE_WIDTH)-1:0] state_q = IDLE;
+    reg [$clog2(STATE_WIDTH)-1:0] state_d;
+
+    // Cache arrays
+    reg                                line_v   [0:L1_ENTRIES-1];
+    reg                                line_d   [0:L1_ENTRIES-1];
+    (* ram_style = "distributed" *) reg [TAGW-1:0] line_tag [0:L1_ENTRIES-1];
+    (* ram_style = "distributed" *) reg     [31:0] line_data[0:L1_ENTRIES-1];
+    initial for (k = 0; k < L1_ENTRIES; k = k + 1) begin
+        line_v[k] = 1'b0;
+        line_d[k] = 1'b0;
+    end
+
+    // Pending request
+    reg                     req_re_q;
+    reg    [DMEM_ADDRW-1:0] req_addr_q;
+    reg              [31:0] req_wdata_q;
+    reg               [3:0] req_wstrb_q;
+    reg                     req_is_lr_q;
+    reg                     req_is_sc_q;
+    reg                     req_is_amo_q;
+    reg [`AMO_OP_WIDTH-1:0] req_amo_op_q;
+    reg                     bus_req_q = 1'b0;
+    reg [`L1_CMD_WIDTH-1:0] bus_cmd_q;
+
+    reg                     bus_req_d;
+    reg [`L1_CMD_WIDTH-1:0] bus_cmd_d;
+
+    reg        stall_q = 1'b0;
+    reg        stall_d;
+    reg [31:0] rdata_q = 32'h0;
+
+    // Request under evaluation: a new one from the core in IDLE, the pending one otherwise
+    wire                  cur_new   = (state_q == IDLE);
+    wire                  cur_valid = cur_new ? (re_i || we_i) : (state_q == LOOKUP);
+    wire                  cur_re    = cur_new ? re_i      : req_re_q;
+    wire [DMEM_ADDRW-1:0] cur_addr  = cur_new ? addr_i    : req_addr_q;
+    wire           [31:0] cur_wdata = cur_new ? wdata_i   : req_wdata_q;
+    wire            [3:0] cur_wstrb = cur_new ? wstrb_i   : req_wstrb_q;
+    wire                  cur_is_lr = cur_new ? is_lr_i   : req_is_lr_q;
+    wire                  cur_is_sc = cur_new ? is_sc_i   : req_is_sc_q;
+    wire                  cur_is_amo = cur_new ? is_amo_i : req_is_amo_q;
+
+    wire [IDXW-1:0] cur_idx = cur_addr[IDXW-1:0];
+    wire [TAGW-1:0] cur_tag = cur_addr[DMEM_ADDRW-1:IDXW];
+    wire cur_hit            = line_v[cur_idx] && (line_tag[cur_idx] == cur_tag);
+    wire cur_atomic         = cur_is_lr || cur_is_sc || cur_is_amo;
+    wire cur_victim_m       = line_v[cur_idx] && line_d[cur_idx] && (line_tag[cur_idx] != cur_tag);
+    // The line being snooped this cycle must not be touched by the core at the same time
+    wire snoop_conflict     = snoop_valid_i && (snoop_addr_i[IDXW-1:0] == cur_idx);
+    // Loads hit in S or M, stores hit only in M
+    wire cur_serve          = cur_valid && !cur_atomic && !snoop_conflict && cur_hit
+                              && (cur_re || line_d[cur_idx]);
+
+    wire [31:0] cur_line  = line_data[cur_idx];
+    wire [31:0] cur_merge = {cur_wstrb[3] ? cur_wdata[31:24] : cur_line[31:24],
+                             cur_wstrb[2] ? cur_wdata[23:16] : cur_line[23:16],
+                             cur_wstrb[1] ? cur_wdata[15:8]  : cur_line[15:8],
+                             cur_wstrb[0] ? cur_wdata[7:0]   : cur_line[7:0]};
+
+    // Victim of the pending request, dropped when a snoop has already taken the line away
+    wire [IDXW-1:0] req_idx  = req_addr_q[IDXW-1:0];
+    wire [TAGW-1:0] req_tag  = req_addr_q[DMEM_ADDRW-1:IDXW];
+    wire victim_still_m      = line_v[req_idx] && line_d[req_idx];
+
+    // Snooped line
+    wire [IDXW-1:0] snp_idx  = snoop_addr_i[IDXW-1:0];
+    wire snp_hit             = line_v[snp_idx]
+                               && (line_tag[snp_idx] == snoop_addr_i[DMEM_ADDRW-1:IDXW]);
+
+    assign bus_req_o   = bus_req_q && ((state_q != WB) || victim_still_m);
+    assign bus_cmd_o   = bus_cmd_q;
+    assign bus_addr_o  = (state_q == WB) ? {line_tag[req_idx], req_idx} : req_addr_q;
+    assign bus_wdata_o = (state_q == WB) ? line_data[req_idx] : req_wdata_q;
+    assign bus_wstrb_o = (state_q == WB) ? 4'hf : req_wstrb_q;
+    assign bus_is_lr_o = req_is_lr_q;
+    assign bus_is_sc_o = req_is_sc_q;
+    assign bus_is_amo_o = req_is_amo_q;
+    assign bus_amo_op_o = req_amo_op_q;
+
+    assign rdata_o = rdata_q;
+    assign stall_o = stall_q;
+
+    always @(*) begin
+        state_d   = state_q;
+        bus_req_d = bus_req_q && !bus_gnt_i;
+        bus_cmd_d = bus_cmd_q;
+        stall_d   = stall_q;
+
+        case (state_q)
+            IDLE, LOOKUP: begin
+                stall_d = cur_valid && !cur_serve;
+                if (cur_valid && !cur_serve) begin
+                    if (snoop_conflict) begin
+                        state_d = LOOKUP;
+                    end else if (cur_atomic) begin
+                        state_d   = BUS;
+                        bus_req_d = 1'b1;
+                        bus_cmd_d = `L1_CMD_ATOMIC;
+                    end else if (cur_victim_m) begin
+                        state_d   = WB;
+                        bus_req_d = 1'b1;
+                        bus_cmd_d = `L1_CMD_WB;
+                    end else begin
+                        state_d   = BUS;
+                        bus_req_d = 1'b1;
+                        bus_cmd_d = cur_re ? `L1_CMD_RD : `L1_CMD_RDX;
+                    end
+                end else if (state_q == LOOKUP) begin
+                    state_d = IDLE;
+                end
+            end
+            WB: begin
+                stall_d = 1'b1;
+                // a snoop before the grant may already have written the victim back
+                if (bus_ack_i || (bus_req_q && !victim_still_m)) begin
+                    state_d   = LOOKUP;
+                    bus_req_d = 1'b0;
+                end
+            end
+            BUS: begin
+                stall_d = !bus_ack_i;
+                if (bus_ack_i) begin
+                    state_d = IDLE;
+                end
+            end
+            default: begin
+                state_d = IDLE;
+            end
+        endcase
+    end
+
+    always @(posedge clk_i) begin
+        state_q   <= state_d;
+        stall_q   <= stall_d;
+        bus_req_q <= bus_req_d;
+        bus_cmd_q <= bus_cmd_d;
+
+        if (cur_new) begin
+            req_re_q    <= re_i;
+            req_addr_q  <= addr_i;
+            req_wdata_q <= wdata_i;
+            req_wstrb_q <= wstrb_i;
+            req_is_lr_q <= is_lr_i;
+            req_is_sc_q <= is_sc_i;
+            req_is_amo_q <= is_amo_i;
+            req_amo_op_q <= amo_op_i;
+        end
+
+        // Local hit
+        if (cur_serve) begin
+            if (cur_re) begin
+                rdata_q <= cur_line;
+            end else begin
+                line_data[cur_idx] <= cur_merge;
+            end
+        end
+
+        // Bus completion
+        if (bus_ack_i) begin
+            if (state_q == WB) begin
+                line_d[req_idx] <= 1'b0;
+            end else if (bus_cmd_q == `L1_CMD_ATOMIC) begin
+                rdata_q <= bus_rdata_i;
+            end else begin
+                line_v[req_idx]    <= 1'b1;
+                line_d[req_idx]    <= (bus_cmd_q == `L1_CMD_RDX);
+                line_tag[req_idx]  <= req_tag;
+                line_data[req_idx] <= bus_rdata_i;
+                rdata_q            <= bus_rdata_i;
+            end
+        end
+
+        // Snoop: invalidate on RDX/ATOMIC, downgrade M to S on RD (the bus writes the data back)
+        if (snoop_valid_i && snp_hit) begin
+            if (snoop_inv_i) line_v[snp_idx] <= 1'b0;
+            line_d[snp_idx] <= 1'b0;
+        end
+    end
+
+    assign snoop_hit_m_o = snoop_valid_i && snp_hit && line_d[snp_idx];
+    assign snoop_data_o  = snoop_hit_m_o ? line_data[snp_idx] : 32'h0;
+endmodule
+
+`resetall
@@ -0,0 +1,288 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Data memory controller with one read port per core
+// Every core reads its own replica of the data memory, so loads never wait for other cores.
+// Stores, SCs and AMOs share a single write port that updates all replicas in the same cycle.
+// With a single write port the live value table of an LVT multiport memory always points
+// at the same bank, so the replicas need no table. A read to the word being written in the
+// same cycle waits one cycle, which also keeps LR and the write ordered.
+module replicated_dmem_controller #(
+    parameter NCORES = `NCORES,
+    parameter DMEM_ADDRW = `DMEM_ADDRW
+) (
+    input wire clk_i,
+    input wire [NCORES-1:0] re_packed_i,
+    input wire [NCORES-1:0] we_packed_i,
+    input wire [DMEM_ADDRW*NCORES-1:0] addr_packed_i,
+    input wire [32*NCORES-1:0] wdata_packed_i,
+    input wire [4*NCORES-1:0] wstrb_packed_i,
+    input wire [NCORES-1:0] is_lr_packed_i,
+    input wire [NCORES-1:0] is_sc_packed_i,
+    input wire [NCORES-1:0] is_amo_packed_i,
+    input wire [`AMO_OP_WIDTH*NCORES-1:0] amo_op_packed_i,
+    output wire [32*NCORES-1:0] rdata_packed_o,
+    output wire [NCORES-1:0] stall_packed_o,
+    output wire [NCORES-1:0] rsv_valid_packed_o  // LR/SC reservation of each core, for wrs
+);
+    genvar i;
+    integer j;
+
+    localparam NCORES_W = (NCORES > 1) ? $clog2(NCORES) : 1;
+
+    // Unpack input arrays
+    wire                     re    [0:NCORES-1];
+    wire                     we    [0:NCORES-1];
+    wire    [DMEM_ADDRW-1:0] addr  [0:NCORES-1];
+    wire              [31:0] wdata [0:NCORES-1];
+    wire               [3:0] wstrb [0:NCORES-1];
+    wire                     is_lr [0:NCORES-1];
+    wire                     is_sc [0:NCORES-1];
+    wire                     is_amo[0:NCORES-1];
+    wire [`AMO_OP_WIDTH-1:0] amo_op[0:NCORES-1];
+    reg               [31:0] rdata [0:NCORES-1];
+    reg                      stall_d[0:NCORES-1];
+    reg                      stall_q[0:NCORES-1];
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : unpack_arrays
+            assign re[i]     = re_packed_i[i];
+            assign we[i]     = we_packed_i[i];
+            assign addr[i]   = addr_packed_i[DMEM_ADDRW*(i+1)-1:DMEM_ADDRW*i];
+            assign wdata[i]  = wdata_packed_i[32*(i+1)-1:32*i];
+            assign wstrb[i]  = wstrb_packed_i[4*(i+1)-1:4*i];
+            assign is_lr[i]  = is_lr_packed_i[i];
+            assign is_sc[i]  = is_sc_packed_i[i];
+            assign is_amo[i] = is_amo_packed_i[i];
+            assign amo_op[i] = amo_op_packed_i[`AMO_OP_WIDTH*(i+1)-1:`AMO_OP_WIDTH*i];
+            assign rdata_packed_o[32*(i+1)-1:32*i] = rdata[i];
+            assign stall_packed_o[i] = stall_q[i];
+        end
+    endgenerate
+
+    // Pending request registers for each core (to hold request info when stalled)
+    reg                     req_valid_q [0:NCORES-1];
+    reg                     req_re_q    [0:NCORES-1];
+    reg                     req_we_q    [0:NCORES-1];
+    reg    [DMEM_ADDRW-1:0] req_addr_q  [0:NCORES-1];
+    reg              [31:0] req_wdata_q [0:NCORES-1];
+    reg               [3:0] req_wstrb_q [0:NCORES-1];
+    reg                     req_is_lr_q [0:NCORES-1];
+    reg                     req_is_sc_q [0:NCORES-1];
+    reg                     req_is_amo_q[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] req_amo_op_q[0:NCORES-1];
+
+    // Effective request signals (combining new input and pending requests)
+    reg                     eff_re    [0:NCORES-1];
+    reg                     eff_we    [0:NCORES-1];
+    reg    [DMEM_ADDRW-1:0] eff_addr  [0:NCORES-1];
+    reg              [31:0] eff_wdata [0:NCORES-1];
+    reg               [3:0] eff_wstrb [0:NCORES-1];
+    reg                     eff_is_lr [0:NCORES-1];
+    reg                     eff_is_sc [0:NCORES-1];
+    reg                     eff_is_amo[0:NCORES-1];
+    reg [`AMO_OP_WIDTH-1:0] eff_amo_op[0:NCORES-1];
+
+    always @(*) begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            eff_re[j]     = req_valid_q[j] ? req_re_q[j]     : re[j];
+            eff_we[j]     = req_valid_q[j] ? req_we_q[j]     : we[j];
+            eff_addr[j]   = req_valid_q[j] ? req_addr_q[j]   : addr[j];
+            eff_wdata[j]  = req_valid_q[j] ? req_wdata_q[j]  : wdata[j];
+            eff_wstrb[j]  = req_valid_q[j] ? req_wstrb_q[j]  : wstrb[j];
+            eff_is_lr[j]  = req_valid_q[j] ? req_is_lr_q[j]  : is_lr[j];
+            eff_is_sc[j]  = req_valid_q[j] ? req_is_sc_q[j]  : is_sc[j];
+            eff_is_amo[j] = req_valid_q[j] ? req_is_amo_q[j] : is_amo[j];
+            eff_amo_op[j] = req_valid_q[j] ? req_amo_op_q[j] : amo_op[j];
+        end
+    end
+
+    // Round-robin arbitration of the write port
+    wire   [NCORES-1:0] wr_req;
+    wire                wr_req_any;
+    wire [NCORES_W-1:0] wr_sel;
+    reg  [NCORES_W-1:0] rr_ptr_q = 0;
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : gen_wr_req
+            assign wr_req[i] = eff_we[i];
+        end
+    endgenerate
+
+    single_issue_arbiter #(
+        .NCORES(NCORES)
+    ) arbiter (
+        .rr_ptr_i   (rr_ptr_q),
+        .req_valid_i(wr_req),
+        .valid_o    (wr_req_any),
+        .selector_o (wr_sel)
+    );
+
+    // AMO write-back: the old value is read from the replica of the AMO core in the cycle the
+    // AMO is served and the new value is written in the next cycle, during which the write
+    // port does not accept another request
+    reg                     amo_wb_q = 1'b0;
+    reg    [NCORES_W-1:0]   amo_core_q;
+    reg    [DMEM_ADDRW-1:0] amo_addr_q;
+    reg              [31:0] amo_src_q;
+    reg [`AMO_OP_WIDTH-1:0] amo_op_q;
+    wire             [31:0] amo_rslt;
+
+    wire wr_valid = wr_req_any && !amo_wb_q;
+
+    // LR/SC reservation registers for each core
+    reg                  reservation_valid_q [0:NCORES-1];
+    reg [DMEM_ADDRW-1:0] reservation_addr_q  [0:NCORES-1];
+    reg                  reservation_valid_d [0:NCORES-1];
+    reg [DMEM_ADDRW-1:0] reservation_addr_d  [0:NCORES-1];
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : pack_rsv_valid
+            assign rsv_valid_packed_o[i] = reservation_valid_q[i];
+        end
+    endgenerate
+
+    // Write port of the replicas
+    reg                  wport_we;
+    reg [DMEM_ADDRW-1:0] wport_addr;
+    reg           [31:0] wport_wdata;
+    reg            [3:0] wport_wstrb;
+    reg                  sc_success;
+
+    // Read ports of the replicas
+    reg         rport_re   [0:NCORES-1];
+    wire [31:0] rport_rdata[0:NCORES-1];
+
+    // Return path
+    reg served      [0:NCORES-1];
+    reg ret_valid_q [0:NCORES-1];
+    reg ret_is_sc_q [0:NCORES-1];
+    reg sc_success_q = 1'b0;
+
+    always @(*) begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            reservation_valid_d[j] = reservation_valid_q[j];
+            reservation_addr_d[j]  = reservation_addr_q[j];
+        end
+
+        wport_we    = 1'b0;
+        wport_addr  = eff_addr[wr_sel];
+        wport_wdata = eff_wdata[wr_sel];
+        wport_wstrb = eff_wstrb[wr_sel];
+        sc_success  = 1'b0;
+
+        if (amo_wb_q) begin
+            wport_we    = 1'b1;
+            wport_addr  = amo_addr_q;
+            wport_wdata = amo_rslt;
+            wport_wstrb = 4'hf;
+        end else if (wr_valid) begin
+            if (eff_is_sc[wr_sel]) begin
+                // SC succeeds if reservation is valid and address matches
+                sc_success = reservation_valid_q[wr_sel] && (reservation_addr_q[wr_sel] == eff_addr[wr_sel]);
+                wport_we   = sc_success;
+            end else if (!eff_is_amo[wr_sel]) begin
+                wport_we   = 1'b1;
+            end
+
+            // Stores, successful SCs and AMOs invalidate reservations for this address
+            if (!eff_is_sc[wr_sel] || sc_success) begin
+                for (j = 0; j < NCORES; j = j + 1) begin
+                    if (reservation_valid_q[j] && reservation_addr_q[j] == eff_addr[wr_sel]) begin
+                        reservation_valid_d[j] = 1'b0;
+                    end
+                end
+            end
+        end
+
+        for (j = 0; j < NCORES; j = j + 1) begin
+            // A read waits while the same word is written
+            served[j]   = (eff_re[j] && !(wport_we && wport_addr == eff_addr[j]))
+                       || (wr_valid && wr_sel == j);
+            stall_d[j]  = (eff_re[j] || eff_we[j]) && !served[j];
+            rport_re[j] = served[j] && (eff_re[j] || eff_is_amo[j]);
+
+            // LR is applied after the invalidations so that a reservation made in this cycle stays
+            if (served[j] && eff_re[j] && eff_is_lr[j]) begin
+                reservation_valid_d[j] = 1'b1;
+                reservation_addr_d[j]  = eff_addr[j];
+            end
+        end
+
+        // Output read data
+        for (j = 0; j < NCORES; j = j + 1) begin
+            rdata[j] = (!ret_valid_q[j]) ? 32'h0 :
+                       (ret_is_sc_q[j]) ? {31'b0, !sc_success_q} : rport_rdata[j];
+        end
+    end
+
+    always @(posedge clk_i) begin
+        amo_wb_q     <= wr_valid && eff_is_amo[wr_sel];
+        sc_success_q <= sc_success;
+        if (wr_valid) begin
+            rr_ptr_q   <= (wr_sel + 1) % NCORES;
+            amo_core_q <= wr_sel;
+            amo_addr_q <= eff_addr[wr_sel];
+            amo_src_q  <= eff_wdata[wr_sel];
+            amo_op_q   <= eff_amo_op[wr_sel];
+        end
+
+        for (j = 0; j < NCORES; j = j + 1) begin
+            stall_q[j]             <= stall_d[j];
+            ret_valid_q[j]         <= served[j];
+            ret_is_sc_q[j]         <= served[j] && eff_is_sc[j];
+            reservation_valid_q[j] <= reservation_valid_d[j];
+            reservation_addr_q[j]  <= reservation_addr_d[j];
+
+            // Save request if stalled and not already pending
+            if (stall_d[j] && !req_valid_q[j]) begin
+                req_valid_q[j]  <= 1'b1;
+                req_re_q[j]     <= re[j];
+                req_we_q[j]     <= we[j];
+                req_addr_q[j]   <= addr[j];
+                req_wdata_q[j]  <= wdata[j];
+                req_wstrb_q[j]  <= wstrb[j];
+                req_is_lr_q[j]  <= is_lr[j];
+                req_is_sc_q[j]  <= is_sc[j];
+                req_is_amo_q[j] <= is_amo[j];
+                req_amo_op_q[j] <= amo_op[j];
+            end else if (served[j]) begin
+                req_valid_q[j] <= 1'b0;
+            end
+        end
+    end
+
+    amo_alu amo_alu (
+        .op_i  (amo_op_q),                 // input  wire [`AMO_OP_WIDTH-1:0]
+        .mem_i (rport_rdata[amo_core_q]),  // input  wire [31:0]
+        .src_i (amo_src_q),                // input  wire [31:0]
+        .rslt_o(amo_rslt)                  // output wire [31:0]
+    );
+
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : gen_replica
+            m_dmem_replica replica (
+                .clk_i  (clk_i),           // input  wire
+                .we_i   (wport_we),        // input  wire
+                .waddr_i(wport_addr),      // input  wire [DMEM_ADDRW-1:0]
+                .wdata_i(wport_wdata),     // input  wire [31:0]
+                .wstrb_i(wport_wstrb),     // input  wire [3:0]
+                .re_i   (rport_re[i]),     // input  wire
+                .raddr_i(eff_addr[i]),     // input  wire [DMEM_ADDRW-1:0]
+                .rdata_o(rport_rdata[i])   // output wire [31:0]
+            );
+        end
+    endgenerate
+
+    initial begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            req_valid_q[j]         = 1'b0;
+            reservation_valid_q[j] = 1'b0;
+            ret_valid_q[j]         = 1'b0;
+        end
+    end
+endmodule
+
+`resetall
@@ -0,0 +1,117 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Hardware queued locks with NLOCKS locks, mapped at 0x40004000
+//   0x000 + 4*l : acquire lock l (load), stalls until the lock is granted, then returns 1
+//                 release lock l (store), the lock passes to the oldest waiter if any
+//   0x100 + 4*l : try to acquire lock l (load), returns 1 if acquired and 0 otherwise
+//   0xFFC       : the number of locks (load), zero when the unit is not present
+// Each lock is a ticket lock: a request takes the next ticket and is granted when the
+// serving ticket reaches it, so the waiters are granted in FIFO order.
+module hwlock_unit #(
+    parameter NCORES = `NCORES,
+    parameter NLOCKS = `HW_LOCKS
+) (
+    input  wire                 clk_i,
+    input  wire [NCORES-1:0]    re_packed_i,
+    input  wire [NCORES-1:0]    we_packed_i,
+    input  wire [10*NCORES-1:0] addr_packed_i,   // word address within the 4 KiB page
+    output wire [32*NCORES-1:0] rdata_packed_o,
+    output wire [NCORES-1:0]    stall_packed_o
+);
+    localparam LOCKW = (NLOCKS > 1) ? $clog2(NLOCKS) : 1;
+    localparam TW    = $clog2(NCORES) + 1;  // a lock has at most NCORES tickets outstanding
+    integer l, j;
+
+    reg     [TW-1:0] next_q    [0:NLOCKS-1];
+    reg     [TW-1:0] serving_q [0:NLOCKS-1];
+    reg [NCORES-1:0] waiting_q = 0;
+    reg  [LOCKW-1:0] lock_q    [0:NCORES-1];
+    reg     [TW-1:0] ticket_q  [0:NCORES-1];
+    reg       [31:0] rdata_q   [0:NCORES-1];
+
+    initial begin
+        for (l = 0; l < NLOCKS; l = l + 1) begin
+            next_q[l]    = 0;
+            serving_q[l] = 0;
+        end
+    end
+
+    // Request decode
+    wire       [9:0] addr      [0:NCORES-1];
+    wire [LOCKW-1:0] lock_id   [0:NCORES-1];
+    wire [NCORES-1:0] is_acquire;
+    wire [NCORES-1:0] is_try;
+    wire [NCORES-1:0] is_release;
+    genvar i;
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : gen_decode
+            assign addr[i]       = addr_packed_i[10*i +: 10];
+            assign lock_id[i]    = addr[i][LOCKW-1:0];
+            assign is_acquire[i] = re_packed_i[i] && (addr[i][9:6] == 4'h0) && (addr[i][5:0] < NLOCKS);
+            assign is_try[i]     = re_packed_i[i] && (addr[i][9:6] == 4'h1) && (addr[i][5:0] < NLOCKS);
+            assign is_release[i] = we_packed_i[i] && (addr[i][9:6] == 4'h0) && (addr[i][5:0] < NLOCKS);
+
+            assign rdata_packed_o[32*i +: 32] = rdata_q[i];
+            assign stall_packed_o[i]          = waiting_q[i];
+        end
+    endgenerate
+
+    // Tickets are handed out in core index order among the requests of the same cycle.
+    // A try takes a ticket only when the lock is free and nobody else requests it earlier.
+    reg     [TW-1:0] taken     [0:NLOCKS-1];
+    reg     [TW-1:0] next_d    [0:NLOCKS-1];
+    reg     [TW-1:0] serving_d [0:NLOCKS-1];
+    reg [NCORES-1:0] take;
+    reg     [TW-1:0] ticket_d  [0:NCORES-1];
+    always @(*) begin
+        for (l = 0; l < NLOCKS; l = l + 1) taken[l] = 0;
+        for (j = 0; j < NCORES; j = j + 1) begin
+            take[j]     = 1'b0;
+            ticket_d[j] = 0;
+            for (l = 0; l < NLOCKS; l = l + 1) begin
+                if (lock_id[j] == l) begin
+                    ticket_d[j] = next_q[l] + taken[l];
+                    take[j]     = is_acquire[j] ||
+                                  (is_try[j] && serving_q[l] == next_q[l] && taken[l] == 0);
+                    if (take[j]) taken[l] = taken[l] + 1;
+                end
+            end
+        end
+        for (l = 0; l < NLOCKS; l = l + 1) begin
+            next_d[l]    = next_q[l] + taken[l];
+            serving_d[l] = serving_q[l];
+            for (j = 0; j < NCORES; j = j + 1) begin
+                if (is_release[j] && lock_id[j] == l && serving_q[l] != next_q[l])
+                    serving_d[l] = serving_q[l] + 1;
+            end
+        end
+    end
+
+    always @(posedge clk_i) begin
+        for (l = 0; l < NLOCKS; l = l + 1) begin
+            next_q[l]    <= next_d[l];
+            serving_q[l] <= serving_d[l];
+        end
+
+        for (j = 0; j < NCORES; j = j + 1) begin
+            if (is_acquire[j]) begin
+                lock_q[j]    <= lock_id[j];
+                ticket_q[j]  <= ticket_d[j];
+                waiting_q[j] <= (ticket_d[j] != serving_d[lock_id[j]]);
+            end else if (waiting_q[j] && ticket_q[j] == serving_d[lock_q[j]]) begin
+                waiting_q[j] <= 1'b0;
+            end
+
+            if (re_packed_i[j]) begin
+                rdata_q[j] <= is_acquire[j] ? 1 :
+                              is_try[j] ? take[j] :
+                              (addr[j] == 10'h3ff) ? NLOCKS : 0;
+            end
+        end
+    end
+endmodule
+
+`resetall
@@ -0,0 +1,139 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Per-core hardware mailbox FIFOs of DEPTH words, mapped at 0x40005000
+//   0x000 + 4*c : push a word into the inbox of core c (store), stalls while the inbox is full
+//   0x100       : pop a word from the own inbox (load), stalls while the inbox is empty
+//   0x104       : pop a word from the own inbox (load), returns 0 when the inbox is empty
+//   0x108       : the number of words in the own inbox (load)
+//   0x200 + 4*c : the number of words in the inbox of core c (load)
+//   0xFFC       : the inbox depth (load), zero when the unit is not present
+// Each inbox accepts one push per cycle, and the pushing cores are served in round-robin order.
+module mailbox_unit #(
+    parameter NCORES = `NCORES,
+    parameter DEPTH  = `MBOX_DEPTH
+) (
+    input  wire                 clk_i,
+    input  wire [NCORES-1:0]    re_packed_i,
+    input  wire [NCORES-1:0]    we_packed_i,
+    input  wire [10*NCORES-1:0] addr_packed_i,   // word address within the 4 KiB page
+    input  wire [32*NCORES-1:0] wdata_packed_i,
+    output wire [32*NCORES-1:0] rdata_packed_o,
+    output wire [NCORES-1:0]    stall_packed_o
+);
+    localparam CW   = (NCORES > 1) ? $clog2(NCORES) : 1;
+    localparam PTRW = (DEPTH > 1) ? $clog2(DEPTH) : 1;
+    integer c, j, k, p;
+
+    // Inboxes
+    reg     [31:0] fifo    [0:NCORES*DEPTH-1];
+    reg [PTRW-1:0] head_q  [0:NCORES-1];
+    reg [PTRW-1:0] tail_q  [0:NCORES-1];
+    reg   [PTRW:0] count_q [0:NCORES-1];
+
+    // A push or a blocking pop that could not be completed in the cycle it was presented
+    reg [NCORES-1:0] push_wait_q = 0;
+    reg     [CW-1:0] push_dst_q  [0:NCORES-1];
+    reg       [31:0] push_data_q [0:NCORES-1];
+    reg [NCORES-1:0] pop_wait_q  = 0;
+    reg       [31:0] rdata_q     [0:NCORES-1];
+    reg     [CW-1:0] rr_q        = 0;
+
+    initial begin
+        for (c = 0; c < NCORES; c = c + 1) begin
+            head_q[c]  = 0;
+            tail_q[c]  = 0;
+            count_q[c] = 0;
+        end
+    end
+
+    // Request decode
+    wire       [9:0] addr     [0:NCORES-1];
+    wire [NCORES-1:0] is_push;
+    wire [NCORES-1:0] is_pop;
+    wire [NCORES-1:0] is_trypop;
+    genvar i;
+    generate
+        for (i = 0; i < NCORES; i = i + 1) begin : gen_decode
+            assign addr[i]      = addr_packed_i[10*i +: 10];
+            assign is_push[i]   = we_packed_i[i] && (addr[i][9:6] == 4'h0) && (addr[i][5:0] < NCORES);
+            assign is_pop[i]    = re_packed_i[i] && (addr[i] == 10'h040);
+            assign is_trypop[i] = re_packed_i[i] && (addr[i] == 10'h041);
+
+            assign rdata_packed_o[32*i +: 32] = rdata_q[i];
+            assign stall_packed_o[i]          = push_wait_q[i] || pop_wait_q[i];
+        end
+    endgenerate
+
+    // Push requests of this cycle, a new store or a waiting one
+    reg [NCORES-1:0] push_req;
+    reg     [CW-1:0] push_dst  [0:NCORES-1];
+    reg       [31:0] push_data [0:NCORES-1];
+    always @(*) begin
+        for (j = 0; j < NCORES; j = j + 1) begin
+            push_req[j]  = push_wait_q[j] || is_push[j];
+            push_dst[j]  = push_wait_q[j] ? push_dst_q[j] : addr[j][CW-1:0];
+            push_data[j] = push_wait_q[j] ? push_data_q[j] : wdata_packed_i[32*j +: 32];
+        end
+    end
+
+    // Each inbox with space accepts the first requester starting from rr_q
+    reg [NCORES-1:0] push_acc;
+    reg [NCORES-1:0] inbox_busy;
+    always @(*) begin
+        push_acc   = 0;
+        inbox_busy = 0;
+        for (k = 0; k < NCORES; k = k + 1) begin
+            p = rr_q + k;
+            if (p >= NCORES) p = p - NCORES;
+            if (push_req[p] && !inbox_busy[push_dst[p]] && count_q[push_dst[p]] < DEPTH) begin
+                push_acc[p]             = 1'b1;
+                inbox_busy[push_dst[p]] = 1'b1;
+            end
+        end
+    end
+
+    // The owner pops its inbox with a new load or a waiting one
+    reg [NCORES-1:0] pop_req;
+    reg [NCORES-1:0] pop_acc;
+    always @(*) begin
+        for (c = 0; c < NCORES; c = c + 1) begin
+            pop_req[c] = pop_wait_q[c] || is_pop[c] || is_trypop[c];
+            pop_acc[c] = pop_req[c] && (count_q[c] != 0);
+        end
+    end
+
+    always @(posedge clk_i) begin
+        rr_q <= (rr_q == NCORES - 1) ? 0 : rr_q + 1;
+
+        for (j = 0; j < NCORES; j = j + 1) begin
+            if (push_acc[j]) begin
+                fifo[push_dst[j]*DEPTH + tail_q[push_dst[j]]] <= push_data[j];
+            end
+            push_wait_q[j] <= push_req[j] && !push_acc[j];
+            if (is_push[j]) begin
+                push_dst_q[j]  <= addr[j][CW-1:0];
+                push_data_q[j] <= wdata_packed_i[32*j +: 32];
+            end
+        end
+
+        for (c = 0; c < NCORES; c = c + 1) begin
+            if (inbox_busy[c]) tail_q[c] <= tail_q[c] + 1;
+            if (pop_acc[c])    head_q[c] <= head_q[c] + 1;
+            count_q[c] <= count_q[c] + inbox_busy[c] - pop_acc[c];
+
+            pop_wait_q[c] <= (pop_wait_q[c] || is_pop[c]) && !pop_acc[c];
+            if (pop_acc[c]) begin
+                rdata_q[c] <= fifo[c*DEPTH + head_q[c]];
+            end else if (re_packed_i[c]) begin
+                rdata_q[c] <= (addr[c] == 10'h042) ? count_q[c] :
+                              (addr[c][9:6] == 4'h2 && addr[c][5:0] < NCORES) ? count_q[addr[c][CW-1:0]] :
+                              (addr[c] == 10'h3ff) ? DEPTH : 0;
+            end
+        end
+    end
+endmodule
+
+`resetall
@@ -16,7 +16,15 @@ module main #(
     parameter VMEM_WDATAW = 3,
     parameter STACK_SIZE = `STACK_SIZE,
     parameter STACK_ADDRW = `STACK_ADDRW,
-    parameter NCORES     = `NCORES
+    parameter TCM_SIZE = `TCM_SIZE,
+    parameter TCM_ADDRW = `TCM_ADDRW,
+    parameter NCORES     = `NCORES,
+    parameter CLUSTER_SIZE = `CLUSTER_SIZE,
+    parameter CMEM_ADDRW = `CMEM_ADDRW,
+    parameter HW_BARRIER_SLOTS = `HW_BARRIER_SLOTS,
+    parameter HW_LOCKS = `HW_LOCKS,
+    parameter MBOX_DEPTH = `MBOX_DEPTH,
+    parameter HW_DISPENSERS = `HW_DISPENSERS
 ) (
     input  wire clk_i,
     output wire st7789_SDA,
@@ -49,9 +57,24 @@ module main #(
     wire [DBUS_STRB_WIDTH-1:0] dbus_wstrb[0:NCORES-1];
     wire                       dbus_is_lr[0:NCORES-1];
     wire                       dbus_is_sc[0:NCORES-1];
+    wire                       dbus_is_amo[0:NCORES-1];
+    wire   [`AMO_OP_WIDTH-1:0] dbus_amo_op[0:NCORES-1];
     wire [DBUS_DATA_WIDTH-1:0] dbus_rdata[0:NCORES-1];
     wire                       dbus_stall[0:NCORES-1];
 
+    // Data bus of the cpus, connected to dbus_* directly or through the store buffers
+    wire                       cpu_dbus_we    [0:NCORES-1];
+    wire [DBUS_ADDR_WIDTH-1:0] cpu_dbus_addr  [0:NCORES-1];
+    wire [DBUS_DATA_WIDTH-1:0] cpu_dbus_wdata [0:NCORES-1];
+    wire [DBUS_STRB_WIDTH-1:0] cpu_dbus_wstrb [0:NCORES-1];
+    wire                       cpu_dbus_is_lr [0:NCORES-1];
+    wire                       cpu_dbus_is_sc [0:NCORES-1];
+    wire                       cpu_dbus_is_amo[0:NCORES-1];
+    wire   [`AMO_OP_WIDTH-1:0] cpu_dbus_amo_op[0:NCORES-1];
+    wire                       cpu_dbus_is_fence[0:NCORES-1];
+    wire [DBUS_DATA_WIDTH-1:0] cpu_dbus_rdata [0:NCORES-1];
+    wire                       cpu_dbus_stall [0:NCORES-1];
+
     wire [31:0] hart_rdata[0:NCORES-1];
 
     wire                  dmem_we    [0:NCORES-1];
@@ -67,6 +90,12 @@ module main #(
     wire [VMEM_WDATAW-1:0] vmem_wdata [0:NCORES-1];
     wire                   vmem_stall[0:NCORES-1];
 
+    wire                  cmem_we    [0:NCORES-1];
+    wire                  cmem_re    [0:NCORES-1];
+    wire [CMEM_ADDRW-1:0] cmem_addr  [0:NCORES-1];
+    wire           [31:0] cmem_rdata [0:NCORES-1];
+    wire                  cmem_stall [0:NCORES-1];
+
     wire                   stack_we    [0:NCORES-1];
     wire                   stack_re    [0:NCORES-1];
     wire [STACK_ADDRW-1:0] stack_addr  [0:NCORES-1];
@@ -82,8 +111,90 @@ module main #(
     wire [4*NCORES-1:0] dmem_wstrb_packed;
     wire [NCORES-1:0] dmem_is_lr_packed;
     wire [NCORES-1:0] dmem_is_sc_packed;
+    wire [NCORES-1:0] dmem_is_amo_packed;
+    wire [`AMO_OP_WIDTH*NCORES-1:0] dmem_amo_op_packed;
     wire [32*NCORES-1:0] dmem_rdata_packed;
     wire [NCORES-1:0] dmem_stall_packed;
+    wire [NCORES-1:0] dmem_rsv_valid_packed;
+
+    // Ports of the global data memory controller, one per cluster with USE_CLUSTERED_DMEM
+`ifdef USE_CLUSTERED_DMEM
+    localparam DMEM_NPORTS = NCORES / CLUSTER_SIZE;
+`else
+    localparam DMEM_NPORTS = NCORES;
+`endif
+    wire [DMEM_NPORTS-1:0] gdmem_re_packed;
+    wire [DMEM_NPORTS-1:0] gdmem_we_packed;
+    wire [DMEM_ADDRW*DMEM_NPORTS-1:0] gdmem_addr_packed;
+    wire [32*DMEM_NPORTS-1:0] gdmem_wdata_packed;
+    wire [4*DMEM_NPORTS-1:0] gdmem_wstrb_packed;
+    wire [DMEM_NPORTS-1:0] gdmem_is_lr_packed;
+    wire [DMEM_NPORTS-1:0] gdmem_is_sc_packed;
+    wire [DMEM_NPORTS-1:0] gdmem_is_amo_packed;
+    wire [`AMO_OP_WIDTH*DMEM_NPORTS-1:0] gdmem_amo_op_packed;
+    wire [32*DMEM_NPORTS-1:0] gdmem_rdata_packed;
+    wire [DMEM_NPORTS-1:0] gdmem_stall_packed;
+    wire [DMEM_NPORTS-1:0] gdmem_rsv_valid_packed;
+
+    // Pack arrays for cluster_dmem_controller modules
+    wire [NCORES-1:0] cmem_re_packed;
+    wire [NCORES-1:0] cmem_we_packed;
+    wire [CMEM_ADDRW*NCORES-1:0] cmem_addr_packed;
+    wire [32*NCORES-1:0] cmem_rdata_packed;
+    wire [NCORES-1:0] cmem_stall_packed;
+    wire [NCORES-1:0] cmem_rsv_valid_packed;
+
+    // Per-bank conflict counters of banked_dmem_controller, zero for the other controllers
+    wire [32*`DMEM_NBANKS-1:0] dmem_conflict_cnt_packed;
+`ifndef USE_BANKED_DMEM
+    assign dmem_conflict_cnt_packed = 0;
+`endif
+
+    // Pack arrays for barrier_unit module
+    wire [NCORES-1:0] bar_re_packed;
+    wire [NCORES-1:0] bar_we_packed;
+    wire [10*NCORES-1:0] bar_addr_packed;
+    wire [32*NCORES-1:0] bar_rdata_packed;
+    wire [NCORES-1:0] bar_stall_packed;
+
+    // Pack arrays for hwlock_unit module
+    wire [NCORES-1:0] hwl_re_packed;
+    wire [NCORES-1:0] hwl_we_packed;
+    wire [10*NCORES-1:0] hwl_addr_packed;
+    wire [32*NCORES-1:0] hwl_rdata_packed;
+    wire [NCORES-1:0] hwl_stall_packed;
+
+    // Pack arrays for mailbox_unit module
+    wire [NCORES-1:0] mbox_re_packed;
+    wire [NCORES-1:0] mbox_we_packed;
+    wire [10*NCORES-1:0] mbox_addr_packed;
+    wire [32*NCORES-1:0] mbox_rdata_packed;
+    wire [NCORES-1:0] mbox_stall_packed;
+
+    // Pack arrays for dispenser_unit module
+    wire [NCORES-1:0] disp_re_packed;
+    wire [NCORES-1:0] disp_we_packed;
+    wire [10*NCORES-1:0] disp_addr_packed;
+    wire [32*NCORES-1:0] disp_rdata_packed;
+
+    // Pack arrays for clint module
+    wire [NCORES-1:0] clint_re_packed;
+    wire [NCORES-1:0] clint_we_packed;
+    wire [10*NCORES-1:0] clint_addr_packed;
+    wire [32*NCORES-1:0] clint_rdata_packed;
+    wire [NCORES-1:0] clint_msip;
+    wire [NCORES-1:0] clint_mtip;
+    wire [63:0] clint_mtime;
+
+    // The shared counter enable at 0x4000000C. A store of 1 or 0 by any core starts or stops the
+    // cycle, instret and event counters of all the cores in the same cycle.
+    reg               pmu_run = 1'b1;
+    wire [NCORES-1:0] pmu_run_we;
+    wire [NCORES-1:0] pmu_run_wdata;
+    integer pr;
+    always @(posedge clk) begin
+        for (pr = 0; pr < NCORES; pr = pr + 1) if (pmu_run_we[pr]) pmu_run <= pmu_run_wdata[pr];
+    end
 
     // Pack arrays for vmem_controller module
     wire [NCORES-1:0] vmem_we_packed;
@@ -101,15 +212,25 @@ module main #(
             assign dmem_wstrb_packed[4*(pack_idx+1)-1:4*pack_idx] = dmem_wstrb[pack_idx];
             assign dmem_is_lr_packed[pack_idx] = dbus_is_lr[pack_idx];
             assign dmem_is_sc_packed[pack_idx] = dbus_is_sc[pack_idx];
+            assign dmem_is_amo_packed[pack_idx] = dbus_is_amo[pack_idx];
+            assign dmem_amo_op_packed[`AMO_OP_WIDTH*(pack_idx+1)-1:`AMO_OP_WIDTH*pack_idx] = dbus_amo_op[pack_idx];
             assign dmem_rdata[pack_idx] = dmem_rdata_packed[32*(pack_idx+1)-1:32*pack_idx];
             assign dmem_stall[pack_idx] = dmem_stall_packed[pack_idx];
 
+            assign cmem_re_packed[pack_idx] = cmem_re[pack_idx];
+            assign cmem_we_packed[pack_idx] = cmem_we[pack_idx];
+            assign cmem_addr_packed[CMEM_ADDRW*(pack_idx+1)-1:CMEM_ADDRW*pack_idx] = cmem_addr[pack_idx];
+            assign cmem_rdata[pack_idx] = cmem_rdata_packed[32*(pack_idx+1)-1:32*pack_idx];
+            assign cmem_stall[pack_idx] = cmem_stall_packed[pack_idx];
+
             assign vmem_we_packed[pack_idx] = vmem_we[pack_idx];
             assign vmem_addr_packed[VMEM_ADDRW*(pack_idx+1)-1:VMEM_ADDRW*pack_idx] = vmem_addr[pack_idx];
             assign vmem_wdata_packed[VMEM_WDATAW*(pack_idx+1)-1:VMEM_WDATAW*pack_idx] = vmem_wdata[pack_idx];
             assign vmem_stall[pack_idx] = vmem_stall_packed[pack_idx];
 
-            assign dbus_stall[pack_idx] = dmem_stall_packed[pack_idx] | vmem_stall_packed[pack_idx];
+            assign dbus_stall[pack_idx] = dmem_stall_packed[pack_idx] | vmem_stall_packed[pack_idx]
+                                        | cmem_stall_packed[pack_idx] | bar_stall_packed[pack_idx]
+                                        | hwl_stall_packed[pack_idx] | mbox_stall_packed[pack_idx];
         end
     endgenerate
 
@@ -117,57 +238,180 @@ module main #(
     generate
         for (i = 0; i < NCORES; i = i + 1) begin : gen_cpu
             // Memory map address decoding:
-            // 0x10000000 - 0x17FFFFFF (bit[28]=1, bit[29]=0, bit[27]=0): Shared Data Memory
+            // 0x10000000 - 0x13FFFFFF (bit[28]=1, bit[29]=0, bit[27]=0, bit[26]=0): Shared Data Memory
+            // 0x14000000 - 0x17FFFFFF (bit[28]=1, bit[29]=0, bit[27]=0, bit[26]=1): Cluster-local Memory
             // 0x18000000 - 0x1FFFFFFF (bit[28]=1, bit[29]=0, bit[27]=1): Per-core Stack Memory
             // 0x20000000 - 0x2000FFFF (bit[29]=1, bit[30]=0): Video Memory
-            // 0x40000000 - 0x40000FFF (bit[30]=1, bit[12]=0): Performance Counter
-            // 0x40001000 - 0x40001FFF (bit[30]=1, bit[12]=1): Hart Index
-            wire in_stack_range = dbus_addr[i][28] && dbus_addr[i][27];   // 0x18xxxxxx
-            wire in_dmem_range  = dbus_addr[i][28] && !dbus_addr[i][27];  // 0x10xxxxxx - 0x17xxxxxx
+            // 0x40000000 - 0x40000FFF (bit[30]=1, bit[15:12]=0): Performance Counter
+            // 0x40001000 - 0x40001FFF (bit[30]=1, bit[15:12]=1): Hart Index
+            // 0x40002000 - 0x40002FFF (bit[30]=1, bit[15:12]=2): Data Memory Bank Conflict Counters
+            // 0x40003000 - 0x40003FFF (bit[30]=1, bit[15:12]=3): Hardware Barrier
+            // 0x40004000 - 0x40004FFF (bit[30]=1, bit[15:12]=4): Hardware Lock
+            // 0x40005000 - 0x40005FFF (bit[30]=1, bit[15:12]=5): Mailbox
+            // 0x40006000 - 0x40006FFF (bit[30]=1, bit[15:12]=6): Work Dispenser
+            // 0x40007000 - 0x40007FFF (bit[30]=1, bit[15:12]=7): CLINT (msip, mtimecmp, mtime)
+            wire [3:0] mmio_sel = dbus_addr[i][15:12];
+            wire in_stack_range = dbus_addr[i][28] && dbus_addr[i][27] && !dbus_addr[i][26];  // 0x18xxxxxx
+            wire in_tcm_range   = dbus_addr[i][28] && dbus_addr[i][27] && dbus_addr[i][26];   // 0x1Cxxxxxx
+            wire in_dmem_range  = dbus_addr[i][28] && !dbus_addr[i][27] && !dbus_addr[i][26];  // 0x10xxxxxx - 0x13xxxxxx
+            wire in_cmem_range  = dbus_addr[i][28] && !dbus_addr[i][27] && dbus_addr[i][26];   // 0x14xxxxxx - 0x17xxxxxx
             wire in_vmem_range  = dbus_addr[i][29];  // 0x2xxxxxxx
-            wire in_perf_range  = dbus_addr[i][30] && !dbus_addr[i][12];  // 0x40000xxx
-            wire in_hart_range  = dbus_addr[i][30] && dbus_addr[i][12];   // 0x40001xxx
+            wire in_perf_range  = dbus_addr[i][30] && (mmio_sel == 0);  // 0x40000xxx
+            wire in_hart_range  = dbus_addr[i][30] && (mmio_sel == 1);  // 0x40001xxx
+            wire in_dstat_range = dbus_addr[i][30] && (mmio_sel == 2);  // 0x40002xxx
+            wire in_bar_range   = dbus_addr[i][30] && (mmio_sel == 3);  // 0x40003xxx
+            wire in_hwl_range   = dbus_addr[i][30] && (mmio_sel == 4);  // 0x40004xxx
+            wire in_mbox_range  = dbus_addr[i][30] && (mmio_sel == 5);  // 0x40005xxx
+            wire in_disp_range  = dbus_addr[i][30] && (mmio_sel == 6);  // 0x40006xxx
+            wire in_clint_range = dbus_addr[i][30] && (mmio_sel == 7);  // 0x40007xxx
 
             reg in_dmem_range_reg;
+            reg in_cmem_range_reg;
             reg in_vmem_range_reg;
             reg in_perf_range_reg;
             reg in_hart_range_reg;
             reg in_stack_range_reg;
+            reg in_tcm_range_reg;
+            reg in_dstat_range_reg;
+            reg in_bar_range_reg;
+            reg in_hwl_range_reg;
+            reg in_mbox_range_reg;
+            reg in_disp_range_reg;
+            reg in_clint_range_reg;
+            reg [31:0] dstat_rdata;
+`ifdef USE_CLUSTERED_DMEM
+            reg hart_cluster_reg;
+`endif
 
             always @(posedge clk) begin
                 if (!dmem_stall[i]) begin
                     in_dmem_range_reg <= in_dmem_range;
                 end
+                if (!cmem_stall[i]) begin
+                    in_cmem_range_reg <= in_cmem_range;
+                end
+                if (!bar_stall_packed[i]) begin
+                    in_bar_range_reg <= in_bar_range;
+                end
+                if (!hwl_stall_packed[i]) begin
+                    in_hwl_range_reg <= in_hwl_range;
+                end
+                if (!mbox_stall_packed[i]) begin
+                    in_mbox_range_reg <= in_mbox_range;
+                end
 
                 in_vmem_range_reg <= in_vmem_range; // vmem is write-only, thus no need to stall
                 in_perf_range_reg <= in_perf_range;
                 in_hart_range_reg <= in_hart_range;
+`ifdef USE_CLUSTERED_DMEM
+                hart_cluster_reg <= dbus_addr[i][2];
+`endif
                 in_stack_range_reg <= in_stack_range;
+                in_tcm_range_reg <= in_tcm_range;
+                in_dstat_range_reg <= in_dstat_range;
+                in_disp_range_reg <= in_disp_range; // the dispensers never stall
+                in_clint_range_reg <= in_clint_range;
+                dstat_rdata <= (dbus_addr[i][11:2] < `DMEM_NBANKS)
+                               ? dmem_conflict_cnt_packed[32*dbus_addr[i][11:2] +: 32] : 0;
             end
 
+            // a core loses the data memory arbitration while it waits and another core accesses it
+            wire [NCORES-1:0] dmem_self = 1 << i;
+            wire dmem_arb_loss = dmem_stall[i]
+                                 && |((dmem_re_packed | dmem_we_packed | dmem_stall_packed) & ~dmem_self);
+
             wire [31:0] perf_rdata;
+            wire [31:0] tcm_rdata;
             assign dbus_rdata[i] = in_stack_range_reg ? stack_rdata[i] :
+                                   in_tcm_range_reg ? tcm_rdata :
                                    in_dmem_range_reg ? dmem_rdata[i] :
+                                   in_cmem_range_reg ? cmem_rdata[i] :
                                    in_vmem_range_reg ? 0 :  // vmem is write-only for CPUs
                                    in_perf_range_reg ? perf_rdata :
-                                   in_hart_range_reg ? hart_rdata[i] : 0;
+`ifdef USE_CLUSTERED_DMEM
+                                   in_hart_range_reg ? (hart_cluster_reg ? i / CLUSTER_SIZE : hart_rdata[i]) :
+`else
+                                   in_hart_range_reg ? hart_rdata[i] :
+`endif
+                                   in_dstat_range_reg ? dstat_rdata :
+                                   in_bar_range_reg ? bar_rdata_packed[32*i +: 32] :
+                                   in_hwl_range_reg ? hwl_rdata_packed[32*i +: 32] :
+                                   in_mbox_range_reg ? mbox_rdata_packed[32*i +: 32] :
+                                   in_disp_range_reg ? disp_rdata_packed[32*i +: 32] :
+                                   in_clint_range_reg ? clint_rdata_packed[32*i +: 32] : 0;
 
             cpu cpu (
-                .clk_i        (clk),            // input  wire
-                .rst_i        (rst),            // input  wire
-                .stall_i      (dbus_stall[i]),  // input  wire
-                .ibus_araddr_o(imem_raddr[i]),  // output wire [IBUS_ADDR_WIDTH-1:0]
-                .ibus_rdata_i (imem_rdata[i]),  // input  wire [IBUS_DATA_WIDTH-1:0]
-                .dbus_addr_o  (dbus_addr[i]),   // output wire [DBUS_ADDR_WIDTH-1:0]
-                .dbus_wvalid_o(dbus_we[i]),     // output wire
-                .dbus_wdata_o (dbus_wdata[i]),  // output wire [DBUS_DATA_WIDTH-1:0]
-                .dbus_wstrb_o (dbus_wstrb[i]),  // output wire [DBUS_STRB_WIDTH-1:0]
-                .dbus_is_lr_o (dbus_is_lr[i]),  // output wire
-                .dbus_is_sc_o (dbus_is_sc[i]),  // output wire
-                .dbus_rdata_i (dbus_rdata[i]),  // input  wire [DBUS_DATA_WIDTH-1:0]
-                .hart_index   (i)               // input  wire
+                .clk_i        (clk),                // input  wire
+                .rst_i        (rst),                // input  wire
+                .stall_i      (cpu_dbus_stall[i]),  // input  wire
+                .ibus_araddr_o(imem_raddr[i]),      // output wire [IBUS_ADDR_WIDTH-1:0]
+                .ibus_rdata_i (imem_rdata[i]),      // input  wire [IBUS_DATA_WIDTH-1:0]
+                .dbus_addr_o  (cpu_dbus_addr[i]),   // output wire [DBUS_ADDR_WIDTH-1:0]
+                .dbus_wvalid_o(cpu_dbus_we[i]),     // output wire
+                .dbus_wdata_o (cpu_dbus_wdata[i]),  // output wire [DBUS_DATA_WIDTH-1:0]
+                .dbus_wstrb_o (cpu_dbus_wstrb[i]),  // output wire [DBUS_STRB_WIDTH-1:0]
+                .dbus_is_lr_o (cpu_dbus_is_lr[i]),  // output wire
+                .dbus_is_sc_o (cpu_dbus_is_sc[i]),  // output wire
+                .dbus_is_amo_o(cpu_dbus_is_amo[i]), // output wire
+                .dbus_amo_op_o(cpu_dbus_amo_op[i]), // output wire [`AMO_OP_WIDTH-1:0]
+                .dbus_is_fence_o(cpu_dbus_is_fence[i]), // output wire
+                .dbus_rdata_i (cpu_dbus_rdata[i]),  // input  wire [DBUS_DATA_WIDTH-1:0]
+                .rsv_valid_i  (dmem_rsv_valid_packed[i] | cmem_rsv_valid_packed[i]), // input  wire
+                .irq_soft_i   (clint_msip[i]),      // input  wire
+                .irq_timer_i  (clint_mtip[i]),      // input  wire
+                .mtime_i      (clint_mtime),        // input  wire [63:0]
+                .pmu_run_i    (pmu_run),            // input  wire
+                .pmu_dbus_ev_i({dmem_arb_loss, bar_stall_packed[i] | hwl_stall_packed[i] | mbox_stall_packed[i],
+                                vmem_stall[i], dmem_stall[i] | cmem_stall[i]}), // input  wire [3:0]
+                .hart_index   (i)                   // input  wire [31:0]
             );
 
+`ifdef USE_STORE_BUFFER
+            // Plain stores to dmem (0x10000000 - 0x17FFFFFF) and vmem (0x2xxxxxxx) are buffered,
+            // and the MMIO (0x4xxxxxxx, 0x8xxxxxxx) accesses wait until the buffer is drained
+            wire cpu_bufferable = (cpu_dbus_addr[i][28] && !cpu_dbus_addr[i][27]) || cpu_dbus_addr[i][29];
+            wire cpu_device     = !cpu_dbus_addr[i][28] && !cpu_dbus_addr[i][29];
+
+            store_buffer store_buffer (
+                .clk_i       (clk),                    // input  wire
+                .req_i       (cpu_dbus_addr[i] != 0),  // input  wire
+                .bufferable_i(cpu_bufferable),         // input  wire
+                .device_i    (cpu_device),             // input  wire
+                .fence_i     (cpu_dbus_is_fence[i]),   // input  wire
+                .addr_i      (cpu_dbus_addr[i]),       // input  wire [31:0]
+                .we_i        (cpu_dbus_we[i]),         // input  wire
+                .wdata_i     (cpu_dbus_wdata[i]),      // input  wire [31:0]
+                .wstrb_i     (cpu_dbus_wstrb[i]),      // input  wire [3:0]
+                .is_lr_i     (cpu_dbus_is_lr[i]),      // input  wire
+                .is_sc_i     (cpu_dbus_is_sc[i]),      // input  wire
+                .is_amo_i    (cpu_dbus_is_amo[i]),     // input  wire
+                .amo_op_i    (cpu_dbus_amo_op[i]),     // input  wire [`AMO_OP_WIDTH-1:0]
+                .rdata_o     (cpu_dbus_rdata[i]),      // output wire [31:0]
+                .stall_o     (cpu_dbus_stall[i]),      // output wire
+                .bus_addr_o  (dbus_addr[i]),           // output reg  [31:0]
+                .bus_we_o    (dbus_we[i]),             // output reg
+                .bus_wdata_o (dbus_wdata[i]),          // output reg  [31:0]
+                .bus_wstrb_o (dbus_wstrb[i]),          // output reg  [3:0]
+                .bus_is_lr_o (dbus_is_lr[i]),          // output reg
+                .bus_is_sc_o (dbus_is_sc[i]),          // output reg
+                .bus_is_amo_o(dbus_is_amo[i]),         // output reg
+                .bus_amo_op_o(dbus_amo_op[i]),         // output reg  [`AMO_OP_WIDTH-1:0]
+                .bus_rdata_i (dbus_rdata[i]),          // input  wire [31:0]
+                .bus_stall_i (dbus_stall[i])           // input  wire
+            );
+`else
+            assign dbus_addr[i]      = cpu_dbus_addr[i];
+            assign dbus_we[i]        = cpu_dbus_we[i];
+            assign dbus_wdata[i]     = cpu_dbus_wdata[i];
+            assign dbus_wstrb[i]     = cpu_dbus_wstrb[i];
+            assign dbus_is_lr[i]     = cpu_dbus_is_lr[i];
+            assign dbus_is_sc[i]     = cpu_dbus_is_sc[i];
+            assign dbus_is_amo[i]    = cpu_dbus_is_amo[i];
+            assign dbus_amo_op[i]    = cpu_dbus_amo_op[i];
+            assign cpu_dbus_rdata[i] = dbus_rdata[i];
+            assign cpu_dbus_stall[i] = dbus_stall[i];
+`endif
+
             assign hart_rdata[i] = i;
 
             assign dmem_re[i]    = in_dmem_range & !dbus_we[i];
@@ -176,6 +420,30 @@ module main #(
             assign dmem_wdata[i] = dbus_wdata[i];
             assign dmem_wstrb[i] = dbus_wstrb[i];
 
+            assign cmem_re[i]    = in_cmem_range & !dbus_we[i];
+            assign cmem_we[i]    = in_cmem_range & dbus_we[i];
+            assign cmem_addr[i]  = dbus_addr[i][CMEM_ADDRW+1:2];
+
+            assign bar_re_packed[i] = in_bar_range & !dbus_we[i];
+            assign bar_we_packed[i] = in_bar_range & dbus_we[i];
+            assign bar_addr_packed[10*i +: 10] = dbus_addr[i][11:2];
+
+            assign hwl_re_packed[i] = in_hwl_range & !dbus_we[i];
+            assign hwl_we_packed[i] = in_hwl_range & dbus_we[i];
+            assign hwl_addr_packed[10*i +: 10] = dbus_addr[i][11:2];
+
+            assign mbox_re_packed[i] = in_mbox_range & !dbus_we[i];
+            assign mbox_we_packed[i] = in_mbox_range & dbus_we[i];
+            assign mbox_addr_packed[10*i +: 10] = dbus_addr[i][11:2];
+
+            assign disp_re_packed[i] = in_disp_range & !dbus_we[i];
+            assign disp_we_packed[i] = in_disp_range & dbus_we[i];
+            assign disp_addr_packed[10*i +: 10] = dbus_addr[i][11:2];
+
+            assign clint_re_packed[i] = in_clint_range & !dbus_we[i];
+            assign clint_we_packed[i] = in_clint_range & dbus_we[i];
+            assign clint_addr_packed[10*i +: 10] = dbus_addr[i][11:2];
+
             assign vmem_we[i]    = in_vmem_range & dbus_we[i];
             assign vmem_addr[i]  = dbus_addr[i][VMEM_ADDRW-1:0];
             assign vmem_wdata[i] = dbus_wdata[i][VMEM_WDATAW-1:0];
@@ -196,14 +464,38 @@ module main #(
                 .rdata_o (stack_rdata[i])  // output wire [31:0]
             );
 
+            // per-core tightly-coupled data memory, every core sees its own copy at 0x1C000000
+            if (TCM_SIZE > 0) begin : gen_tcm
+                wire tcm_re = in_tcm_range & !dbus_we[i];
+                wire tcm_we = in_tcm_range & dbus_we[i];
+
+                stack_dmem #(
+                    .STACK_ADDRW   (TCM_ADDRW),
+                    .STACK_ENTRIES (TCM_SIZE/4)
+                ) tcm_ram (
+                    .clk_i   (clk),                            // input  wire
+                    .re_i    (tcm_re),                         // input  wire
+                    .we_i    (tcm_we),                         // input  wire
+                    .addr_i  (dbus_addr[i][TCM_ADDRW+1:2]),    // input  wire [TCM_ADDRW-1:0]
+                    .wdata_i (dbus_wdata[i]),                  // input  wire [31:0]
+                    .wstrb_i (dbus_wstrb[i]),                  // input  wire [3:0]
+                    .rdata_o (tcm_rdata)                       // output wire [31:0]
+                );
+            end else begin : gen_no_tcm
+                assign tcm_rdata = 0;
+            end
+
             wire perf_we          = in_perf_range & dbus_we[i];
             wire [3:0] perf_addr  = dbus_addr[i][3:0];
             wire [2:0] perf_wdata = dbus_wdata[i][2:0];
+            assign pmu_run_we[i]    = perf_we && (perf_addr == 4'hc);
+            assign pmu_run_wdata[i] = perf_wdata[0];
             perf_cntr perf (
                 .clk_i   (clk),         // input  wire
                 .addr_i  (perf_addr),   // input  wire [3:0]
                 .wdata_i (perf_wdata),  // input  wire [2:0]
                 .w_en_i  (perf_we),     // input  wire
+                .run_i   (pmu_run),     // input  wire
                 .rdata_o (perf_rdata)   // output wire [31:0]
             );
         end
@@ -233,21 +525,196 @@ module main #(
         end
     endgenerate
 
-`ifdef USE_COMB_DBUS
-    comb_dmem_controller comb_dmem_controller (
+`ifdef USE_CLUSTERED_DMEM
+    // Each cluster of CLUSTER_SIZE cores has a cluster-local memory and one port to the
+    // global data memory controller
+    genvar cl;
+    generate
+        // The controllers need at least two ports, and every core must belong to a cluster
+        if (NCORES % CLUSTER_SIZE != 0 || NCORES / CLUSTER_SIZE < 2) begin : gen_cluster_check
+            $error("USE_CLUSTERED_DMEM needs NCORES to be a multiple of CLUSTER_SIZE with at least two clusters");
+        end
+        for (cl = 0; cl < DMEM_NPORTS; cl = cl + 1) begin : gen_cluster
+            cluster_bridge #(
+                .NCORES(CLUSTER_SIZE)
+            ) cluster_bridge (
+                .clk_i          (clk),                                                              // input  wire
+                .re_packed_i    (dmem_re_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),                   // input  wire [NCORES-1:0]
+                .we_packed_i    (dmem_we_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),                   // input  wire [NCORES-1:0]
+                .addr_packed_i  (dmem_addr_packed[DMEM_ADDRW*CLUSTER_SIZE*cl +: DMEM_ADDRW*CLUSTER_SIZE]), // input  wire [DMEM_ADDRW*NCORES-1:0]
+                .wdata_packed_i (dmem_wdata_packed[32*CLUSTER_SIZE*cl +: 32*CLUSTER_SIZE]),          // input  wire [32*NCORES-1:0]
+                .wstrb_packed_i (dmem_wstrb_packed[4*CLUSTER_SIZE*cl +: 4*CLUSTER_SIZE]),            // input  wire [4*NCORES-1:0]
+                .is_lr_packed_i (dmem_is_lr_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),                // input  wire [NCORES-1:0]
+                .is_sc_packed_i (dmem_is_sc_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),                // input  wire [NCORES-1:0]
+                .is_amo_packed_i(dmem_is_amo_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),               // input  wire [NCORES-1:0]
+                .amo_op_packed_i(dmem_amo_op_packed[`AMO_OP_WIDTH*CLUSTER_SIZE*cl +: `AMO_OP_WIDTH*CLUSTER_SIZE]), // input  wire [`AMO_OP_WIDTH*NCORES-1:0]
+                .rdata_packed_o (dmem_rdata_packed[32*CLUSTER_SIZE*cl +: 32*CLUSTER_SIZE]),          // output wire [32*NCORES-1:0]
+                .stall_packed_o (dmem_stall_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),                // output wire [NCORES-1:0]
+                .rsv_valid_packed_o(dmem_rsv_valid_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),         // output wire [NCORES-1:0]
+                .g_re_o         (gdmem_re_packed[cl]),                                              // output wire
+                .g_we_o         (gdmem_we_packed[cl]),                                              // output wire
+                .g_addr_o       (gdmem_addr_packed[DMEM_ADDRW*cl +: DMEM_ADDRW]),                   // output wire [DMEM_ADDRW-1:0]
+                .g_wdata_o      (gdmem_wdata_packed[32*cl +: 32]),                                  // output wire [31:0]
+                .g_wstrb_o      (gdmem_wstrb_packed[4*cl +: 4]),                                    // output wire [3:0]
+                .g_is_lr_o      (gdmem_is_lr_packed[cl]),                                           // output wire
+                .g_is_sc_o      (gdmem_is_sc_packed[cl]),                                           // output wire
+                .g_is_amo_o     (gdmem_is_amo_packed[cl]),                                          // output wire
+                .g_amo_op_o     (gdmem_amo_op_packed[`AMO_OP_WIDTH*cl +: `AMO_OP_WIDTH]),           // output wire [`AMO_OP_WIDTH-1:0]
+                .g_rdata_i      (gdmem_rdata_packed[32*cl +: 32]),                                  // input  wire [31:0]
+                .g_stall_i      (gdmem_stall_packed[cl]),                                           // input  wire
+                .g_rsv_valid_i  (gdmem_rsv_valid_packed[cl])                                        // input  wire
+            );
+
+            cluster_dmem_controller #(
+                .NCORES(CLUSTER_SIZE)
+            ) cluster_dmem_controller (
+                .clk_i          (clk),                                                              // input  wire
+                .re_packed_i    (cmem_re_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),                   // input  wire [NCORES-1:0]
+                .we_packed_i    (cmem_we_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),                   // input  wire [NCORES-1:0]
+                .addr_packed_i  (cmem_addr_packed[CMEM_ADDRW*CLUSTER_SIZE*cl +: CMEM_ADDRW*CLUSTER_SIZE]), // input  wire [CMEM_ADDRW*NCORES-1:0]
+                .wdata_packed_i (dmem_wdata_packed[32*CLUSTER_SIZE*cl +: 32*CLUSTER_SIZE]),          // input  wire [32*NCORES-1:0]
+                .wstrb_packed_i (dmem_wstrb_packed[4*CLUSTER_SIZE*cl +: 4*CLUSTER_SIZE]),            // input  wire [4*NCORES-1:0]
+                .is_lr_packed_i (dmem_is_lr_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),                // input  wire [NCORES-1:0]
+                .is_sc_packed_i (dmem_is_sc_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),                // input  wire [NCORES-1:0]
+                .is_amo_packed_i(dmem_is_amo_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),               // input  wire [NCORES-1:0]
+                .amo_op_packed_i(dmem_amo_op_packed[`AMO_OP_WIDTH*CLUSTER_SIZE*cl +: `AMO_OP_WIDTH*CLUSTER_SIZE]), // input  wire [`AMO_OP_WIDTH*NCORES-1:0]
+                .rdata_packed_o (cmem_rdata_packed[32*CLUSTER_SIZE*cl +: 32*CLUSTER_SIZE]),          // output wire [32*NCORES-1:0]
+                .stall_packed_o (cmem_stall_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE]),                // output wire [NCORES-1:0]
+                .rsv_valid_packed_o(cmem_rsv_valid_packed[CLUSTER_SIZE*cl +: CLUSTER_SIZE])          // output wire [NCORES-1:0]
+            );
+        end
+    endgenerate
+`else
+    assign gdmem_re_packed     = dmem_re_packed;
+    assign gdmem_we_packed     = dmem_we_packed;
+    assign gdmem_addr_packed   = dmem_addr_packed;
+    assign gdmem_wdata_packed  = dmem_wdata_packed;
+    assign gdmem_wstrb_packed  = dmem_wstrb_packed;
+    assign gdmem_is_lr_packed  = dmem_is_lr_packed;
+    assign gdmem_is_sc_packed  = dmem_is_sc_packed;
+    assign gdmem_is_amo_packed = dmem_is_amo_packed;
+    assign gdmem_amo_op_packed = dmem_amo_op_packed;
+    assign dmem_rdata_packed   = gdmem_rdata_packed;
+    assign dmem_stall_packed   = gdmem_stall_packed;
+    assign dmem_rsv_valid_packed = gdmem_rsv_valid_packed;
+
+    assign cmem_rdata_packed = 0;
+    assign cmem_stall_packed = 0;
+    assign cmem_rsv_valid_packed = 0;
+`endif
+
+`ifdef USE_BANKED_DMEM
+    banked_dmem_controller #(.NCORES(DMEM_NPORTS)) banked_dmem_controller (
+`elsif USE_REPLICATED_DMEM
+    replicated_dmem_controller #(.NCORES(DMEM_NPORTS)) replicated_dmem_controller (
+`elsif USE_L1_DCACHE
+    l1_dmem_controller #(.NCORES(DMEM_NPORTS)) l1_dmem_controller (
+`elsif USE_COMB_DBUS
+    comb_dmem_controller #(.NCORES(DMEM_NPORTS)) comb_dmem_controller (
 `else
-    dmem_controller dmem_controller (
+    dmem_controller #(.NCORES(DMEM_NPORTS)) dmem_controller (
 `endif
+        .clk_i         (clk),                 // input  wire
+        .re_packed_i   (gdmem_re_packed),     // input  wire [NCORES-1:0]
+        .we_packed_i   (gdmem_we_packed),     // input  wire [NCORES-1:0]
+        .addr_packed_i (gdmem_addr_packed),   // input  wire [32*NCORES-1:0]
+        .wdata_packed_i(gdmem_wdata_packed),  // input  wire [32*NCORES-1:0]
+        .wstrb_packed_i(gdmem_wstrb_packed),  // input  wire [4*NCORES-1:0]
+        .is_lr_packed_i(gdmem_is_lr_packed),  // input  wire [NCORES-1:0]
+        .is_sc_packed_i(gdmem_is_sc_packed),  // input  wire [NCORES-1:0]
+        .is_amo_packed_i(gdmem_is_amo_packed), // input  wire [NCORES-1:0]
+        .amo_op_packed_i(gdmem_amo_op_packed), // input  wire [`AMO_OP_WIDTH*NCORES-1:0]
+        .rdata_packed_o(gdmem_rdata_packed),  // output wire [32*NCORES-1:0]
+`ifdef USE_BANKED_DMEM
+        .conflict_cnt_packed_o(dmem_conflict_cnt_packed), // output wire [32*DMEM_NBANKS-1:0]
+`endif
+        .stall_packed_o(gdmem_stall_packed),  // output wire [NCORES-1:0]
+        .rsv_valid_packed_o(gdmem_rsv_valid_packed) // output wire [NCORES-1:0]
+    );
+
+    generate
+        if (HW_BARRIER_SLOTS > 0) begin : gen_barrier
+            barrier_unit #(
+                .NCORES(NCORES),
+                .NSLOTS(HW_BARRIER_SLOTS)
+            ) barrier_unit (
+                .clk_i         (clk),                // input  wire
+                .re_packed_i   (bar_re_packed),      // input  wire [NCORES-1:0]
+                .we_packed_i   (bar_we_packed),      // input  wire [NCORES-1:0]
+                .addr_packed_i (bar_addr_packed),    // input  wire [10*NCORES-1:0]
+                .wdata_packed_i(dmem_wdata_packed),  // input  wire [32*NCORES-1:0]
+                .rdata_packed_o(bar_rdata_packed),   // output wire [32*NCORES-1:0]
+                .stall_packed_o(bar_stall_packed)    // output wire [NCORES-1:0]
+            );
+        end else begin : gen_no_barrier
+            assign bar_rdata_packed = 0;
+            assign bar_stall_packed = 0;
+        end
+
+        if (HW_LOCKS > 0) begin : gen_hwlock
+            hwlock_unit #(
+                .NCORES(NCORES),
+                .NLOCKS(HW_LOCKS)
+            ) hwlock_unit (
+                .clk_i         (clk),                // input  wire
+                .re_packed_i   (hwl_re_packed),      // input  wire [NCORES-1:0]
+                .we_packed_i   (hwl_we_packed),      // input  wire [NCORES-1:0]
+                .addr_packed_i (hwl_addr_packed),    // input  wire [10*NCORES-1:0]
+                .rdata_packed_o(hwl_rdata_packed),   // output wire [32*NCORES-1:0]
+                .stall_packed_o(hwl_stall_packed)    // output wire [NCORES-1:0]
+            );
+        end else begin : gen_no_hwlock
+            assign hwl_rdata_packed = 0;
+            assign hwl_stall_packed = 0;
+        end
+
+        if (MBOX_DEPTH > 0) begin : gen_mailbox
+            mailbox_unit #(
+                .NCORES(NCORES),
+                .DEPTH (MBOX_DEPTH)
+            ) mailbox_unit (
+                .clk_i         (clk),                // input  wire
+                .re_packed_i   (mbox_re_packed),     // input  wire [NCORES-1:0]
+                .we_packed_i   (mbox_we_packed),     // input  wire [NCORES-1:0]
+                .addr_packed_i (mbox_addr_packed),   // input  wire [10*NCORES-1:0]
+                .wdata_packed_i(dmem_wdata_packed),  // input  wire [32*NCORES-1:0]
+                .rdata_packed_o(mbox_rdata_packed),  // output wire [32*NCORES-1:0]
+                .stall_packed_o(mbox_stall_packed)   // output wire [NCORES-1:0]
+            );
+        end else begin : gen_no_mailbox
+            assign mbox_rdata_packed = 0;
+            assign mbox_stall_packed = 0;
+        end
+
+        if (HW_DISPENSERS > 0) begin : gen_dispenser
+            dispenser_unit #(
+                .NCORES(NCORES),
+                .NDISP (HW_DISPENSERS)
+            ) dispenser_unit (
+                .clk_i         (clk),                // input  wire
+                .re_packed_i   (disp_re_packed),     // input  wire [NCORES-1:0]
+                .we_packed_i   (disp_we_packed),     // input  wire [NCORES-1:0]
+                .addr_packed_i (disp_addr_packed),   // input  wire [10*NCORES-1:0]
+                .wdata_packed_i(dmem_wdata_packed),  // input  wire [32*NCORES-1:0]
+                .rdata_packed_o(disp_rdata_packed)   // output wire [32*NCORES-1:0]
+            );
+        end else begin : gen_no_dispenser
+            assign disp_rdata_packed = 0;
+        end
+    endgenerate
+
+    clint #(
+        .NCORES(NCORES)
+    ) clint (
         .clk_i         (clk),                // input  wire
-        .re_packed_i   (dmem_re_packed),     // input  wire [NCORES-1:0]
-        .we_packed_i   (dmem_we_packed),     // input  wire [NCORES-1:0]
-        .addr_packed_i (dmem_addr_packed),   // input  wire [32*NCORES-1:0]
+        .re_packed_i   (clint_re_packed),    // input  wire [NCORES-1:0]
+        .we_packed_i   (clint_we_packed),    // input  wire [NCORES-1:0]
+        .addr_packed_i (clint_addr_packed),  // input  wire [10*NCORES-1:0]
         .wdata_packed_i(dmem_wdata_packed),  // input  wire [32*NCORES-1:0]
-        .wstrb_packed_i(dmem_wstrb_packed),  // input  wire [4*NCORES-1:0]
-        .is_lr_packed_i(dmem_is_lr_packed),  // input  wire [NCORES-1:0]
-        .is_sc_packed_i(dmem_is_sc_packed),  // input  wire [NCORES-1:0]
-        .rdata_packed_o(dmem_rdata_packed),  // output wire [32*NCORES-1:0]
-        .stall_packed_o(dmem_stall_packed)   // output wire [NCORES-1:0]
+        .rdata_packed_o(clint_rdata_packed), // output wire [32*NCORES-1:0]
+        .msip_o        (clint_msip),         // output wire [NCORES-1:0]
+        .mtip_o        (clint_mtip),         // output wire [NCORES-1:0]
+        .mtime_o       (clint_mtime)         // output wire [63:0]
     );
 
     wire [VMEM_ADDRW-1:0]  vmem_disp_raddr;
@@ -6,6 +6,7 @@ module perf_cntr (
     input  wire  [3:0] addr_i,
     input  wire  [2:0] wdata_i,
     input  wire        w_en_i,
+    input  wire        run_i,    // the shared counter enable, read at 0xC
     output wire [31:0] rdata_o
 );
     reg [63:0] mcycle   = 0;
@@ -13,7 +14,7 @@ module perf_cntr (
     reg [31:0] rdata    = 0;
 
     always @(posedge clk_i) begin
-        rdata <= (addr_i[2]) ? mcycle[31:0] : mcycle[63:32];
+        rdata <= (addr_i == 4'hc) ? {31'd0, run_i} : (addr_i[2]) ? mcycle[31:0] : mcycle[63:32];
         if (w_en_i && addr_i == 0) cnt_ctrl <= wdata_i[1:0];
         case (cnt_ctrl)
             0: mcycle <= 0;
@@ -0,0 +1,195 @@
+`resetall
+`default_nettype none
+
+`include "config.vh"
+
+// Per-core FIFO store buffer between the cpu and the data bus decode
+// Plain stores to the shared data memory and the video memory are retired into the buffer
+// and drained in the background whenever the bus is not used by the cpu. Loads to the same
+// word are forwarded from the buffer when it holds all four bytes, and otherwise wait until
+// the buffer is empty. LR/SC/AMO, FENCE and the MMIO accesses also wait until the buffer is
+// empty, so that a device access is not seen before the stores preceding it.
+module store_buffer #(
+    parameter DEPTH = `STORE_BUFFER_DEPTH
+) (
+    input  wire                     clk_i,
+    // cpu side
+    input  wire                     req_i,         // load or store request
+    input  wire                     bufferable_i,  // the request targets dmem or vmem
+    input  wire                     device_i,      // the request targets MMIO
+    input  wire                     fence_i,
+    input  wire              [31:0] addr_i,
+    input  wire                     we_i,
+    input  wire              [31:0] wdata_i,
+    input  wire               [3:0] wstrb_i,
+    input  wire                     is_lr_i,
+    input  wire                     is_sc_i,
+    input  wire                     is_amo_i,
+    input  wire [`AMO_OP_WIDTH-1:0] amo_op_i,
+    output wire              [31:0] rdata_o,
+    output wire                     stall_o,
+    // bus side
+    output reg               [31:0] bus_addr_o,
+    output reg                      bus_we_o,
+    output reg               [31:0] bus_wdata_o,
+    output reg                [3:0] bus_wstrb_o,
+    output reg                      bus_is_lr_o,
+    output reg                      bus_is_sc_o,
+    output reg                      bus_is_amo_o,
+    output reg  [`AMO_OP_WIDTH-1:0] bus_amo_op_o,
+    input  wire              [31:0] bus_rdata_i,
+    input  wire                     bus_stall_i
+);
+    localparam PTRW = (DEPTH > 1) ? $clog2(DEPTH) : 1;  // the pointers wrap at DEPTH, also for DEPTH = 1
+    integer k;
+
+    // Buffer entries
+    reg [31:2] sb_addr [0:DEPTH-1];
+    reg [31:0] sb_wdata[0:DEPTH-1];
+    reg  [3:0] sb_wstrb[0:DEPTH-1];
+    reg [PTRW-1:0] head_q = 0;
+    reg [PTRW-1:0] tail_q = 0;
+    reg [PTRW:0]   count_q = 0;
+
+    // A cpu request that could not be completed in the cycle it was presented
+    reg                     pend_valid_q = 1'b0;
+    reg                     pend_req_q;
+    reg                     pend_bufferable_q;
+    reg                     pend_device_q;
+    reg                     pend_fence_q;
+    reg              [31:0] pend_addr_q;
+    reg                     pend_we_q;
+    reg              [31:0] pend_wdata_q;
+    reg               [3:0] pend_wstrb_q;
+    reg                     pend_is_lr_q;
+    reg                     pend_is_sc_q;
+    reg                     pend_is_amo_q;
+    reg [`AMO_OP_WIDTH-1:0] pend_amo_op_q;
+
+    wire                     cur_req        = pend_valid_q ? pend_req_q        : req_i;
+    wire                     cur_bufferable = pend_valid_q ? pend_bufferable_q : bufferable_i;
+    wire                     cur_device     = pend_valid_q ? pend_device_q     : device_i;
+    wire                     cur_fence      = pend_valid_q ? pend_fence_q      : fence_i;
+    wire              [31:0] cur_addr       = pend_valid_q ? pend_addr_q       : addr_i;
+    wire                     cur_we         = pend_valid_q ? pend_we_q         : we_i;
+    wire              [31:0] cur_wdata      = pend_valid_q ? pend_wdata_q      : wdata_i;
+    wire               [3:0] cur_wstrb      = pend_valid_q ? pend_wstrb_q      : wstrb_i;
+    wire                     cur_is_lr      = pend_valid_q ? pend_is_lr_q      : is_lr_i;
+    wire                     cur_is_sc      = pend_valid_q ? pend_is_sc_q      : is_sc_i;
+    wire                     cur_is_amo     = pend_valid_q ? pend_is_amo_q     : is_amo_i;
+    wire [`AMO_OP_WIDTH-1:0] cur_amo_op     = pend_valid_q ? pend_amo_op_q     : amo_op_i;
+
+    // Store-to-load forwarding: merge the matching entries from the oldest to the youngest
+    reg [31:0] fwd_data;
+    reg  [3:0] fwd_strb;
+    reg [PTRW-1:0] idx;
+    always @(*) begin
+        fwd_data = 0;
+        fwd_strb = 0;
+        for (k = 0; k < DEPTH; k = k + 1) begin
+            idx = head_q + k[PTRW-1:0];
+            if (k < count_q && sb_addr[idx] == cur_addr[31:2]) begin
+                if (sb_wstrb[idx][0]) fwd_data[7:0]   = sb_wdata[idx][7:0];
+                if (sb_wstrb[idx][1]) fwd_data[15:8]  = sb_wdata[idx][15:8];
+                if (sb_wstrb[idx][2]) fwd_data[23:16] = sb_wdata[idx][23:16];
+                if (sb_wstrb[idx][3]) fwd_data[31:24] = sb_wdata[idx][31:24];
+                fwd_strb = fwd_strb | sb_wstrb[idx];
+            end
+        end
+    end
+
+    wire cur_atomic    = cur_is_lr || cur_is_sc || cur_is_amo;
+    wire cur_store_buf = cur_req && cur_we && !cur_is_sc && !cur_is_amo && cur_bufferable;
+    wire cur_load_fwd  = cur_req && !cur_we && !cur_atomic && cur_bufferable && (fwd_strb == 4'hf);
+    wire cur_need_empty = cur_fence || cur_atomic || (cur_req && cur_device)
+                       || (cur_req && !cur_we && cur_bufferable && (fwd_strb != 0));
+
+    // The bus accepts a new request when the previous one is not stalled
+    wire bus_free     = !bus_stall_i;
+    wire empty        = (count_q == 0);
+    wire cpu_want_bus = cur_req && !cur_store_buf && !cur_load_fwd;
+    wire cpu_issue    = cpu_want_bus && bus_free && (!cur_need_empty || empty);
+    wire drain        = bus_free && !cpu_issue && !empty;
+    wire enqueue      = cur_store_buf && ((count_q < DEPTH) || drain);
+    wire fence_done   = cur_fence && !cur_req && bus_free && empty;
+    wire cur_done     = cpu_issue || enqueue || cur_load_fwd || fence_done;
+    wire cur_valid    = pend_valid_q || req_i || fence_i;
+
+    // Response to the cpu
+    reg        sb_stall_q  = 1'b0;
+    reg        resp_bus_q  = 1'b0;  // the cpu request on the bus has not completed yet
+    reg        fwd_valid_q = 1'b0;
+    reg [31:0] fwd_data_q;
+
+    assign stall_o = sb_stall_q || (resp_bus_q && bus_stall_i);
+    assign rdata_o = resp_bus_q ? bus_rdata_i : fwd_valid_q ? fwd_data_q : 32'h0;
+
+    always @(*) begin
+        bus_addr_o   = 0;
+        bus_we_o     = 1'b0;
+        bus_wdata_o  = 0;
+        bus_wstrb_o  = 0;
+        bus_is_lr_o  = 1'b0;
+        bus_is_sc_o  = 1'b0;
+        bus_is_amo_o = 1'b0;
+        bus_amo_op_o = 0;
+        if (cpu_issue) begin
+            bus_addr_o   = cur_addr;
+            bus_we_o     = cur_we;
+            bus_wdata_o  = cur_wdata;
+            bus_wstrb_o  = cur_wstrb;
+            bus_is_lr_o  = cur_is_lr;
+            bus_is_sc_o  = cur_is_sc;
+            bus_is_amo_o = cur_is_amo;
+            bus_amo_op_o = cur_amo_op;
+        end else if (drain) begin
+            bus_addr_o  = {sb_addr[head_q], 2'b00};
+            bus_we_o    = 1'b1;
+            bus_wdata_o = sb_wdata[head_q];
+            bus_wstrb_o = sb_wstrb[head_q];
+        end
+    end
+
+    always @(posedge clk_i) begin
+        if (enqueue) begin
+            sb_addr[tail_q]  <= cur_addr[31:2];
+            sb_wdata[tail_q] <= cur_wdata;
+            sb_wstrb[tail_q] <= cur_wstrb;
+            tail_q           <= (tail_q == DEPTH-1) ? 0 : tail_q + 1;
+        end
+        if (drain) begin
+            head_q <= (head_q == DEPTH-1) ? 0 : head_q + 1;
+        end
+        count_q <= count_q + enqueue - drain;
+
+        if (cur_valid && !cur_done) begin
+            if (!pend_valid_q) begin
+                pend_req_q        <= req_i;
+                pend_bufferable_q <= bufferable_i;
+                pend_device_q     <= device_i;
+                pend_fence_q      <= fence_i;
+                pend_addr_q       <= addr_i;
+                pend_we_q         <= we_i;
+                pend_wdata_q      <= wdata_i;
+                pend_wstrb_q      <= wstrb_i;
+                pend_is_lr_q      <= is_lr_i;
+                pend_is_sc_q      <= is_sc_i;
+                pend_is_amo_q     <= is_amo_i;
+                pend_amo_op_q     <= amo_op_i;
+            end
+            pend_valid_q <= 1'b1;
+            sb_stall_q   <= 1'b1;
+        end else begin
+            pend_valid_q <= 1'b0;
+            sb_stall_q   <= 1'b0;
+        end
+
+        if (cpu_issue) resp_bus_q <= 1'b1;
+        else if (bus_free) resp_bus_q <= 1'b0;
+
+        fwd_valid_q <= cur_load_fwd;
+        fwd_data_q  <= fwd_data;
+    end
+endmodule
+
+`resetall
@@ -14,6 +14,7 @@ typedef struct {
 static const test_entry_t all_tests[] = {
     /* LR/SC Specific Tests */
     {"sc_fail_on_intervene", test_sc_fail_on_intervene},
+    {"sc_fail_cross_cluster", test_sc_fail_cross_cluster},
     {"sc_different_address", test_sc_different_address},
     {"reservation_overwrite", test_reservation_overwrite},
     {"sc_without_lr", test_sc_without_lr},
@@ -29,6 +30,11 @@ static const test_entry_t all_tests[] = {
     {"exchange_concurrent", test_exchange_concurrent},
     {"exchange_concurrent_50", test_exchange_concurrent_50},
 
+    /* AMO Tests */
+    {"amo_logical", test_amo_logical},
+    {"amo_min_max", test_amo_min_max},
+    {"amo_concurrent", test_amo_concurrent},
+
     /* Barrier Tests */
     {"barrier_atomic_counter", test_barrier_atomic_counter},
     {"barrier_delay_injection", test_barrier_delay_injection},
@@ -0,0 +1,91 @@
+#include "test_common.h"
+
+static volatile int amo_var;
+static volatile unsigned int amo_uvar;
+static volatile int amo_results[NCORES];
+
+test_result_t test_amo_logical(int hart_id, int ncores)
+{
+    test_result_t result = {.name = "amo_logical", .passed = 0, .failed = 0};
+
+    if (hart_id == 0) {
+        amo_var = 0x0ff0;
+
+        int old = atomic_fetch_and(&amo_var, 0x00ff);
+        TEST_ASSERT_EQ(0x0ff0, old, &result, "amoand should return the old value");
+        TEST_ASSERT_EQ(0x00f0, amo_var, &result, "amoand result mismatch");
+
+        old = atomic_fetch_or(&amo_var, 0x0f00);
+        TEST_ASSERT_EQ(0x00f0, old, &result, "amoor should return the old value");
+        TEST_ASSERT_EQ(0x0ff0, amo_var, &result, "amoor result mismatch");
+
+        old = atomic_fetch_xor(&amo_var, 0x0ff0);
+        TEST_ASSERT_EQ(0x0ff0, old, &result, "amoxor should return the old value");
+        TEST_ASSERT_EQ(0, amo_var, &result, "amoxor result mismatch");
+    }
+
+    pg_barrier_at(BARRIER_TEST_RUN, ncores);
+    return result;
+}
+
+test_result_t test_amo_min_max(int hart_id, int ncores)
+{
+    test_result_t result = {.name = "amo_min_max", .passed = 0, .failed = 0};
+
+    if (hart_id == 0) {
+        amo_var = -5;
+
+        int old = atomic_fetch_max(&amo_var, 3);
+        TEST_ASSERT_EQ(-5, old, &result, "amomax should return the old value");
+        TEST_ASSERT_EQ(3, amo_var, &result, "amomax should be signed");
+
+        old = atomic_fetch_min(&amo_var, -7);
+        TEST_ASSERT_EQ(3, old, &result, "amomin should return the old value");
+        TEST_ASSERT_EQ(-7, amo_var, &result, "amomin should be signed");
+
+        amo_uvar = 5;
+
+        unsigned int uold = atomic_fetch_maxu(&amo_uvar, 0xfffffff0u);
+        TEST_ASSERT_EQ(5, (int) uold, &result, "amomaxu should return the old value");
+        TEST_ASSERT(amo_uvar == 0xfffffff0u, &result, "amomaxu should be unsigned");
+
+        uold = atomic_fetch_minu(&amo_uvar, 7);
+        TEST_ASSERT(uold == 0xfffffff0u, &result, "amominu should return the old value");
+        TEST_ASSERT_EQ(7, (int) amo_uvar, &result, "amominu should be unsigned");
+    }
+
+    pg_barrier_at(BARRIER_TEST_RUN, ncores);
+    return result;
+}
+
+test_result_t test_amo_concurrent(int hart_id, int ncores)
+{
+    test_result_t result = {.name = "amo_concurrent", .passed = 0, .failed = 0};
+    const int ITERATIONS = 1000;
+
+    if (hart_id == 0) {
+        amo_var = 0;
+        amo_uvar = 0;
+    }
+    pg_barrier_at(BARRIER_TEST_SETUP, ncores);
+
+    // Every core sets its own bit and races for the maximum
+    for (int i = 0; i < ITERATIONS; i++) {
+        atomic_fetch_or((volatile int *) &amo_uvar, 1 << hart_id);
+        atomic_fetch_max(&amo_var, hart_id * ITERATIONS + i);
+    }
+    amo_results[hart_id] = atomic_fetch_xor((volatile int *) &amo_uvar, 0);
+
+    pg_barrier_at(BARRIER_TEST_RUN, ncores);
+
+    if (hart_id == 0) {
+        TEST_ASSERT_EQ((1 << ncores) - 1, (int) amo_uvar, &result, "every core bit should be set");
+        TEST_ASSERT_EQ(ncores * ITERATIONS - 1, amo_var, &result, "maximum mismatch");
+        for (int i = 0; i < ncores; i++) {
+            TEST_ASSERT(amo_results[i] & (1 << i), &result, "core should observe its own bit");
+        }
+    }
+
+    pg_barrier_at(BARRIER_TEST_VERIFY, ncores);
+    return result;
+}
@@ -57,6 +57,7 @@ enum TestBarriers {
 };
 
 test_result_t test_sc_fail_on_intervene(int hart_id, int ncores);
+test_result_t test_sc_fail_cross_cluster(int hart_id, int ncores);
 test_result_t test_sc_different_address(int hart_id, int ncores);
 test_result_t test_reservation_overwrite(int hart_id, int ncores);
 test_result_t test_sc_without_lr(int hart_id, int ncores);
@@ -70,6 +71,10 @@ test_result_t test_exchange_basic(int hart_id, int ncores);
 test_result_t test_exchange_concurrent(int hart_id, int ncores);
 test_result_t test_exchange_concurrent_50(int hart_id, int ncores);
 
+test_result_t test_amo_logical(int hart_id, int ncores);
+test_result_t test_amo_min_max(int hart_id, int ncores);
+test_result_t test_amo_concurrent(int hart_id, int ncores);
+
 test_result_t test_barrier_atomic_counter(int hart_id, int ncores);
 test_result_t test_barrier_delay_injection(int hart_id, int ncores);
 test_result_t test_barrier_continuous(int hart_id, int ncores);
@@ -9,6 +9,11 @@ static volatile int sc_intervene_done;
 static volatile int reservation_var1;
 static volatile int reservation_var2;
 
+static volatile int cluster_ids[NCORES];
+static volatile int cross_var;
+static volatile int cross_step;
+static volatile int cross_sc_results[2];
+
 test_result_t test_sc_fail_on_intervene(int hart_id, int ncores)
 {
     test_result_t result = {.name = "sc_fail_on_intervene", .passed = 0, .failed = 0};
@@ -78,6 +83,94 @@ test_result_t test_sc_fail_on_intervene(int hart_id, int ncores)
     return result;
 }
 
+test_result_t test_sc_fail_cross_cluster(int hart_id, int ncores)
+{
+    test_result_t result = {.name = "sc_fail_cross_cluster", .passed = 0, .failed = 0};
+
+    if (ncores < 2) {
+        return result;
+    }
+
+    cluster_ids[hart_id] = pg_cluster_id();
+    if (hart_id == 0) {
+        cross_var = 0;
+        cross_step = 0;
+        cross_sc_results[0] = -1;
+        cross_sc_results[1] = -1;
+    }
+    pg_barrier_at(BARRIER_TEST_SETUP, ncores);
+
+    // The peer is the first hart of another cluster, or hart 1 without clusters
+    int peer = 1;
+    for (int i = ncores - 1; i > 0; i--) {
+        if (cluster_ids[i] != cluster_ids[0]) {
+            peer = i;
+        }
+    }
+
+    if (hart_id == 0) {
+        int old_val, sc_result;
+
+        // Round 1: the peer stores to the reserved word
+        asm volatile("lr.w %[old], (%[ptr])"
+                     : [old] "=r"(old_val)
+                     : [ptr] "r"(&cross_var)
+                     : "memory");
+        cross_step = 1;
+        while (cross_step != 2) {}
+        asm volatile("sc.w %[ret], %[new], (%[ptr])"
+                     : [ret] "=r"(sc_result)
+                     : [new] "r"(old_val + 1), [ptr] "r"(&cross_var)
+                     : "memory");
+        cross_sc_results[0] = sc_result;
+
+        // Round 2: the peer completes its own LR/SC on the reserved word
+        asm volatile("lr.w %[old], (%[ptr])"
+                     : [old] "=r"(old_val)
+                     : [ptr] "r"(&cross_var)
+                     : "memory");
+        cross_step = 3;
+        while (cross_step != 4) {}
+        asm volatile("sc.w %[ret], %[new], (%[ptr])"
+                     : [ret] "=r"(sc_result)
+                     : [new] "r"(old_val + 1), [ptr] "r"(&cross_var)
+                     : "memory");
+        cross_sc_results[1] = sc_result;
+    } else if (hart_id == peer) {
+        int old_val, sc_result;
+
+        while (cross_step != 1) {}
+        cross_var = 10;
+        cross_step = 2;
+
+        while (cross_step != 3) {}
+        do {
+            asm volatile("lr.w %[old], (%[ptr])"
+                         : [old] "=r"(old_val)
+                         : [ptr] "r"(&cross_var)
+                         : "memory");
+            asm volatile("sc.w %[ret], %[new], (%[ptr])"
+                         : [ret] "=r"(sc_result)
+                         : [new] "r"(old_val + 10), [ptr] "r"(&cross_var)
+                         : "memory");
+        } while (sc_result != 0);
+        cross_step = 4;
+    }
+
+    pg_barrier_at(BARRIER_TEST_RUN, ncores);
+
+    if (hart_id == 0) {
+        TEST_ASSERT(cross_sc_results[0] != 0, &result,
+                    "SC should fail when a core of another cluster stores between LR and SC");
+        TEST_ASSERT(cross_sc_results[1] != 0, &result,
+                    "SC should fail when a core of another cluster does LR/SC between LR and SC");
+        TEST_ASSERT_EQ(20, cross_var, &result, "variable should have the other cluster's value");
+    }
+
+    pg_barrier_at(BARRIER_TEST_VERIFY, ncores);
+    return result;
+}
+
 test_result_t test_sc_different_address(int hart_id, int ncores)
 {
     test_result_t result = {.name = "sc_different_address", .passed = 0, .failed = 0};
@@ -32,6 +32,7 @@ Please refer to LICENSE.md for the specific license agreement that pertains to t
 #include "al_smp.h"
 #include "util.h"
 #include "atomic.h"
+#include "mbox.h"
 
 #if (HAVE_PTHREAD==1) && (USE_SINGLE_CONTEXT!=1) && (USE_NATIVE_PTHREAD==0)
 /* Function: al_mutex_init
@@ -200,6 +201,10 @@ int al_cond_destroy(al_cond_t *cond) {
  * - Master sets PENDING after assigning work
  * - Worker transitions PENDING -> RUNNING -> DONE
  * - Master waits for DONE, then sets IDLE after retrieving result
+ *
+ * With the hardware mailbox, the master wakes the worker with a message to
+ * its inbox after setting PENDING, and the worker sends its hart id to the
+ * inbox of the master after setting DONE, so neither side polls the slot.
  */
 typedef enum {
 	THREAD_UNINIT = 0,
@@ -213,11 +218,15 @@ typedef struct {
 	void *(*func)(void *);
 	void *arg;
 	void *result;
+	int creator;
 	volatile thread_state_t state;
 } thread_slot_t;
 
 static volatile thread_slot_t thread_slots[NCORES];
 
+/* Completion messages received by each master but not joined yet, bit i is worker i */
+static volatile unsigned int mbox_done[NCORES];
+
 void worker_loop(void) {
 	int hart_id = pg_hart_id();
 	volatile thread_slot_t *slot = &thread_slots[hart_id];
@@ -228,11 +237,19 @@ void worker_loop(void) {
 	slot->state = THREAD_IDLE;
 
 	while (1) {
-		while (slot->state != THREAD_PENDING) { }
+		if (pg_mbox_depth() > 0) {
+			(void)pg_mbox_recv();
+		} else {
+			while (slot->state != THREAD_PENDING) { }
+		}
 
 		slot->state = THREAD_RUNNING;
 		slot->result = slot->func(slot->arg);
 		slot->state = THREAD_DONE;
+
+		if (pg_mbox_depth() > 0) {
+			pg_mbox_send(slot->creator, hart_id);
+		}
 	}
 }
 
@@ -260,8 +277,13 @@ int al_thread_create(al_thread_t *thread, void *(*start_routine)(void *), void *
 	slot->func = start_routine;
 	slot->arg = arg;
 	slot->result = NULL;
+	slot->creator = pg_hart_id();
 	slot->state = THREAD_PENDING;
 
+	if (pg_mbox_depth() > 0) {
+		pg_mbox_send(worker_id, 1);
+	}
+
 	*thread = (al_thread_t)(unsigned long)worker_id;
 	return 0;
 }
@@ -284,7 +306,15 @@ int al_thread_join(al_thread_t thread, void **thread_return) {
 	worker_id = (int)handle;
 	slot = &thread_slots[worker_id];
 
-	while (slot->state != THREAD_DONE) { }
+	if (pg_mbox_depth() > 0) {
+		int me = pg_hart_id();
+		while (!(mbox_done[me] & (1u << worker_id))) {
+			mbox_done[me] |= 1u << pg_mbox_recv();
+		}
+		mbox_done[me] &= ~(1u << worker_id);
+	} else {
+		while (slot->state != THREAD_DONE) { }
+	}
 
 	if (thread_return) {
 		*thread_return = slot->result;
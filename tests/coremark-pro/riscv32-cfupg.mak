@@ -29,7 +29,7 @@ LIBTYPE = .a
 LIBOUT =
 
 # Architecture flags
-ARCH_FLAGS = -march=rv32ima -mabi=ilp32
+ARCH_FLAGS = -march=rv32ima_zicsr -mabi=ilp32
 
 # Compiler flags
 COMPILER_FLAGS = -Os $(ARCH_FLAGS) -nostartfiles
@@ -1,4 +1,5 @@
 #include "atomic.h"
+#include "dispenser.h"
 #include "perf.h"
 #include "st7789.h"
 #include "util.h"
@@ -33,7 +34,7 @@ static inline void draw_point(int x, int y, int c)
 #define VERIFY_RESULT 0
 
 // Shared variables
-volatile int current_row = 1; // between 1 and Y_PIX
+#define ROW_DISPENSER 0 // hands out the rows from 1 to Y_PIX
 
 #if VERIFY_RESULT
 volatile char current_draw_result[X_PIX][Y_PIX];
@@ -101,6 +102,10 @@ int main(void)
     float x_max = 0.270900;
     float y_max = 0.004713;
 
+    if (hart_id == 0) {
+        pg_dispenser_init(ROW_DISPENSER, 1, 1, Y_PIX + 1);
+    }
+
     pg_perf_disable();
     pg_perf_reset();
     pg_perf_enable();
@@ -117,7 +122,7 @@ int main(void)
 
         pg_barrier();
         while (1) {
-            int row = atomic_fetch_add(&current_row, 1);
+            int row = pg_dispenser_next(ROW_DISPENSER);
             if (row > Y_PIX) {
                 break;
             }
@@ -129,7 +134,7 @@ int main(void)
             pg_lcd_set_pos(0, 14);
             printd(cnt);
             prints("\n");
-            current_row = 1;
+            pg_dispenser_init(ROW_DISPENSER, 1, 1, Y_PIX + 1);
 #if VERIFY_RESULT
             prints("COUNT ");
             printd(cnt);
@@ -0,0 +1,175 @@
+#include "atomic.h"
+#include "perf.h"
+#include "psimd.h"
+#include "util.h"
+
+#include <stdio.h>
+
+#define NVEC 256  // random operand pairs per operation
+#define NPIX 4096 // bytes of each image
+
+#define prints pg_prints
+
+typedef unsigned int (*psimd_func_t)(unsigned int, unsigned int);
+
+typedef struct {
+    const char *name;
+    int op;
+    psimd_func_t f8;
+    psimd_func_t f16;
+} psimd_test_t;
+
+#define PSIMD_TEST(name, op) {#name, op, pg_##name##8, pg_##name##16}
+
+static const psimd_test_t tests[] = {
+    PSIMD_TEST(padd, PG_PSIMD_ADD),
+    PSIMD_TEST(psub, PG_PSIMD_SUB),
+    PSIMD_TEST(padds, PG_PSIMD_ADDS),
+    PSIMD_TEST(paddus, PG_PSIMD_ADDUS),
+    PSIMD_TEST(psubs, PG_PSIMD_SUBS),
+    PSIMD_TEST(psubus, PG_PSIMD_SUBUS),
+    PSIMD_TEST(pcmpeq, PG_PSIMD_CMPEQ),
+    PSIMD_TEST(pcmplt, PG_PSIMD_CMPLT),
+    PSIMD_TEST(pcmpltu, PG_PSIMD_CMPLTU),
+    PSIMD_TEST(pmin, PG_PSIMD_MIN),
+    PSIMD_TEST(pminu, PG_PSIMD_MINU),
+    PSIMD_TEST(pmax, PG_PSIMD_MAX),
+    PSIMD_TEST(pmaxu, PG_PSIMD_MAXU),
+    PSIMD_TEST(psll, PG_PSIMD_SLL),
+    PSIMD_TEST(psrl, PG_PSIMD_SRL),
+    PSIMD_TEST(psra, PG_PSIMD_SRA),
+    PSIMD_TEST(pdot, PG_PSIMD_DOT),
+    PSIMD_TEST(pdotu, PG_PSIMD_DOTU),
+};
+
+#define NTESTS (sizeof(tests) / sizeof(tests[0]))
+
+// the lane boundaries of both widths, combined with every other edge value
+static const unsigned int edges[] = {
+    0x00000000, 0xffffffff, 0x7f7f7f7f, 0x80808080, 0x7fff7fff, 0x80008000,
+    0x01010101, 0x00ff00ff, 0xff00ff00, 0x0000001f, 0x0000000f, 0x00000007,
+};
+
+#define NEDGES (sizeof(edges) / sizeof(edges[0]))
+
+unsigned char img_a[NPIX];
+unsigned char img_b[NPIX];
+unsigned char dst_s[NPIX];
+unsigned char dst_p[NPIX];
+
+static unsigned int rng = 0x12345678;
+
+static unsigned int xorshift(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// returns the number of mismatches, printing the first one
+static int check_op(const psimd_test_t *t, int w16, unsigned int a, unsigned int b, int errors)
+{
+    unsigned int got = (w16) ? t->f16(a, b) : t->f8(a, b);
+    unsigned int exp = pg_psimd_emulate(t->op, w16, a, b);
+    char buf[96];
+
+    if (got == exp) {
+        return 0;
+    }
+    if (errors == 0) {
+        sprintf(buf, "  %s%d(%08x, %08x) = %08x, expected %08x\n", t->name, (w16) ? 16 : 8, a, b,
+                got, exp);
+        prints(buf);
+    }
+    return 1;
+}
+
+static int test_ops(void)
+{
+    int total = 0;
+
+    for (int i = 0; i < (int) NTESTS; i++) {
+        for (int w16 = 0; w16 < 2; w16++) {
+            int errors = 0;
+            for (int x = 0; x < (int) NEDGES; x++) {
+                for (int y = 0; y < (int) NEDGES; y++) {
+                    errors += check_op(&tests[i], w16, edges[x], edges[y], errors);
+                }
+            }
+            for (int n = 0; n < NVEC; n++) {
+                unsigned int a = xorshift();
+                unsigned int b = xorshift();
+                errors += check_op(&tests[i], w16, a, b, errors);
+            }
+            total += errors;
+        }
+    }
+    return total;
+}
+
+// The brightness-add kernel on a byte image: a byte at a time, and four bytes with paddus8
+__attribute__((noinline)) void scalar_addus(unsigned char *dst, const unsigned char *a,
+                                            const unsigned char *b, int n)
+{
+    for (int i = 0; i < n; i++) {
+        int s = a[i] + b[i];
+        dst[i] = (s > 255) ? 255 : s;
+    }
+}
+
+__attribute__((noinline)) void psimd_addus(unsigned char *dst, const unsigned char *a,
+                                           const unsigned char *b, int n)
+{
+    const unsigned int *wa = (const unsigned int *) a;
+    const unsigned int *wb = (const unsigned int *) b;
+    unsigned int *wd = (unsigned int *) dst;
+
+    for (int i = 0; i < n / 4; i++) {
+        wd[i] = pg_paddus8(wa[i], wb[i]);
+    }
+}
+
+int main(void)
+{
+    int hart_id = pg_hart_id();
+
+    if (hart_id == 0) {
+        unsigned long long t0, t1, t2;
+        char buf[96];
+        int errors;
+        int ok = 1;
+
+#ifdef USE_PSIMD
+        prints("custom-1 instructions vs pg_psimd_emulate()\n");
+#else
+        prints("USE_PSIMD is not set, the intrinsics are pg_psimd_emulate() itself\n");
+#endif
+        errors = test_ops();
+        sprintf(buf, "ops     %d mismatches  %s\n", errors, (errors == 0) ? "OK" : "NG");
+        prints(buf);
+
+        for (int i = 0; i < NPIX; i++) {
+            img_a[i] = xorshift();
+            img_b[i] = xorshift() & 0x7f;
+        }
+
+        t0 = pg_perf_cycle();
+        scalar_addus(dst_s, img_a, img_b, NPIX);
+        t1 = pg_perf_cycle();
+        psimd_addus(dst_p, img_a, img_b, NPIX);
+        t2 = pg_perf_cycle();
+        for (int i = 0; i < NPIX; i++) {
+            if (dst_s[i] != dst_p[i]) {
+                ok = 0;
+            }
+        }
+        sprintf(buf, "addus   scalar %8lld  psimd %8lld  (x100 speedup %lld)  %s\n", t1 - t0,
+                t2 - t1, (t1 - t0) * 100 / (t2 - t1), (ok) ? "OK" : "NG");
+        prints(buf);
+    }
+
+    pg_barrier();
+
+    return 0;
+}
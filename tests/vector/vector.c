@@ -0,0 +1,133 @@
+#include "atomic.h"
+#include "perf.h"
+#include "util.h"
+#include "vector.h"
+
+#include <stdio.h>
+
+#define N 1024     // elements of each stream
+#define STRIDE 4   // the stride of the gather in elements
+
+#define prints pg_prints
+
+int src_a[N * STRIDE];
+int src_b[N];
+int dst_s[N];
+int dst_v[N];
+
+// The scalar baselines, kept out of line so that both sides pay for a call
+__attribute__((noinline)) void scalar_copy(int *dst, const int *src, int n)
+{
+    for (int i = 0; i < n; i++) {
+        dst[i] = src[i];
+    }
+}
+
+__attribute__((noinline)) void scalar_fill(int *dst, int val, int n)
+{
+    for (int i = 0; i < n; i++) {
+        dst[i] = val;
+    }
+}
+
+__attribute__((noinline)) void scalar_add(int *dst, const int *a, const int *b, int n)
+{
+    for (int i = 0; i < n; i++) {
+        dst[i] = a[i] + b[i];
+    }
+}
+
+__attribute__((noinline)) int scalar_sum(const int *src, int n)
+{
+    int sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += src[i];
+    }
+    return sum;
+}
+
+__attribute__((noinline)) void scalar_gather(int *dst, const int *src, int stride, int n)
+{
+    for (int i = 0; i < n; i++) {
+        dst[i] = src[i * stride];
+    }
+}
+
+static int check(void)
+{
+    for (int i = 0; i < N; i++) {
+        if (dst_s[i] != dst_v[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// prints the cycles of both versions and the elements per cycle x 100
+static void report(const char *name, unsigned long long c_s, unsigned long long c_v, int ok)
+{
+    char buf[96];
+    sprintf(buf, "%-7s scalar %8lld (%4lld)  vector %8lld (%4lld)  %s\n", name, c_s,
+            N * 100ULL / c_s, c_v, N * 100ULL / c_v, (ok) ? "OK" : "NG");
+    prints(buf);
+}
+
+int main(void)
+{
+    int hart_id = pg_hart_id();
+
+    if (hart_id == 0) {
+        unsigned long long t0, t1, t2;
+        int sum_s, sum_v;
+
+        for (int i = 0; i < N * STRIDE; i++) {
+            src_a[i] = i * 7 - 100;
+        }
+        for (int i = 0; i < N; i++) {
+            src_b[i] = 3 * i + 1;
+        }
+
+        prints("VLMAX ");
+        pg_printd(pg_vlmax());
+        prints(", elements per cycle x 100 in ()\n");
+
+        t0 = pg_perf_cycle();
+        scalar_copy(dst_s, src_a, N);
+        t1 = pg_perf_cycle();
+        pg_vcopy(dst_v, src_a, N);
+        t2 = pg_perf_cycle();
+        report("copy", t1 - t0, t2 - t1, check());
+
+        t0 = pg_perf_cycle();
+        scalar_fill(dst_s, 0x5a5a, N);
+        t1 = pg_perf_cycle();
+        pg_vfill(dst_v, 0x5a5a, N);
+        t2 = pg_perf_cycle();
+        report("fill", t1 - t0, t2 - t1, check());
+
+        t0 = pg_perf_cycle();
+        scalar_add(dst_s, src_a, src_b, N);
+        t1 = pg_perf_cycle();
+        pg_vadd(dst_v, src_a, src_b, N);
+        t2 = pg_perf_cycle();
+        report("add", t1 - t0, t2 - t1, check());
+
+        t0 = pg_perf_cycle();
+        sum_s = scalar_sum(src_a, N);
+        t1 = pg_perf_cycle();
+        sum_v = pg_vsum(src_a, N);
+        t2 = pg_perf_cycle();
+        report("sum", t1 - t0, t2 - t1, sum_s == sum_v);
+
+        t0 = pg_perf_cycle();
+        scalar_gather(dst_s, src_a, STRIDE, N);
+        t1 = pg_perf_cycle();
+        pg_vgather(dst_v, src_a, STRIDE, N);
+        t2 = pg_perf_cycle();
+        report("gather", t1 - t0, t2 - t1, check());
+    }
+
+    pg_barrier();
+
+    return 0;
+}
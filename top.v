@@ -4,6 +4,8 @@
 `default_nettype none
 `timescale 1 ns / 1 ps
 
+`include "config.vh"
+
 // `define TIMEOUT_CYCLES 200000
 
 module top;
@@ -74,6 +76,11 @@ module top;
         $write("===> minstret                               : %10d\n", minstret);
         $write("===> Total number of branch predictions     : %10d\n", br_pred_cntr);
         $write("===> Total number of branch mispredictions  : %10d\n", br_misp_cntr);
+`ifdef USE_BANKED_DMEM
+        for (int b = 0; b < `DMEM_NBANKS; b++)
+            $write("===> Data memory bank %2d conflict cycles    : %10d\n", b,
+                   m0.dmem_conflict_cnt_packed[32*b +: 32]);
+`endif
         $write("===> simulation finish!!\n");
         $write("\n");
     end